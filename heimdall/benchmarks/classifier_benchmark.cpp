@@ -0,0 +1,76 @@
+/**
+ * @file classifier_benchmark.cpp
+ * @brief shouldOptimize初筛耗时基准
+ *
+ * 用法: heimdall_classifier_benchmark [迭代次数]
+ * 对典型OLTP语句与会触发优化的分析型语句各测一次，输出每次判定的平均纳秒数；
+ * 任一OLTP语句超过1微秒时返回非零退出码。
+ */
+
+#include "core/optimizer_integration/query_classifier.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using heimdall::optimizer::ClassifierRules;
+using heimdall::optimizer::classifyQuery;
+
+namespace {
+
+struct Case {
+    const char* name;
+    const char* sql;
+    bool oltp;
+};
+
+const Case kCases[] = {
+    {"point_select",
+     "SELECT c_first, c_middle, c_last, c_balance FROM customer "
+     "WHERE c_w_id = 3 AND c_d_id = 7 AND c_id = 1234", true},
+    {"range_select",
+     "SELECT o_id, o_entry_d FROM orders WHERE o_w_id = 3 AND o_d_id = 7 "
+     "AND o_c_id = 1234 ORDER BY o_id DESC LIMIT 1", true},
+    {"update",
+     "UPDATE stock SET s_quantity = 42, s_ytd = s_ytd + 5, s_order_cnt = s_order_cnt + 1 "
+     "WHERE s_i_id = 991 AND s_w_id = 3", true},
+    {"insert_values",
+     "INSERT INTO order_line (ol_o_id, ol_d_id, ol_w_id, ol_number, ol_i_id, ol_quantity) "
+     "VALUES (3001, 7, 3, 1, 991, 5)", true},
+    {"delete",
+     "DELETE FROM new_order WHERE no_o_id = 2101 AND no_d_id = 7 AND no_w_id = 3", true},
+    {"commit", "COMMIT", true},
+    {"in_subquery",
+     "SELECT * FROM orders WHERE o_c_id IN (SELECT c_id FROM customer WHERE c_credit = 'BC')",
+     false},
+    {"join",
+     "SELECT c.c_last, o.o_id FROM customer c JOIN orders o ON o.o_c_id = c.c_id "
+     "WHERE c.c_w_id = 3", false},
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const long iterations = argc > 1 ? std::atol(argv[1]) : 1000000;
+    const ClassifierRules rules;
+    bool within_budget = true;
+    volatile int sink = 0;
+
+    for (const auto& test : kCases) {
+        // 预热
+        for (int i = 0; i < 1000; ++i) sink = sink + classifyQuery(test.sql, rules).candidate;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < iterations; ++i) {
+            sink = sink + classifyQuery(test.sql, rules).candidate;
+        }
+        const double ns = std::chrono::duration<double, std::nano>(
+                              std::chrono::steady_clock::now() - start).count() /
+                          static_cast<double>(iterations);
+        const auto result = classifyQuery(test.sql, rules);
+        std::printf("%-14s %8.1f ns  candidate=%d\n", test.name, ns, result.candidate ? 1 : 0);
+        if (test.oltp && ns >= 1000.0) {
+            within_budget = false;
+        }
+    }
+    return within_budget ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+/**
+ * @file budget_governor.cpp
+ * @brief LLM预算控制实现
+ */
+
+#include "budget_governor.h"
+#include <algorithm>
+#include <iterator>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+constexpr size_t kBytesPerToken = 4;
+
+} // namespace
+
+// ==================== TokenBucket ====================
+
+TokenBucket::TokenBucket(double capacity, std::chrono::seconds window)
+    : capacity_(capacity),
+      refill_per_sec_(window.count() > 0
+                          ? capacity / static_cast<double>(window.count())
+                          : 0.0),
+      tokens_(capacity),
+      last_refill_(Clock::now()) {}
+
+void TokenBucket::refill(Clock::time_point now) {
+    if (now <= last_refill_) {
+        return;
+    }
+    const double elapsed = std::chrono::duration<double>(now - last_refill_).count();
+    tokens_ = std::min(capacity_, tokens_ + elapsed * refill_per_sec_);
+    last_refill_ = now;
+}
+
+bool TokenBucket::canConsume(double amount, Clock::time_point now) {
+    if (unlimited()) {
+        return true;
+    }
+    refill(now);
+    return tokens_ >= std::min(amount, capacity_);
+}
+
+void TokenBucket::consume(double amount) {
+    if (!unlimited()) {
+        tokens_ -= amount;
+    }
+}
+
+void TokenBucket::refund(double amount) {
+    if (!unlimited()) {
+        tokens_ = std::min(capacity_, tokens_ + amount);
+    }
+}
+
+double TokenBucket::fillRatio(Clock::time_point now) {
+    if (unlimited()) {
+        return 1.0;
+    }
+    refill(now);
+    return std::max(0.0, tokens_ / capacity_);
+}
+
+// ==================== Buckets ====================
+
+BudgetGovernor::Buckets::Buckets(const BudgetLimits& limits)
+    : requests_minute(limits.requests_per_minute, std::chrono::minutes(1)),
+      requests_hour(limits.requests_per_hour, std::chrono::hours(1)),
+      prompt_minute(limits.prompt_tokens_per_minute, std::chrono::minutes(1)),
+      prompt_hour(limits.prompt_tokens_per_hour, std::chrono::hours(1)),
+      completion_minute(limits.completion_tokens_per_minute, std::chrono::minutes(1)),
+      completion_hour(limits.completion_tokens_per_hour, std::chrono::hours(1)) {}
+
+bool BudgetGovernor::Buckets::canConsume(double prompt, double completion,
+                                         TokenBucket::Clock::time_point now) {
+    return requests_minute.canConsume(1.0, now) &&
+           requests_hour.canConsume(1.0, now) &&
+           prompt_minute.canConsume(prompt, now) &&
+           prompt_hour.canConsume(prompt, now) &&
+           completion_minute.canConsume(completion, now) &&
+           completion_hour.canConsume(completion, now);
+}
+
+void BudgetGovernor::Buckets::consume(double prompt, double completion) {
+    requests_minute.consume(1.0);
+    requests_hour.consume(1.0);
+    prompt_minute.consume(prompt);
+    prompt_hour.consume(prompt);
+    completion_minute.consume(completion);
+    completion_hour.consume(completion);
+}
+
+void BudgetGovernor::Buckets::adjust(double prompt_delta, double completion_delta) {
+    auto apply = [](TokenBucket& bucket, double delta) {
+        if (delta > 0.0) {
+            bucket.consume(delta);
+        } else if (delta < 0.0) {
+            bucket.refund(-delta);
+        }
+    };
+    apply(prompt_minute, prompt_delta);
+    apply(prompt_hour, prompt_delta);
+    apply(completion_minute, completion_delta);
+    apply(completion_hour, completion_delta);
+}
+
+double BudgetGovernor::Buckets::minFill(TokenBucket::Clock::time_point now) {
+    return std::min({requests_minute.fillRatio(now), requests_hour.fillRatio(now),
+                     prompt_minute.fillRatio(now), prompt_hour.fillRatio(now),
+                     completion_minute.fillRatio(now), completion_hour.fillRatio(now)});
+}
+
+// ==================== BudgetGovernor ====================
+
+BudgetGovernor::BudgetGovernor(const BudgetGovernorConfig& config)
+    : config_(config),
+      global_(config.global),
+      next_savings_(0),
+      stats_{} {
+    recent_savings_.reserve(std::max<size_t>(1, config_.priority_window));
+}
+
+BudgetGovernor::Buckets* BudgetGovernor::scopeBuckets(const std::string& scope,
+                                                      TokenBucket::Clock::time_point now) {
+    auto it = scopes_.find(scope);
+    if (it != scopes_.end()) {
+        scope_lru_.splice(scope_lru_.begin(), scope_lru_, it->second.lru_pos);
+        return &it->second.buckets;
+    }
+    if (config_.max_scopes == 0) {
+        return nullptr;
+    }
+    if (scopes_.size() >= config_.max_scopes) {
+        // 从最久未使用的一端找第一个已回满的scope；闲置越久越可能已回满
+        auto victim = scope_lru_.end();
+        for (auto pos = scope_lru_.rbegin(); pos != scope_lru_.rend(); ++pos) {
+            if (scopes_.at(*pos).buckets.minFill(now) >= 1.0) {
+                victim = std::next(pos).base();
+                break;
+            }
+        }
+        if (victim == scope_lru_.end()) {
+            return nullptr;
+        }
+        scopes_.erase(*victim);
+        scope_lru_.erase(victim);
+    }
+    scope_lru_.push_front(scope);
+    Scope& entry = scopes_[scope];
+    entry.buckets = Buckets(config_.per_scope);
+    entry.lru_pos = scope_lru_.begin();
+    return &entry.buckets;
+}
+
+double BudgetGovernor::savingsRank(double savings) const {
+    if (recent_savings_.empty()) {
+        return 1.0;
+    }
+    size_t below = 0;
+    for (double value : recent_savings_) {
+        if (value <= savings) {
+            ++below;
+        }
+    }
+    return static_cast<double>(below) / static_cast<double>(recent_savings_.size());
+}
+
+void BudgetGovernor::recordSavings(double savings) {
+    const size_t window = std::max<size_t>(1, config_.priority_window);
+    if (recent_savings_.size() < window) {
+        recent_savings_.push_back(savings);
+    } else {
+        recent_savings_[next_savings_] = savings;
+        next_savings_ = (next_savings_ + 1) % window;
+    }
+}
+
+BudgetDecision BudgetGovernor::tryAdmit(const BudgetRequest& request) {
+    const auto now = TokenBucket::Clock::now();
+    const double prompt = static_cast<double>(request.prompt_tokens);
+    const double completion = static_cast<double>(request.max_completion_tokens);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!global_.canConsume(prompt, completion, now)) {
+        ++stats_.rejected_global;
+        return BudgetDecision::REJECTED_GLOBAL;
+    }
+
+    Buckets* scope = nullptr;
+    if (!request.scope.empty()) {
+        scope = scopeBuckets(request.scope, now);
+        if (!scope || !scope->canConsume(prompt, completion, now)) {
+            ++stats_.rejected_scope;
+            return BudgetDecision::REJECTED_SCOPE;
+        }
+    }
+
+    // 预算紧张时按预期收益排名放行：余量越少，要求的排名越靠前
+    double fill = global_.minFill(now);
+    if (scope) {
+        fill = std::min(fill, scope->minFill(now));
+    }
+    const double savings = request.expected_savings;
+    const double rank = savingsRank(savings);
+    recordSavings(savings);
+    if (fill < config_.reserve_fraction && config_.reserve_fraction > 0.0) {
+        const double required = (config_.reserve_fraction - fill) / config_.reserve_fraction;
+        if (rank < required) {
+            ++stats_.rejected_priority;
+            return BudgetDecision::REJECTED_PRIORITY;
+        }
+    }
+
+    global_.consume(prompt, completion);
+    if (scope) {
+        scope->consume(prompt, completion);
+    }
+    ++stats_.admitted;
+    return BudgetDecision::ADMITTED;
+}
+
+void BudgetGovernor::settle(const BudgetRequest& request,
+                            size_t actual_prompt_tokens,
+                            size_t actual_completion_tokens) {
+    // 正数表示实际用量超出预扣，需补扣（桶可以暂时为负以抑制后续请求）
+    const double prompt_delta = static_cast<double>(actual_prompt_tokens) -
+                                static_cast<double>(request.prompt_tokens);
+    const double completion_delta = static_cast<double>(actual_completion_tokens) -
+                                    static_cast<double>(request.max_completion_tokens);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    global_.adjust(prompt_delta, completion_delta);
+    if (!request.scope.empty()) {
+        auto it = scopes_.find(request.scope);
+        if (it != scopes_.end()) {
+            it->second.buckets.adjust(prompt_delta, completion_delta);
+        }
+    }
+    stats_.prompt_tokens += actual_prompt_tokens;
+    stats_.completion_tokens += actual_completion_tokens;
+}
+
+size_t BudgetGovernor::estimateTokens(std::string_view text) {
+    return (text.size() + kBytesPerToken - 1) / kBytesPerToken;
+}
+
+BudgetGovernor::Stats BudgetGovernor::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace llm
+} // namespace heimdall
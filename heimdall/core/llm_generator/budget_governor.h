@@ -0,0 +1,195 @@
+/**
+ * @file budget_governor.h
+ * @brief LLM调用的token与请求预算控制
+ */
+
+#ifndef HEIMDALL_BUDGET_GOVERNOR_H
+#define HEIMDALL_BUDGET_GOVERNOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 令牌桶
+ *
+ * 容量即窗口内允许的总量，按capacity/window匀速补充；非阻塞。
+ * 超过容量的单次请求在桶满时放行并把余量扣成负数，之后按超出部分推迟放行，
+ * 而不是永远拒绝
+ */
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TokenBucket() : capacity_(0.0), refill_per_sec_(0.0), tokens_(0.0) {}
+    TokenBucket(double capacity, std::chrono::seconds window);
+
+    bool unlimited() const { return capacity_ <= 0.0; }
+    bool canConsume(double amount, Clock::time_point now);
+    void consume(double amount);
+    void refund(double amount);
+
+    /**
+     * @brief 当前余量占容量的比例 [0, 1]，无限制时为1
+     */
+    double fillRatio(Clock::time_point now);
+
+private:
+    double capacity_;
+    double refill_per_sec_;
+    double tokens_;
+    Clock::time_point last_refill_;
+
+    void refill(Clock::time_point now);
+};
+
+/**
+ * @brief 一组预算上限，0表示不限制
+ */
+struct BudgetLimits {
+    double requests_per_minute;
+    double requests_per_hour;
+    double prompt_tokens_per_minute;
+    double prompt_tokens_per_hour;
+    double completion_tokens_per_minute;
+    double completion_tokens_per_hour;
+
+    BudgetLimits()
+        : requests_per_minute(0), requests_per_hour(0),
+          prompt_tokens_per_minute(0), prompt_tokens_per_hour(0),
+          completion_tokens_per_minute(0), completion_tokens_per_hour(0) {}
+};
+
+/**
+ * @brief 预算控制配置
+ */
+struct BudgetGovernorConfig {
+    BudgetLimits global;          // 全局上限
+    BudgetLimits per_scope;       // 每个schema/用户的上限
+    double reserve_fraction;      // 余量低于该比例视为紧张
+    size_t priority_window;       // 参与收益排名的最近请求数
+    size_t max_scopes;            // 最多跟踪的scope数
+
+    BudgetGovernorConfig()
+        : reserve_fraction(0.3),
+          priority_window(256),
+          max_scopes(4096) {}
+};
+
+/**
+ * @brief 单次LLM请求的预算申请
+ */
+struct BudgetRequest {
+    std::string scope;            // schema或用户标识，空表示只受全局限制
+    size_t prompt_tokens;         // 预估prompt token数
+    size_t max_completion_tokens; // 预留的completion token数(max_tokens * n)
+    double expected_savings;      // 预期收益(如预估节省的代价)
+
+    BudgetRequest()
+        : prompt_tokens(0), max_completion_tokens(0), expected_savings(0.0) {}
+};
+
+enum class BudgetDecision {
+    ADMITTED,
+    REJECTED_GLOBAL,      // 全局预算耗尽
+    REJECTED_SCOPE,       // scope预算耗尽，或scope表已满且无可安全淘汰的scope
+    REJECTED_PRIORITY     // 预算紧张且预期收益排名不足
+};
+
+/**
+ * @brief 预算控制器
+ *
+ * 按分钟/小时两个窗口分别限制请求数、prompt token与completion token，
+ * 全局与每个scope各有一组令牌桶。所有检查均不阻塞：超出预算的请求
+ * 立即被拒绝，调用方应直接按"不优化"处理。
+ *
+ * 预算紧张时按预期收益在最近priority_window个请求中的排名放行：
+ * 余量降到reserve_fraction以下后，余量占比为f时只放行排名位于前
+ * f/reserve_fraction的请求。由于不排队，这是对近期请求分布的排名门槛，
+ * 而不是等待队列中的严格优先级。
+ *
+ * scope表满时按LRU顺序淘汰已经回满的scope（其状态与新建无异）；
+ * 所有scope都未回满时拒绝新scope，绝不重置部分耗尽的令牌桶。
+ */
+class BudgetGovernor {
+public:
+    explicit BudgetGovernor(const BudgetGovernorConfig& config = BudgetGovernorConfig());
+
+    /**
+     * @brief 申请预算，放行时预扣请求数、prompt token与completion预留
+     */
+    BudgetDecision tryAdmit(const BudgetRequest& request);
+
+    /**
+     * @brief 请求完成后按实际用量结算：多退少补
+     */
+    void settle(const BudgetRequest& request, size_t actual_prompt_tokens,
+                size_t actual_completion_tokens);
+
+    /**
+     * @brief 粗略估算文本token数（约4字节/token）
+     */
+    static size_t estimateTokens(std::string_view text);
+
+    struct Stats {
+        uint64_t admitted;
+        uint64_t rejected_global;
+        uint64_t rejected_scope;
+        uint64_t rejected_priority;
+        uint64_t prompt_tokens;
+        uint64_t completion_tokens;
+    };
+    Stats getStats() const;
+
+private:
+    struct Buckets {
+        TokenBucket requests_minute, requests_hour;
+        TokenBucket prompt_minute, prompt_hour;
+        TokenBucket completion_minute, completion_hour;
+
+        Buckets() = default;
+        explicit Buckets(const BudgetLimits& limits);
+        bool canConsume(double prompt, double completion, TokenBucket::Clock::time_point now);
+        void consume(double prompt, double completion);
+        void adjust(double prompt_delta, double completion_delta);
+        double minFill(TokenBucket::Clock::time_point now);
+    };
+
+    struct Scope {
+        Buckets buckets;
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    BudgetGovernorConfig config_;
+    mutable std::mutex mutex_;
+    Buckets global_;
+    std::unordered_map<std::string, Scope> scopes_;
+    std::list<std::string> scope_lru_;      // 表头为最近使用
+    std::vector<double> recent_savings_;    // 最近请求的预期收益(环形)
+    size_t next_savings_;
+    Stats stats_;
+
+    /**
+     * @brief 查找或创建scope，表满且无法安全淘汰时返回nullptr
+     */
+    Buckets* scopeBuckets(const std::string& scope, TokenBucket::Clock::time_point now);
+
+    /**
+     * @brief savings在最近请求中的排名分位 [0, 1]，1表示不低于所有近期请求
+     */
+    double savingsRank(double savings) const;
+    void recordSavings(double savings);
+};
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
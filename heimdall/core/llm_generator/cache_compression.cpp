@@ -0,0 +1,242 @@
+/**
+ * @file cache_compression.cpp
+ * @brief 共享字典压缩实现
+ */
+
+#include "cache_compression.h"
+#include <algorithm>
+#include <cstring>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+constexpr unsigned char kShortCode = 0xFF;
+constexpr unsigned char kLongCode = 0xFE;
+constexpr unsigned char kLiteral = 0xFD;
+constexpr size_t kShortEntries = 256;
+
+inline bool isWordChar(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_';
+}
+
+// 编码后每个字典词占用的字节数
+inline size_t codeLength(size_t rank) {
+    return rank < kShortEntries ? 2 : 3;
+}
+
+void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool getVarint(std::string_view& in, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && !in.empty(); shift += 7) {
+        const auto byte = static_cast<unsigned char>(in.front());
+        in.remove_prefix(1);
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+void putBytes(std::string& out, std::string_view bytes) {
+    putVarint(out, bytes.size());
+    out.append(bytes.data(), bytes.size());
+}
+
+bool getBytes(std::string_view& in, std::string_view* bytes) {
+    uint64_t len = 0;
+    if (!getVarint(in, &len) || len > in.size()) {
+        return false;
+    }
+    *bytes = in.substr(0, static_cast<size_t>(len));
+    in.remove_prefix(static_cast<size_t>(len));
+    return true;
+}
+
+} // namespace
+
+std::shared_ptr<const CompressionDictionary> CompressionDictionary::train(
+    const std::vector<std::string_view>& samples, size_t max_entries) {
+    std::unordered_map<std::string_view, uint64_t> counts;
+    for (std::string_view sample : samples) {
+        size_t i = 0;
+        while (i < sample.size()) {
+            if (!isWordChar(static_cast<unsigned char>(sample[i]))) {
+                ++i;
+                continue;
+            }
+            const size_t start = i;
+            while (i < sample.size() && isWordChar(static_cast<unsigned char>(sample[i]))) ++i;
+            if (i - start >= kMinWordLength) {
+                ++counts[sample.substr(start, i - start)];
+            }
+        }
+    }
+
+    // 按总节省字节排序；只出现一次的词不值得收录
+    std::vector<std::pair<uint64_t, std::string_view>> ranked;
+    ranked.reserve(counts.size());
+    for (const auto& entry : counts) {
+        if (entry.second < 2) continue;
+        ranked.emplace_back((entry.first.size() - codeLength(0)) * entry.second,
+                            entry.first);
+    }
+    std::sort(ranked.begin(), ranked.end(),
+              [](const auto& a, const auto& b) {
+                  return a.first != b.first ? a.first > b.first : a.second < b.second;
+              });
+
+    std::shared_ptr<CompressionDictionary> dict(new CompressionDictionary());
+    const size_t limit = std::min(max_entries, kMaxEntries);
+    dict->words_.reserve(std::min(limit, ranked.size()));
+    for (const auto& entry : ranked) {
+        if (dict->words_.size() >= limit) break;
+        // 长编号多占1字节，过短的词放在长编号区没有收益
+        if (entry.second.size() <= codeLength(dict->words_.size())) continue;
+        dict->words_.emplace_back(entry.second);
+    }
+    // words_不再增长后再建立索引，保证视图稳定
+    for (size_t i = 0; i < dict->words_.size(); ++i) {
+        dict->index_.emplace(dict->words_[i], static_cast<uint32_t>(i));
+    }
+    return dict;
+}
+
+std::string CompressionDictionary::compress(std::string_view input) const {
+    std::string out;
+    out.reserve(input.size() / 2 + 16);
+
+    auto putLiteral = [&out](unsigned char c) {
+        if (c >= kLiteral) {
+            out.push_back(static_cast<char>(kLiteral));
+        }
+        out.push_back(static_cast<char>(c));
+    };
+
+    size_t i = 0;
+    while (i < input.size()) {
+        const auto c = static_cast<unsigned char>(input[i]);
+        if (!isWordChar(c)) {
+            putLiteral(c);
+            ++i;
+            continue;
+        }
+        const size_t start = i;
+        while (i < input.size() && isWordChar(static_cast<unsigned char>(input[i]))) ++i;
+        const std::string_view word = input.substr(start, i - start);
+
+        auto it = word.size() >= kMinWordLength ? index_.find(word) : index_.end();
+        if (it == index_.end()) {
+            out.append(word.data(), word.size());
+        } else if (it->second < kShortEntries) {
+            out.push_back(static_cast<char>(kShortCode));
+            out.push_back(static_cast<char>(it->second));
+        } else {
+            const uint32_t code = it->second - static_cast<uint32_t>(kShortEntries);
+            out.push_back(static_cast<char>(kLongCode));
+            out.push_back(static_cast<char>(code >> 8));
+            out.push_back(static_cast<char>(code & 0xFF));
+        }
+    }
+    return out;
+}
+
+bool CompressionDictionary::decompress(std::string_view input,
+                                       std::string* output) const {
+    output->clear();
+    output->reserve(input.size() * 2);
+    size_t i = 0;
+    while (i < input.size()) {
+        const auto c = static_cast<unsigned char>(input[i]);
+        if (c == kShortCode || c == kLongCode) {
+            const size_t need = (c == kShortCode) ? 2 : 3;
+            if (i + need > input.size()) return false;
+            size_t code = static_cast<unsigned char>(input[i + 1]);
+            if (c == kLongCode) {
+                code = kShortEntries + ((code << 8) | static_cast<unsigned char>(input[i + 2]));
+            }
+            if (code >= words_.size()) return false;
+            output->append(words_[code]);
+            i += need;
+        } else if (c == kLiteral) {
+            if (i + 1 >= input.size()) return false;
+            output->push_back(input[i + 1]);
+            i += 2;
+        } else {
+            output->push_back(static_cast<char>(c));
+            ++i;
+        }
+    }
+    return true;
+}
+
+std::string serializeResponse(const LLMResponse& response) {
+    std::string out;
+    size_t total = response.raw_response.size() + response.error_message.size() + 32;
+    for (auto candidate : response.candidates) total += candidate.size() + 4;
+    out.reserve(total);
+
+    const unsigned char flags = (response.success ? 0x1 : 0) |
+                                (response.budget_rejected ? 0x2 : 0);
+    out.push_back(static_cast<char>(flags));
+    char latency[sizeof(double)];
+    std::memcpy(latency, &response.latency_ms, sizeof(double));
+    out.append(latency, sizeof(double));
+
+    putVarint(out, response.candidates.size());
+    for (auto candidate : response.candidates) {
+        putBytes(out, candidate);
+    }
+    putBytes(out, response.raw_response);
+    putBytes(out, response.error_message);
+    return out;
+}
+
+LLMResponsePtr deserializeResponse(std::string_view data) {
+    if (data.size() < 1 + sizeof(double)) {
+        return nullptr;
+    }
+    const auto flags = static_cast<unsigned char>(data[0]);
+    double latency = 0.0;
+    std::memcpy(&latency, data.data() + 1, sizeof(double));
+    data.remove_prefix(1 + sizeof(double));
+
+    // 序列化数据只比其中的文本多出长度前缀，按它的大小申请缓冲
+    LLMResponseBuilder builder(data.size());
+    uint64_t count = 0;
+    if (!getVarint(data, &count)) {
+        return nullptr;
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string_view candidate;
+        if (!getBytes(data, &candidate)) return nullptr;
+        builder.addCandidate(candidate);
+    }
+    std::string_view raw;
+    std::string_view error;
+    if (!getBytes(data, &raw) || !getBytes(data, &error)) {
+        return nullptr;
+    }
+    builder.setRawResponse(raw);
+    if (!error.empty()) builder.setError(error);
+    if (flags & 0x2) builder.setBudgetRejected();
+    builder.setLatency(latency);
+
+    LLMResponse response = builder.build();
+    response.success = (flags & 0x1) != 0;
+    return std::make_shared<const LLMResponse>(std::move(response));
+}
+
+} // namespace llm
+} // namespace heimdall
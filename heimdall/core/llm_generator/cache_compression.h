@@ -0,0 +1,78 @@
+/**
+ * @file cache_compression.h
+ * @brief 基于共享字典的缓存值压缩
+ */
+
+#ifndef HEIMDALL_CACHE_COMPRESSION_H
+#define HEIMDALL_CACHE_COMPRESSION_H
+
+#include "llm_response.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 从缓存内容训练出的共享字典
+ *
+ * 缓存中的SQL重写与原始响应高度重复（相同的表名、列名、关键字和
+ * JSON字段），字典收录按"出现次数×节省字节"排序的高频词，
+ * 编码时每个字典词替换为2~3字节的编号。
+ *
+ * 编码格式：
+ * - 0xFF i      字典前256项中的第i项
+ * - 0xFE hi lo  字典第256+(hi<<8|lo)项
+ * - 0xFD b      字面字节b（仅用于0xFD~0xFF，UTF-8文本中不会出现）
+ * - 其他字节    原样输出
+ */
+class CompressionDictionary {
+public:
+    static constexpr size_t kMinWordLength = 4;
+    static constexpr size_t kMaxEntries = 256 + 65536;
+
+    /**
+     * @brief 从样本训练字典
+     * @param max_entries 字典最大词数
+     */
+    static std::shared_ptr<const CompressionDictionary> train(
+        const std::vector<std::string_view>& samples,
+        size_t max_entries = 4096);
+
+    std::string compress(std::string_view input) const;
+
+    /**
+     * @brief 解压，数据损坏时返回false
+     */
+    bool decompress(std::string_view input, std::string* output) const;
+
+    size_t entries() const { return words_.size(); }
+
+    CompressionDictionary(const CompressionDictionary&) = delete;
+    CompressionDictionary& operator=(const CompressionDictionary&) = delete;
+
+private:
+    CompressionDictionary() = default;
+
+    std::vector<std::string> words_;
+    std::unordered_map<std::string_view, uint32_t> index_;  // 键指向words_
+};
+
+/**
+ * @brief 把响应序列化为字节串（候选、原始响应、错误信息与标志）
+ */
+std::string serializeResponse(const LLMResponse& response);
+
+/**
+ * @brief 从字节串恢复响应，格式错误时返回nullptr
+ */
+LLMResponsePtr deserializeResponse(std::string_view data);
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
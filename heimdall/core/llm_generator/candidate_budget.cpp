@@ -0,0 +1,197 @@
+/**
+ * @file candidate_budget.cpp
+ * @brief 自适应候选预算实现
+ */
+
+#include "candidate_budget.h"
+#include <algorithm>
+#include <cmath>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+// 单候选有效率：验证通过数 / 实际验证数
+double candidateYield(const CandidateBudgetController::ClassStats& stats) {
+    if (stats.examined == 0) {
+        return 0.0;
+    }
+    return std::min(1.0, static_cast<double>(stats.validated) /
+                             static_cast<double>(stats.examined));
+}
+
+} // namespace
+
+CandidateBudgetController::CandidateBudgetController(
+    const CandidateBudgetConfig& config)
+    : config_(config) {
+    config_.min_candidates = std::max(1, config_.min_candidates);
+    config_.max_candidates = std::max(config_.min_candidates,
+                                      config_.max_candidates);
+}
+
+GenerationConfig CandidateBudgetController::adapt(uint64_t query_class,
+                                                  const GenerationConfig& base) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    ClassStats& stats = touchLocked(query_class);
+    ++stats.requests;
+
+    GenerationConfig config = base;
+    if (stats.optimizations < static_cast<uint64_t>(config_.warmup_samples)) {
+        return config;
+    }
+
+    int n = chooseCandidateCount(stats);
+    if (config_.explore_interval > 0 &&
+        stats.requests % static_cast<uint64_t>(config_.explore_interval) == 0) {
+        // 周期性多要一个候选，避免胜出位置统计被当前候选数自我强化
+        n = std::min(n + 1, config_.max_candidates);
+    }
+
+    config.num_candidates = n;
+    config.temperature = chooseTemperature(n);
+    return config;
+}
+
+void CandidateBudgetController::recordOutcome(uint64_t query_class,
+                                              int generated, int validated,
+                                              int chosen_index,
+                                              size_t prompt_tokens,
+                                              size_t completion_tokens,
+                                              int examined) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    ClassStats& stats = touchLocked(query_class);
+    ++stats.optimizations;
+    stats.generated += static_cast<uint64_t>(std::max(0, generated));
+    stats.examined += static_cast<uint64_t>(
+        std::max(0, examined < 0 ? generated : std::min(examined, generated)));
+    stats.validated += static_cast<uint64_t>(std::max(0, validated));
+    stats.prompt_tokens += prompt_tokens;
+    stats.completion_tokens += completion_tokens;
+    if (chosen_index >= 0) {
+        ++stats.chosen;
+        const int pos = std::min(chosen_index, kMaxTrackedPositions - 1);
+        ++stats.wins_at[static_cast<size_t>(pos)];
+    }
+}
+
+bool CandidateBudgetController::getClassStats(uint64_t query_class,
+                                              ClassStats* stats) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = classes_.find(query_class);
+    if (it == classes_.end()) {
+        return false;
+    }
+    if (stats) {
+        *stats = it->second.stats;
+    }
+    return true;
+}
+
+size_t CandidateBudgetController::trackedClasses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return classes_.size();
+}
+
+void CandidateBudgetController::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    classes_.clear();
+    lru_.clear();
+}
+
+CandidateBudgetController::ClassStats&
+CandidateBudgetController::touchLocked(uint64_t query_class) {
+    auto it = classes_.find(query_class);
+    if (it != classes_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+        return it->second.stats;
+    }
+    if (classes_.size() >= std::max<size_t>(1, config_.max_classes)) {
+        // 淘汰最久未使用的类别，活跃类别的统计不受新类别冲击
+        classes_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    lru_.push_front(query_class);
+    return classes_.emplace(query_class, Entry{ClassStats(), lru_.begin()})
+        .first->second.stats;
+}
+
+int CandidateBudgetController::chooseCandidateCount(const ClassStats& stats) const {
+    // 长期没有任何有效候选：继续多要候选只会浪费token
+    if (stats.validated == 0) {
+        return stats.optimizations >= static_cast<uint64_t>(config_.give_up_samples)
+                   ? config_.min_candidates
+                   : config_.max_candidates;
+    }
+
+    // 1. 覆盖历史胜出位置所需的候选数
+    int by_position = config_.min_candidates;
+    if (stats.chosen > 0) {
+        uint64_t covered = 0;
+        for (int i = 0; i < kMaxTrackedPositions; ++i) {
+            covered += stats.wins_at[static_cast<size_t>(i)];
+            if (static_cast<double>(covered) >=
+                config_.target_win_coverage * static_cast<double>(stats.chosen)) {
+                by_position = i + 1;
+                break;
+            }
+        }
+    }
+
+    // 2. 按单候选有效率p，使 1-(1-p)^n 达到目标概率所需的候选数
+    int by_yield = config_.min_candidates;
+    const double p = candidateYield(stats);
+    if (p >= 1.0) {
+        by_yield = 1;
+    } else if (p > 0.0) {
+        const double needed = std::log(1.0 - config_.target_valid_probability) /
+                              std::log(1.0 - p);
+        by_yield = static_cast<int>(std::ceil(needed));
+    }
+
+    const int n = std::clamp(std::max(by_position, by_yield),
+                             config_.min_candidates, config_.max_candidates);
+    return limitByTokenCost(stats, n);
+}
+
+int CandidateBudgetController::limitByTokenCost(const ClassStats& stats,
+                                                int max_n) const {
+    if (stats.generated == 0 || stats.validated == 0 ||
+        stats.completion_tokens == 0 || stats.optimizations == 0) {
+        return max_n;
+    }
+    const double p = candidateYield(stats);
+    const double prompt = static_cast<double>(stats.prompt_tokens) /
+                          static_cast<double>(stats.optimizations);
+    const double per_candidate = static_cast<double>(stats.completion_tokens) /
+                                 static_cast<double>(stats.generated);
+
+    // 每token的成功概率 (1-(1-p)^n) / (prompt + n*per_candidate)，取最大者（相同取较小n）
+    int best = config_.min_candidates;
+    double best_value = -1.0;
+    for (int n = config_.min_candidates; n <= max_n; ++n) {
+        const double success = 1.0 - std::pow(1.0 - p, n);
+        const double value = success / (prompt + n * per_candidate);
+        if (value > best_value) {
+            best_value = value;
+            best = n;
+        }
+    }
+    return best;
+}
+
+float CandidateBudgetController::chooseTemperature(int num_candidates) const {
+    if (config_.max_candidates <= config_.min_candidates) {
+        return config_.min_temperature;
+    }
+    const float t = static_cast<float>(num_candidates - config_.min_candidates) /
+                    static_cast<float>(config_.max_candidates - config_.min_candidates);
+    return config_.min_temperature +
+           t * (config_.max_temperature - config_.min_temperature);
+}
+
+} // namespace llm
+} // namespace heimdall
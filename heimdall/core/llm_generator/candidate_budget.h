@@ -0,0 +1,133 @@
+/**
+ * @file candidate_budget.h
+ * @brief 按查询类别自适应调整候选数量与温度
+ */
+
+#ifndef HEIMDALL_CANDIDATE_BUDGET_H
+#define HEIMDALL_CANDIDATE_BUDGET_H
+
+#include "llm_client.h"
+#include <array>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 自适应候选预算配置
+ */
+struct CandidateBudgetConfig {
+    int min_candidates;               // 最少候选数
+    int max_candidates;               // 最多候选数
+    float min_temperature;            // 单候选时使用的温度
+    float max_temperature;            // 最多候选时使用的温度
+    int warmup_samples;               // 样本不足时沿用基础配置
+    int give_up_samples;              // 持续无有效候选的样本数上限
+    double target_win_coverage;       // 需覆盖的历史胜出位置比例
+    double target_valid_probability;  // 至少一个候选有效的目标概率
+    int explore_interval;             // 每N次请求额外多探索一个候选
+    size_t max_classes;               // 最多跟踪的查询类别数
+
+    CandidateBudgetConfig()
+        : min_candidates(1),
+          max_candidates(5),
+          min_temperature(0.2f),
+          max_temperature(0.8f),
+          warmup_samples(5),
+          give_up_samples(20),
+          target_win_coverage(0.95),
+          target_valid_probability(0.9),
+          explore_interval(16),
+          max_classes(10000) {}
+};
+
+/**
+ * @brief 按查询类别（模板摘要）跟踪候选的生成/验证/胜出情况，
+ *        并据此决定下一次请求的num_candidates与temperature
+ *
+ * 首个候选总是胜出的简单类别收敛到单候选、低温度；
+ * 验证通过率低的困难类别请求更多候选并提高温度以增加多样性；
+ * 长期没有任何有效候选的类别降到最少候选，避免持续浪费token。
+ *
+ * 覆盖胜出位置与有效概率两个目标给出候选数上限，在此范围内再按该类别
+ * 实际消耗的prompt/completion token，选择"至少一个有效候选的概率 / 请求token数"
+ * 最大的候选数：prompt远长于单个候选时多要候选几乎不增加开销，反之则收敛到少量候选。
+ * 类别数超过max_classes时淘汰最久未使用的类别。
+ */
+class CandidateBudgetController {
+public:
+    static constexpr int kMaxTrackedPositions = 8;
+
+    /**
+     * @brief 单个查询类别的累计统计
+     */
+    struct ClassStats {
+        uint64_t requests;            // adapt()调用次数
+        uint64_t optimizations;       // 记录的优化次数
+        uint64_t generated;           // 生成的候选总数
+        uint64_t examined;            // 实际送去验证的候选总数
+        uint64_t validated;           // 验证通过的候选总数
+        uint64_t chosen;              // 有候选被选中的次数
+        uint64_t prompt_tokens;       // 累计prompt token
+        uint64_t completion_tokens;   // 累计completion token
+        std::array<uint32_t, kMaxTrackedPositions> wins_at;  // 按生成顺序的胜出位置
+
+        ClassStats()
+            : requests(0), optimizations(0), generated(0),
+              examined(0), validated(0), chosen(0), prompt_tokens(0),
+              completion_tokens(0), wins_at{} {}
+    };
+
+    explicit CandidateBudgetController(
+        const CandidateBudgetConfig& config = CandidateBudgetConfig());
+
+    /**
+     * @brief 根据类别历史返回调整后的生成配置
+     */
+    GenerationConfig adapt(uint64_t query_class, const GenerationConfig& base);
+
+    /**
+     * @brief 记录一次优化的结果
+     * @param chosen_index 被选中候选在生成顺序中的下标，-1表示未选中
+     *        （修复轮次得到的候选不占生成顺序，应传-1）
+     * @param prompt_tokens 本次请求（含修复轮次）发送的prompt token数
+     * @param completion_tokens 本次请求收到的completion token数
+     * @param examined 实际验证的候选数，-1表示全部生成的候选都已验证；
+     *        FIRST_VALID在首个有效候选处停止，未验证的候选不计入有效率
+     */
+    void recordOutcome(uint64_t query_class, int generated, int validated,
+                       int chosen_index, size_t prompt_tokens = 0,
+                       size_t completion_tokens = 0, int examined = -1);
+
+    /**
+     * @brief 查询类别统计，类别不存在时返回false
+     */
+    bool getClassStats(uint64_t query_class, ClassStats* stats) const;
+
+    size_t trackedClasses() const;
+    void reset();
+
+private:
+    CandidateBudgetConfig config_;
+    struct Entry {
+        ClassStats stats;
+        std::list<uint64_t>::iterator lru_pos;
+    };
+
+    mutable std::mutex mutex_;
+    std::list<uint64_t> lru_;  // 头部为最近使用
+    std::unordered_map<uint64_t, Entry> classes_;
+
+    ClassStats& touchLocked(uint64_t query_class);
+    int chooseCandidateCount(const ClassStats& stats) const;
+    int limitByTokenCost(const ClassStats& stats, int max_n) const;
+    float chooseTemperature(int num_candidates) const;
+};
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file catalog_snapshot.cpp
+ * @brief 目录统计快照实现
+ */
+
+#include "catalog_snapshot.h"
+#include <fstream>
+#include <sstream>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+std::string toLower(const std::string& text) {
+    std::string out(text);
+    for (auto& c : out) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return out;
+}
+
+std::vector<std::string> splitColumns(const std::string& list) {
+    std::vector<std::string> columns;
+    std::string column;
+    std::istringstream in(list);
+    while (std::getline(in, column, ',')) {
+        if (!column.empty()) columns.push_back(column);
+    }
+    return columns;
+}
+
+} // namespace
+
+CatalogSnapshot::CatalogSnapshot() : next_version_(1) {}
+
+bool CatalogSnapshot::loadFromFile(const std::string& path, std::string* error) {
+    std::ifstream file(path);
+    if (!file) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+
+    std::unordered_map<std::string, TableStatistics> loaded;
+    std::string line;
+    int line_no = 0;
+    while (std::getline(file, line)) {
+        ++line_no;
+        std::istringstream in(line);
+        std::string kind;
+        if (!(in >> kind) || kind[0] == '#') {
+            continue;
+        }
+        std::string table;
+        bool ok = static_cast<bool>(in >> table);
+        if (ok && kind == "table") {
+            ok = static_cast<bool>(in >> loaded[toLower(table)].row_count);
+        } else if (ok && kind == "ndv") {
+            std::string column;
+            uint64_t ndv = 0;
+            ok = static_cast<bool>(in >> column >> ndv);
+            if (ok) loaded[toLower(table)].column_ndv[column] = ndv;
+        } else if (ok && kind == "index") {
+            IndexDefinition index;
+            std::string token;
+            ok = static_cast<bool>(in >> index.name >> token);
+            if (ok && token == "unique") {
+                index.unique = true;
+                ok = static_cast<bool>(in >> token);
+            }
+            if (ok) {
+                index.columns = splitColumns(token);
+                loaded[toLower(table)].indexes.push_back(std::move(index));
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            if (error) *error = path + ":" + std::to_string(line_no) + ": malformed record";
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    tables_.clear();
+    for (auto& entry : loaded) {
+        tables_[entry.first] = Entry{std::move(entry.second), next_version_++};
+    }
+    return true;
+}
+
+void CatalogSnapshot::updateTable(const std::string& table_name, TableStatistics stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tables_[toLower(table_name)] = Entry{std::move(stats), next_version_++};
+}
+
+void CatalogSnapshot::removeTable(const std::string& table_name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tables_.erase(toLower(table_name));
+}
+
+const CatalogSnapshot::Entry* CatalogSnapshot::findLocked(std::string key) const {
+    auto it = tables_.find(key);
+    if (it == tables_.end()) {
+        const size_t dot = key.rfind('.');
+        if (dot != std::string::npos) {
+            it = tables_.find(key.substr(dot + 1));
+        }
+    }
+    return it == tables_.end() ? nullptr : &it->second;
+}
+
+bool CatalogSnapshot::annotate(TableSchema& schema) const {
+    std::string key = toLower(schema.table_name);
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Entry* entry = findLocked(std::move(key));
+    if (!entry) {
+        return false;
+    }
+    schema.row_count = entry->stats.row_count;
+    schema.column_ndv = entry->stats.column_ndv;
+    schema.indexes = entry->stats.indexes;
+    schema.stats_version = entry->version;
+    return true;
+}
+
+uint64_t CatalogSnapshot::statsVersion(std::string_view table_name) const {
+    std::string key = toLower(std::string(table_name));
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Entry* entry = findLocked(std::move(key));
+    return entry ? entry->version : 0;
+}
+
+bool CatalogSnapshot::rowCount(std::string_view table_name, uint64_t* rows) const {
+    std::string key = toLower(std::string(table_name));
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Entry* entry = findLocked(std::move(key));
+    if (!entry) {
+        return false;
+    }
+    *rows = entry->stats.row_count;
+    return true;
+}
+
+void CatalogSnapshot::annotate(std::vector<TableSchema>& schemas) const {
+    for (auto& schema : schemas) {
+        annotate(schema);
+    }
+}
+
+size_t CatalogSnapshot::tableCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tables_.size();
+}
+
+} // namespace llm
+} // namespace heimdall
@@ -0,0 +1,99 @@
+/**
+ * @file catalog_snapshot.h
+ * @brief 本地目录统计快照
+ */
+
+#ifndef HEIMDALL_CATALOG_SNAPSHOT_H
+#define HEIMDALL_CATALOG_SNAPSHOT_H
+
+#include "prompt_builder.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 单表统计信息
+ */
+struct TableStatistics {
+    uint64_t row_count = 0;
+    std::unordered_map<std::string, uint64_t> column_ndv;
+    std::vector<IndexDefinition> indexes;
+};
+
+/**
+ * @brief 目录统计快照
+ *
+ * 保存各表的行数、列NDV与索引定义，用于给Prompt中的TableSchema补充
+ * 基数与索引信息，使模型能区分大事实表与小维表、知道哪些列有索引。
+ * 快照在进程内维护，构建Prompt时不访问数据字典。
+ *
+ * 快照文件为文本格式，每行一条记录，'#'开头为注释：
+ *   table <表名> <行数>
+ *   ndv   <表名> <列名> <不同值个数>
+ *   index <表名> <索引名> [unique] <列1,列2,...>
+ *
+ * 线程安全。
+ */
+class CatalogSnapshot {
+public:
+    CatalogSnapshot();
+
+    /**
+     * @brief 从快照文件加载，替换现有内容
+     * @param error 失败时写入出错的行号与原因
+     */
+    bool loadFromFile(const std::string& path, std::string* error = nullptr);
+
+    /**
+     * @brief 更新单表统计（例如ANALYZE TABLE之后）
+     */
+    void updateTable(const std::string& table_name, TableStatistics stats);
+    void removeTable(const std::string& table_name);
+
+    /**
+     * @brief 把快照中的统计写入schema，返回是否找到该表
+     *
+     * 表名不区分大小写，限定名("db.t")找不到时再按最后一段查找
+     */
+    bool annotate(TableSchema& schema) const;
+    void annotate(std::vector<TableSchema>& schemas) const;
+
+    /**
+     * @brief 单表统计信息版本，表不在快照中时返回0
+     *
+     * 查找规则与annotate()相同，只读版本号，不复制统计信息
+     */
+    uint64_t statsVersion(std::string_view table_name) const;
+
+    /**
+     * @brief 单表行数，表不在快照中时返回false
+     *
+     * 查找规则与annotate()相同，供候选预排序估计扫描行数
+     */
+    bool rowCount(std::string_view table_name, uint64_t* rows) const;
+
+    size_t tableCount() const;
+
+private:
+    struct Entry {
+        TableStatistics stats;
+        uint64_t version;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> tables_;  // 小写表名
+
+    const Entry* findLocked(std::string key) const;
+    uint64_t next_version_;
+};
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
@@ -0,0 +1,162 @@
+/**
+ * @file example_index.cpp
+ * @brief MinHash/LSH示例索引实现
+ */
+
+#include "example_index.h"
+#include "sql_lexer.h"
+#include <algorithm>
+#include <limits>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+inline uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/**
+ * @brief 形状记号扫描，每个记号以64位哈希交给回调
+ *
+ * 字面量统一记为'?'，标识符与关键字按小写哈希，符号取其字符值，分号忽略
+ */
+template <typename Sink>
+void scanShapeTokens(std::string_view sql, Sink&& sink) {
+    SqlLexer lexer(sql);
+    SqlToken token;
+    while (lexer.next(token)) {
+        if (token.isLiteral()) {
+            sink(static_cast<uint64_t>('?'), false);
+        } else if (token.isIdentifier()) {
+            uint64_t hash = kFnvOffset;
+            for (char c : token.text) {
+                hash = (hash ^ static_cast<unsigned char>(toLowerAscii(c))) * kFnvPrime;
+            }
+            sink(hash, true);
+        } else if (!token.isPunct(';')) {
+            sink(static_cast<uint64_t>(static_cast<unsigned char>(token.text[0])), false);
+        }
+    }
+}
+
+} // namespace
+
+ExampleIndex::Signature ExampleIndex::signature(std::string_view sql) {
+    Signature sig;
+    sig.fill(std::numeric_limits<uint32_t>::max());
+
+    auto addFeature = [&sig](uint64_t feature) {
+        const uint64_t base = mix(feature);
+        for (size_t i = 0; i < kNumHashes; ++i) {
+            // 双哈希派生第i个置换：h1 + i*h2
+            const auto h = static_cast<uint32_t>(
+                mix(base + i * 0x9e3779b97f4a7c15ULL) >> 32);
+            if (h < sig[i]) sig[i] = h;
+        }
+    };
+
+    uint64_t prev2 = 0;
+    uint64_t prev1 = 0;
+    size_t count = 0;
+    scanShapeTokens(sql, [&](uint64_t token, bool identifier) {
+        if (identifier) {
+            addFeature(token ^ 0x5bd1e995ULL);
+        }
+        if (++count >= 3) {
+            addFeature((prev2 * kFnvPrime ^ prev1) * kFnvPrime ^ token);
+        }
+        prev2 = prev1;
+        prev1 = token;
+    });
+    if (count > 0 && count < 3) {
+        addFeature(prev2 * kFnvPrime ^ prev1);
+    }
+    return sig;
+}
+
+double ExampleIndex::similarity(const Signature& a, const Signature& b) {
+    size_t equal = 0;
+    for (size_t i = 0; i < kNumHashes; ++i) {
+        equal += (a[i] == b[i]);
+    }
+    return static_cast<double>(equal) / kNumHashes;
+}
+
+uint64_t ExampleIndex::bandKey(const Signature& sig, size_t band) {
+    uint64_t key = kFnvOffset ^ band;
+    for (size_t r = 0; r < kRowsPerBand; ++r) {
+        key = mix(key ^ sig[band * kRowsPerBand + r]);
+    }
+    return key;
+}
+
+size_t ExampleIndex::add(std::string_view sql) {
+    const auto id = static_cast<uint32_t>(signatures_.size());
+    signatures_.push_back(signature(sql));
+    for (size_t band = 0; band < kBands; ++band) {
+        buckets_[band].emplace(bandKey(signatures_.back(), band), id);
+    }
+    return id;
+}
+
+std::vector<size_t> ExampleIndex::nearest(std::string_view sql, size_t k) const {
+    return nearest(signature(sql), k);
+}
+
+std::vector<size_t> ExampleIndex::nearest(const Signature& query, size_t k) const {
+    std::vector<size_t> result;
+    if (k == 0 || signatures_.empty()) {
+        return result;
+    }
+
+    std::vector<char> seen(signatures_.size(), 0);
+    std::vector<std::pair<double, size_t>> scored;
+    for (size_t band = 0; band < kBands; ++band) {
+        auto range = buckets_[band].equal_range(bandKey(query, band));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (!seen[it->second]) {
+                seen[it->second] = 1;
+                scored.emplace_back(similarity(query, signatures_[it->second]), it->second);
+            }
+        }
+    }
+    // LSH候选不足时线性扫描补足
+    if (scored.size() < k) {
+        for (size_t id = 0; id < signatures_.size(); ++id) {
+            if (!seen[id]) {
+                scored.emplace_back(similarity(query, signatures_[id]), id);
+            }
+        }
+    }
+
+    auto better = [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    };
+    const size_t take = std::min(k, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + take, scored.end(), better);
+    result.reserve(take);
+    for (size_t i = 0; i < take; ++i) {
+        result.push_back(scored[i].second);
+    }
+    return result;
+}
+
+void ExampleIndex::clear() {
+    signatures_.clear();
+    for (auto& bucket : buckets_) {
+        bucket.clear();
+    }
+}
+
+} // namespace llm
+} // namespace heimdall
@@ -0,0 +1,75 @@
+/**
+ * @file example_index.h
+ * @brief 基于MinHash/LSH的Few-shot示例相似度索引
+ */
+
+#ifndef HEIMDALL_EXAMPLE_INDEX_H
+#define HEIMDALL_EXAMPLE_INDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 示例相似度索引
+ *
+ * 每条SQL被切分为形状记号流：关键字与标识符保留（小写），字面量折叠为"?"，
+ * 括号、逗号与比较符各为一个记号。特征集合为记号三元组加全部标识符，
+ * 同结构（IN子查询、EXISTS、多表连接）且涉及相同表的查询相似度高。
+ *
+ * 特征集合压缩为64个MinHash值，按16个band×4行建立LSH桶。查询时
+ * 先取同桶候选按估计Jaccard排序；候选不足k个时再线性扫描全部签名补足
+ * （签名比较只是整数比较，数千条示例也在亚毫秒内完成）。
+ *
+ * 非线程安全，写入与查询由调用方同步。
+ */
+class ExampleIndex {
+public:
+    static constexpr size_t kNumHashes = 64;
+    static constexpr size_t kBands = 16;
+    static constexpr size_t kRowsPerBand = kNumHashes / kBands;
+
+    using Signature = std::array<uint32_t, kNumHashes>;
+
+    /**
+     * @brief 计算SQL的MinHash签名
+     */
+    static Signature signature(std::string_view sql);
+
+    /**
+     * @brief 两个签名的估计Jaccard相似度
+     */
+    static double similarity(const Signature& a, const Signature& b);
+
+    /**
+     * @brief 加入一条示例，返回其编号（按加入顺序从0开始）
+     */
+    size_t add(std::string_view sql);
+
+    /**
+     * @brief 返回与sql最相似的至多k条示例编号，按相似度降序，相同时编号小者优先
+     */
+    std::vector<size_t> nearest(std::string_view sql, size_t k) const;
+    std::vector<size_t> nearest(const Signature& query, size_t k) const;
+
+    size_t size() const { return signatures_.size(); }
+    void clear();
+
+private:
+    std::vector<Signature> signatures_;
+    // 每个band一张桶表：band哈希 -> 示例编号
+    std::array<std::unordered_multimap<uint64_t, uint32_t>, kBands> buckets_;
+
+    static uint64_t bandKey(const Signature& sig, size_t band);
+};
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ * @file example_store.cpp
+ * @brief Few-shot示例库实现
+ */
+
+#include "example_store.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+void appendEscaped(std::string& out, const std::string& field) {
+    for (char c : field) {
+        switch (c) {
+            case '\t': out += "\\t"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\\': out += "\\\\"; break;
+            default: out += c; break;
+        }
+    }
+}
+
+std::string unescape(const std::string& field) {
+    std::string out;
+    out.reserve(field.size());
+    for (size_t i = 0; i < field.size(); ++i) {
+        if (field[i] != '\\' || i + 1 == field.size()) {
+            out += field[i];
+            continue;
+        }
+        switch (field[++i]) {
+            case 't': out += '\t'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            default: out += field[i]; break;
+        }
+    }
+    return out;
+}
+
+std::vector<std::string> splitTabs(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        const size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos
+                                                                      : tab - start));
+        if (tab == std::string::npos) break;
+        start = tab + 1;
+    }
+    return fields;
+}
+
+} // namespace
+
+ExampleStore::ExampleStore(const ExampleStoreConfig& config)
+    : config_(config), dirty_(false) {}
+
+double ExampleStore::value(const Entry& entry) {
+    return std::log2(std::max(entry.example.speedup_ratio, 1.0)) *
+           (1.0 + std::log2(static_cast<double>(std::max<uint64_t>(entry.occurrences, 1))));
+}
+
+bool ExampleStore::harvest(uint64_t digest, const FewShotExample& example) {
+    if (example.speedup_ratio < config_.min_speedup ||
+        example.original_sql.size() > config_.max_sql_length ||
+        example.optimized_sql.size() > config_.max_sql_length ||
+        example.original_sql == example.optimized_sql) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(digest);
+    if (it != entries_.end()) {
+        // 出现次数参与价值计算并被持久化，加速比更低时示例不变但仍需保存
+        ++it->second.occurrences;
+        dirty_ = true;
+        if (example.speedup_ratio <= it->second.example.speedup_ratio) {
+            return false;
+        }
+        it->second.example = example;
+        return true;
+    }
+    entries_.emplace(digest, Entry{example, 1});
+    dirty_ = true;
+    evictLocked();
+    return entries_.count(digest) > 0;
+}
+
+void ExampleStore::evictLocked() {
+    while (entries_.size() > config_.max_examples) {
+        auto victim = entries_.begin();
+        double lowest = value(victim->second);
+        for (auto it = std::next(entries_.begin()); it != entries_.end(); ++it) {
+            const double v = value(it->second);
+            if (v < lowest) {
+                lowest = v;
+                victim = it;
+            }
+        }
+        entries_.erase(victim);
+    }
+}
+
+std::vector<FewShotExample> ExampleStore::examples() const {
+    std::vector<std::pair<double, const Entry*>> ranked;
+    std::lock_guard<std::mutex> lock(mutex_);
+    ranked.reserve(entries_.size());
+    for (const auto& entry : entries_) {
+        ranked.emplace_back(value(entry.second), &entry.second);
+    }
+    std::sort(ranked.begin(), ranked.end(),
+              [](const auto& a, const auto& b) {
+                  if (a.first != b.first) return a.first > b.first;
+                  return a.second->example.original_sql < b.second->example.original_sql;
+              });
+    std::vector<FewShotExample> result;
+    result.reserve(ranked.size());
+    for (const auto& item : ranked) {
+        result.push_back(item.second->example);
+    }
+    return result;
+}
+
+bool ExampleStore::load(const std::string& path, std::string* error) {
+    std::ifstream file(path);
+    if (!file) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    std::unordered_map<uint64_t, Entry> loaded;
+    std::string line;
+    int line_no = 0;
+    while (std::getline(file, line)) {
+        ++line_no;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        // digest, speedup, occurrences, original, optimized, explanation
+        const auto fields = splitTabs(line);
+        if (fields.size() != 6) {
+            if (error) *error = path + ":" + std::to_string(line_no) + ": expected 6 fields";
+            return false;
+        }
+        Entry entry;
+        try {
+            const uint64_t digest = std::stoull(fields[0], nullptr, 16);
+            entry.example.speedup_ratio = std::stod(fields[1]);
+            entry.occurrences = std::stoull(fields[2]);
+            entry.example.original_sql = unescape(fields[3]);
+            entry.example.optimized_sql = unescape(fields[4]);
+            entry.example.explanation = unescape(fields[5]);
+            loaded[digest] = std::move(entry);
+        } catch (const std::exception&) {
+            if (error) *error = path + ":" + std::to_string(line_no) + ": malformed number";
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_ = std::move(loaded);
+    evictLocked();
+    dirty_ = false;
+    return true;
+}
+
+bool ExampleStore::save(const std::string& path) const {
+    std::string content = "# digest\tspeedup\toccurrences\toriginal\toptimized\texplanation\n";
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 按摘要排序，内容不变时文件逐字节相同
+        std::vector<std::pair<uint64_t, const Entry*>> ordered;
+        ordered.reserve(entries_.size());
+        for (const auto& item : entries_) {
+            ordered.emplace_back(item.first, &item.second);
+        }
+        std::sort(ordered.begin(), ordered.end());
+        for (const auto& item : ordered) {
+            const Entry& entry = *item.second;
+            char prefix[80];
+            std::snprintf(prefix, sizeof(prefix), "%016llx\t%.4f\t%llu\t",
+                          static_cast<unsigned long long>(item.first),
+                          entry.example.speedup_ratio,
+                          static_cast<unsigned long long>(entry.occurrences));
+            content += prefix;
+            appendEscaped(content, entry.example.original_sql);
+            content += '\t';
+            appendEscaped(content, entry.example.optimized_sql);
+            content += '\t';
+            appendEscaped(content, entry.example.explanation);
+            content += '\n';
+        }
+        dirty_ = false;
+    }
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::trunc);
+        if (!file || !(file << content) || !file.flush()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            dirty_ = true;
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        dirty_ = true;
+        return false;
+    }
+    return true;
+}
+
+bool ExampleStore::dirty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dirty_;
+}
+
+size_t ExampleStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void ExampleStore::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    dirty_ = true;
+}
+
+} // namespace llm
+} // namespace heimdall
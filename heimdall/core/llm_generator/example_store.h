@@ -0,0 +1,90 @@
+/**
+ * @file example_store.h
+ * @brief 从已验证的加速重写中自动收集的Few-shot示例库
+ */
+
+#ifndef HEIMDALL_EXAMPLE_STORE_H
+#define HEIMDALL_EXAMPLE_STORE_H
+
+#include "prompt_builder.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 示例库配置
+ */
+struct ExampleStoreConfig {
+    size_t max_examples;     // 容量上限，超出时淘汰价值最低的示例
+    double min_speedup;      // 低于该实测加速比的重写不收录
+    size_t max_sql_length;   // 过长的SQL会挤占Prompt，不收录
+
+    ExampleStoreConfig()
+        : max_examples(500),
+          min_speedup(1.2),
+          max_sql_length(4000) {}
+};
+
+/**
+ * @brief 自动收集的Few-shot示例库
+ *
+ * 每次优化成功并测得加速比后调用harvest()收录(原始SQL, 重写, 加速比)。
+ * 以查询模板摘要去重：同一模板只保留加速比最高的一条，并累计出现次数。
+ * 示例价值 = log2(加速比) × (1 + log2(出现次数))，既看收益也看该模板
+ * 在负载中是否反复出现；满员时淘汰价值最低者。
+ *
+ * 持久化为每行一条的制表符分隔文本（字段中的制表符、换行与反斜杠转义），
+ * 保存时先写临时文件再改名，进程崩溃不会留下半个文件。线程安全。
+ */
+class ExampleStore {
+public:
+    explicit ExampleStore(const ExampleStoreConfig& config = ExampleStoreConfig());
+
+    /**
+     * @brief 收录一条示例
+     * @param digest 原始SQL的模板摘要，用于去重
+     * @return 示例内容是否变化（新增或替换为更高加速比的版本）；
+     *         只累计出现次数时返回false，但dirty()为true
+     */
+    bool harvest(uint64_t digest, const FewShotExample& example);
+
+    /**
+     * @brief 按价值从高到低返回示例
+     */
+    std::vector<FewShotExample> examples() const;
+
+    bool load(const std::string& path, std::string* error = nullptr);
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief 自上次load()/save()以来是否有变化
+     */
+    bool dirty() const;
+
+    size_t size() const;
+    void clear();
+
+private:
+    struct Entry {
+        FewShotExample example;
+        uint64_t occurrences;
+    };
+
+    ExampleStoreConfig config_;
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, Entry> entries_;
+    mutable bool dirty_;
+
+    static double value(const Entry& entry);
+    void evictLocked();
+};
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
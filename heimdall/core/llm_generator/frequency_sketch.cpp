@@ -0,0 +1,90 @@
+/**
+ * @file frequency_sketch.cpp
+ * @brief Count-Min频率估计实现
+ */
+
+#include "frequency_sketch.h"
+#include <algorithm>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+constexpr uint64_t kSeeds[] = {
+    0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+    0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL,
+};
+
+constexpr uint64_t kResetMask = 0x7777777777777777ULL;
+
+inline uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+} // namespace
+
+FrequencySketch::FrequencySketch(size_t capacity) {
+    resize(capacity);
+}
+
+void FrequencySketch::resize(size_t capacity) {
+    size_t words = 8;
+    while (words < capacity) {
+        words <<= 1;
+    }
+    table_.assign(words, 0);
+    mask_ = words - 1;
+    sample_size_ = std::max<size_t>(capacity, 1) * 10;
+    additions_ = 0;
+}
+
+// 第row行的计数器：所在字由独立哈希决定，字内位于第row组的4个计数器之一
+size_t FrequencySketch::indexOf(uint64_t hash, int row) const {
+    return static_cast<size_t>(mix(hash + kSeeds[row]) & mask_);
+}
+
+void FrequencySketch::increment(uint64_t hash) {
+    bool added = false;
+    for (int row = 0; row < kDepth; ++row) {
+        const int shift = ((row << 2) + static_cast<int>((hash >> (row << 3)) & 3)) << 2;
+        uint64_t& word = table_[indexOf(hash, row)];
+        if (((word >> shift) & 0xF) != 0xF) {
+            word += 1ULL << shift;
+            added = true;
+        }
+    }
+    if (added && ++additions_ >= sample_size_) {
+        age();
+    }
+}
+
+int FrequencySketch::frequency(uint64_t hash) const {
+    int result = 0xF;
+    for (int row = 0; row < kDepth; ++row) {
+        const int shift = ((row << 2) + static_cast<int>((hash >> (row << 3)) & 3)) << 2;
+        const int count = static_cast<int>((table_[indexOf(hash, row)] >> shift) & 0xF);
+        result = std::min(result, count);
+    }
+    return result;
+}
+
+void FrequencySketch::clear() {
+    std::fill(table_.begin(), table_.end(), 0);
+    additions_ = 0;
+}
+
+void FrequencySketch::age() {
+    for (auto& word : table_) {
+        word = (word >> 1) & kResetMask;
+    }
+    additions_ /= 2;
+}
+
+} // namespace llm
+} // namespace heimdall
@@ -0,0 +1,53 @@
+/**
+ * @file frequency_sketch.h
+ * @brief 带衰减的Count-Min访问频率估计
+ */
+
+#ifndef HEIMDALL_FREQUENCY_SKETCH_H
+#define HEIMDALL_FREQUENCY_SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 4位计数器的Count-Min Sketch（TinyLFU）
+ *
+ * 每个64位字存放16个4位计数器，每个键在4行中各占一个计数器，
+ * 估计值取最小值，上限15。累计记录次数达到10倍容量时所有计数器减半，
+ * 使旧的热点逐渐让位于新的热点。
+ *
+ * 非线程安全，由调用方加锁。
+ */
+class FrequencySketch {
+public:
+    explicit FrequencySketch(size_t capacity = 1000);
+
+    /**
+     * @brief 按预期容纳的键数量重新分配（清空已有计数）
+     */
+    void resize(size_t capacity);
+
+    void increment(uint64_t hash);
+    int frequency(uint64_t hash) const;
+    void clear();
+
+private:
+    static constexpr int kDepth = 4;
+
+    std::vector<uint64_t> table_;
+    uint64_t mask_;
+    size_t sample_size_;   // 达到该记录次数后执行衰减
+    size_t additions_;
+
+    size_t indexOf(uint64_t hash, int row) const;
+    void age();
+};
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
@@ -0,0 +1,580 @@
+/**
+ * @file llm_client.cpp
+ * @brief LLM API客户端实现
+ */
+
+#include "llm_client.h"
+#include "response_cache.h"
+#include "sql_grammar.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef USE_CURL
+#include <curl/curl.h>
+#endif
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const char* kOpenAIBaseUrl = "https://api.openai.com/v1";
+
+std::string jsonEscape(const std::string& text) {
+    std::string out;
+    out.reserve(text.size() + 16);
+    for (char c : text) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out;
+}
+
+void appendUtf8(std::string& out, unsigned code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// 解析从json[i]（开引号）开始的JSON字符串，返回结束引号之后的位置，失败返回npos
+size_t parseJsonString(const std::string& json, size_t i, std::string* out) {
+    out->clear();
+    ++i;
+    while (i < json.size()) {
+        const char c = json[i];
+        if (c == '"') {
+            return i + 1;
+        }
+        if (c != '\\') {
+            *out += c;
+            ++i;
+            continue;
+        }
+        if (i + 1 >= json.size()) {
+            return std::string::npos;
+        }
+        const char e = json[i + 1];
+        i += 2;
+        switch (e) {
+        case 'n': *out += '\n'; break;
+        case 't': *out += '\t'; break;
+        case 'r': *out += '\r'; break;
+        case 'b': *out += '\b'; break;
+        case 'f': *out += '\f'; break;
+        case 'u': {
+            if (i + 4 > json.size()) return std::string::npos;
+            unsigned code = 0;
+            for (size_t k = 0; k < 4; ++k) {
+                const char h = json[i + k];
+                code <<= 4;
+                if (h >= '0' && h <= '9') code |= static_cast<unsigned>(h - '0');
+                else if (h >= 'a' && h <= 'f') code |= static_cast<unsigned>(h - 'a' + 10);
+                else if (h >= 'A' && h <= 'F') code |= static_cast<unsigned>(h - 'A' + 10);
+                else return std::string::npos;
+            }
+            appendUtf8(*out, code);
+            i += 4;
+            break;
+        }
+        default: *out += e; break;
+        }
+    }
+    return std::string::npos;
+}
+
+inline size_t skipJsonSpace(const std::string& json, size_t i) {
+    while (i < json.size() &&
+           (json[i] == ' ' || json[i] == '\n' || json[i] == '\r' || json[i] == '\t')) {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * @brief 收集所有 "key": "..." 与 "key": ["...", ...] 的字符串值
+ *
+ * 只为读取提供商响应中的content/text/candidates字段，不是通用JSON解析器
+ */
+std::vector<std::string> findJsonStrings(const std::string& json, const std::string& key) {
+    std::vector<std::string> values;
+    const std::string quoted = "\"" + key + "\"";
+    size_t pos = 0;
+    std::string value;
+    while ((pos = json.find(quoted, pos)) != std::string::npos) {
+        size_t i = skipJsonSpace(json, pos + quoted.size());
+        pos += quoted.size();
+        if (i >= json.size() || json[i] != ':') {
+            continue;
+        }
+        i = skipJsonSpace(json, i + 1);
+        if (i < json.size() && json[i] == '"') {
+            const size_t end = parseJsonString(json, i, &value);
+            if (end != std::string::npos) {
+                values.push_back(value);
+                pos = end;
+            }
+        } else if (i < json.size() && json[i] == '[') {
+            i = skipJsonSpace(json, i + 1);
+            while (i < json.size() && json[i] == '"') {
+                const size_t end = parseJsonString(json, i, &value);
+                if (end == std::string::npos) break;
+                values.push_back(value);
+                i = skipJsonSpace(json, end);
+                if (i < json.size() && json[i] == ',') {
+                    i = skipJsonSpace(json, i + 1);
+                }
+            }
+            pos = i;
+        }
+    }
+    return values;
+}
+
+std::string trimText(const std::string& text) {
+    const size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return std::string();
+    const size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+// 从模型输出中提取SQL：优先```sql代码块，其次任意代码块，否则整段文本
+std::string extractSql(const std::string& text) {
+    size_t start = text.find("```sql");
+    if (start != std::string::npos) {
+        start += 6;
+    } else if ((start = text.find("```")) != std::string::npos) {
+        start += 3;
+    }
+    if (start != std::string::npos) {
+        const size_t end = text.find("```", start);
+        if (end != std::string::npos) {
+            return trimText(text.substr(start, end - start));
+        }
+    }
+    return trimText(text);
+}
+
+// 原始响应加上全部候选输出的字节数，提取出的SQL不会超过对应输出
+size_t payloadBytes(const std::string& raw, const std::vector<std::string>& outputs) {
+    size_t bytes = raw.size();
+    for (const auto& output : outputs) {
+        bytes += output.size();
+    }
+    return bytes;
+}
+
+/**
+ * @brief 把模型输出的候选写入响应；grammar非空时丢弃不符合语法的候选
+ */
+void addCandidates(LLMResponseBuilder& builder, const std::vector<std::string>& outputs,
+                   const SqlGrammar* grammar) {
+    for (const auto& output : outputs) {
+        const std::string sql = extractSql(output);
+        if (sql.empty()) {
+            continue;
+        }
+        if (grammar && !grammar->accepts(sql)) {
+            continue;
+        }
+        builder.addCandidate(sql);
+    }
+}
+
+#ifdef USE_CURL
+size_t appendBody(char* data, size_t size, size_t count, void* user) {
+    static_cast<std::string*>(user)->append(data, size * count);
+    return size * count;
+}
+
+bool curlPost(const std::string& url, const std::vector<std::string>& headers,
+              const std::string& body, std::string* response, std::string* error) {
+    static const bool initialized = curl_global_init(CURL_GLOBAL_DEFAULT) == CURLE_OK;
+    if (!initialized) {
+        if (error) *error = "curl initialization failed";
+        return false;
+    }
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        if (error) *error = "curl_easy_init failed";
+        return false;
+    }
+    struct curl_slist* list = nullptr;
+    for (const auto& header : headers) {
+        list = curl_slist_append(list, header.c_str());
+    }
+    response->clear();
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, list);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, appendBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 120L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+    const CURLcode code = curl_easy_perform(curl);
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    curl_slist_free_all(list);
+    curl_easy_cleanup(curl);
+
+    if (code != CURLE_OK) {
+        if (error) *error = curl_easy_strerror(code);
+        return false;
+    }
+    if (status < 200 || status >= 300) {
+        if (error) *error = "HTTP status " + std::to_string(status);
+        return false;
+    }
+    return true;
+}
+#endif
+
+LLMResponse failure(const std::string& message, Clock::time_point start) {
+    LLMResponseBuilder builder(message.size());
+    builder.setError(message);
+    builder.setLatency(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    return builder.build();
+}
+
+std::string cacheKey(const std::string& prompt, const GenerationConfig& config) {
+    std::string key;
+    key.reserve(prompt.size() + 64);
+    key += config.model_name;
+    key += '\x1f';
+    key += std::to_string(config.temperature);
+    key += '\x1f';
+    key += std::to_string(config.num_candidates);
+    key += '\x1f';
+    key += std::to_string(config.max_tokens);
+    key += '\x1f';
+    if (config.grammar) {
+        key += std::to_string(std::hash<std::string>()(config.grammar->gbnf()));
+    }
+    key += '\x1f';
+    key += prompt;
+    return key;
+}
+
+} // namespace
+
+HttpTransport defaultHttpTransport() {
+#ifdef USE_CURL
+    return curlPost;
+#else
+    return [](const std::string&, const std::vector<std::string>&, const std::string&,
+              std::string*, std::string* error) {
+        if (error) *error = "HTTP support not available (built without libcurl)";
+        return false;
+    };
+#endif
+}
+
+// ==================== OpenAIProvider ====================
+
+OpenAIProvider::OpenAIProvider(const std::string& api_key)
+    : api_key_(api_key),
+      base_url_(kOpenAIBaseUrl),
+      transport_(defaultHttpTransport()) {}
+
+LLMResponse OpenAIProvider::generate(const std::string& prompt,
+                                     const GenerationConfig& config) {
+    const auto start = Clock::now();
+    std::string body = "{\"model\":\"" + jsonEscape(config.model_name) + "\"";
+    body += ",\"messages\":[{\"role\":\"user\",\"content\":\"" + jsonEscape(prompt) + "\"}]";
+    body += ",\"temperature\":" + std::to_string(config.temperature);
+    body += ",\"max_tokens\":" + std::to_string(config.max_tokens);
+    body += ",\"n\":" + std::to_string(config.num_candidates);
+    body += '}';
+
+    std::string raw;
+    std::string error;
+    const std::vector<std::string> headers = {
+        "Authorization: Bearer " + api_key_,
+        "Content-Type: application/json"};
+    if (!transport_ || !transport_(base_url_ + "/chat/completions", headers, body, &raw, &error)) {
+        return failure("OpenAI request failed: " + error, start);
+    }
+
+    const std::vector<std::string> outputs = findJsonStrings(raw, "content");
+    LLMResponseBuilder builder(payloadBytes(raw, outputs));
+    builder.setRawResponse(raw);
+    // 远程API不支持语法约束，按接口约定在本地过滤
+    addCandidates(builder, outputs, config.grammar.get());
+    builder.setLatency(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    return builder.build();
+}
+
+bool OpenAIProvider::isAvailable() const {
+    return !api_key_.empty() && static_cast<bool>(transport_);
+}
+
+// ==================== LocalModelProvider ====================
+
+LocalModelProvider::LocalModelProvider(const std::string& endpoint)
+    : endpoint_(endpoint),
+      transport_(defaultHttpTransport()) {}
+
+LLMResponse LocalModelProvider::generate(const std::string& prompt,
+                                         const GenerationConfig& config) {
+    const auto start = Clock::now();
+    const bool send_grammar = config.grammar && grammar_supported_;
+
+    std::string body = "{\"prompt\":\"" + jsonEscape(prompt) + "\"";
+    body += ",\"temperature\":" + std::to_string(config.temperature);
+    body += ",\"max_tokens\":" + std::to_string(config.max_tokens);
+    body += ",\"n\":" + std::to_string(config.num_candidates);
+    if (send_grammar) {
+        body += ",\"grammar\":\"" + jsonEscape(config.grammar->gbnf()) + "\"";
+    }
+    body += '}';
+
+    std::string raw;
+    std::string error;
+    const std::vector<std::string> headers = {"Content-Type: application/json"};
+    if (!transport_ || !transport_(endpoint_, headers, body, &raw, &error)) {
+        return failure("local model request failed: " + error, start);
+    }
+
+    std::vector<std::string> outputs = findJsonStrings(raw, "candidates");
+    if (outputs.empty()) {
+        outputs = findJsonStrings(raw, "text");
+    }
+    if (outputs.empty()) {
+        outputs = findJsonStrings(raw, "content");
+    }
+
+    LLMResponseBuilder builder(payloadBytes(raw, outputs));
+    builder.setRawResponse(raw);
+    // 服务端已按语法约束解码时不再重复校验
+    addCandidates(builder, outputs, send_grammar ? nullptr : config.grammar.get());
+    builder.setLatency(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    return builder.build();
+}
+
+bool LocalModelProvider::isAvailable() const {
+    return !endpoint_.empty() && static_cast<bool>(transport_);
+}
+
+// ==================== LLMClient ====================
+
+class LLMClient::Impl {
+public:
+    std::mutex mutex;  // 保护providers/current/governor/cache指针
+    std::unordered_map<std::string, std::shared_ptr<LLMProvider>> providers;
+    std::shared_ptr<LLMProvider> current;
+
+    bool cache_enabled = false;
+    ResponseCacheOptions cache_options;
+    std::shared_ptr<ResponseCache> cache;
+
+    std::shared_ptr<BudgetGovernor> governor;
+
+    std::atomic<size_t> in_flight{0};
+
+    std::shared_ptr<LLMProvider> provider() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return current;
+    }
+
+    std::shared_ptr<BudgetGovernor> budgetGovernor() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return governor;
+    }
+
+    std::shared_ptr<ResponseCache> responseCache() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cache_enabled ? cache : nullptr;
+    }
+};
+
+LLMClient::LLMClient() : pimpl_(new Impl()) {}
+
+LLMClient::~LLMClient() = default;
+
+void LLMClient::registerProvider(std::shared_ptr<LLMProvider> provider) {
+    if (!provider) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    const std::string name = provider->getName();
+    if (!pimpl_->current) {
+        pimpl_->current = provider;
+    }
+    pimpl_->providers[name] = std::move(provider);
+}
+
+void LLMClient::setProvider(const std::string& provider_name) {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    auto it = pimpl_->providers.find(provider_name);
+    if (it != pimpl_->providers.end()) {
+        pimpl_->current = it->second;
+    }
+}
+
+LLMResponsePtr LLMClient::generateRewrites(const std::string& original_sql,
+                                           const std::string& schema_context,
+                                           const GenerationConfig& config) {
+    std::string prompt;
+    prompt.reserve(schema_context.size() + original_sql.size() + 128);
+    prompt += schema_context;
+    prompt += "\n\n## Original Query\n```sql\n";
+    prompt += original_sql;
+    prompt += "\n```\n\nOutput ONLY the optimized SQL query inside a ```sql code block.";
+    return generateFromPrompt(prompt, config);
+}
+
+LLMResponsePtr LLMClient::generateFromPrompt(const std::string& prompt,
+                                             const GenerationConfig& config) {
+    const auto start = Clock::now();
+
+    auto cache = pimpl_->responseCache();
+    std::string key;
+    if (cache) {
+        key = cacheKey(prompt, config);
+        if (LLMResponsePtr cached = cache->get(key)) {
+            return cached;
+        }
+    }
+
+    auto provider = pimpl_->provider();
+    if (!provider) {
+        return std::make_shared<const LLMResponse>(failure("no LLM provider configured", start));
+    }
+
+    auto governor = pimpl_->budgetGovernor();
+    BudgetRequest budget;
+    if (governor) {
+        budget.scope = config.budget_scope;
+        budget.prompt_tokens = BudgetGovernor::estimateTokens(prompt);
+        budget.max_completion_tokens = static_cast<size_t>(std::max(0, config.max_tokens)) *
+                                       static_cast<size_t>(std::max(1, config.num_candidates));
+        budget.expected_savings = config.expected_savings;
+        if (governor->tryAdmit(budget) != BudgetDecision::ADMITTED) {
+            LLMResponseBuilder builder;
+            builder.setError("LLM budget exhausted");
+            builder.setBudgetRejected();
+            return builder.buildShared();
+        }
+    }
+
+    LLMResponse response;
+    pimpl_->in_flight.fetch_add(1);
+    try {
+        response = provider->generate(prompt, config);
+    } catch (const std::exception& e) {
+        response = failure(std::string("provider error: ") + e.what(), start);
+    } catch (...) {
+        response = failure("provider error", start);
+    }
+    pimpl_->in_flight.fetch_sub(1);
+
+    if (governor) {
+        // 请求已发出：按实际用量结算，未收到响应时completion计为0
+        governor->settle(budget, budget.prompt_tokens,
+                         BudgetGovernor::estimateTokens(response.raw_response));
+    }
+
+    if (response.latency_ms <= 0.0) {
+        response.latency_ms =
+            std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+    if (response.success && response.candidates.empty()) {
+        // 全部候选被语法过滤掉时按失败处理，不缓存
+        response.success = false;
+    }
+
+    auto shared = std::make_shared<const LLMResponse>(std::move(response));
+    if (cache && shared->success) {
+        cache->put(key, shared);
+    }
+    return shared;
+}
+
+void LLMClient::setBudgetGovernor(std::shared_ptr<BudgetGovernor> governor) {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    pimpl_->governor = std::move(governor);
+}
+
+void LLMClient::enableCache(bool enable, size_t max_size) {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    pimpl_->cache_enabled = enable;
+    pimpl_->cache_options.max_entries = max_size;
+    if (!pimpl_->cache) {
+        pimpl_->cache = std::make_shared<ResponseCache>(pimpl_->cache_options);
+    } else {
+        pimpl_->cache->setOptions(pimpl_->cache_options);
+    }
+}
+
+void LLMClient::enableCacheCompression(bool enable, size_t max_bytes,
+                                       size_t retrain_interval) {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    pimpl_->cache_options.compress = enable;
+    pimpl_->cache_options.max_bytes = max_bytes;
+    if (retrain_interval > 0) {
+        pimpl_->cache_options.retrain_interval = retrain_interval;
+    }
+    if (pimpl_->cache) {
+        pimpl_->cache->setOptions(pimpl_->cache_options);
+    }
+}
+
+void LLMClient::enableCacheAdmission(bool enable, double window_fraction) {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    pimpl_->cache_options.admission = enable;
+    pimpl_->cache_options.window_fraction = window_fraction;
+    if (pimpl_->cache) {
+        pimpl_->cache->setOptions(pimpl_->cache_options);
+    }
+}
+
+size_t LLMClient::inFlightRequests() const {
+    return pimpl_->in_flight.load();
+}
+
+LLMClient::CacheStats LLMClient::getCacheStats() const {
+    CacheStats stats{0, 0, 0.0};
+    std::shared_ptr<ResponseCache> cache;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        cache = pimpl_->cache;
+    }
+    if (cache) {
+        const ResponseCache::Stats cache_stats = cache->getStats();
+        stats.hits = cache_stats.hits;
+        stats.misses = cache_stats.misses;
+        const size_t total = stats.hits + stats.misses;
+        stats.hit_rate = total > 0 ? static_cast<double>(stats.hits) / static_cast<double>(total) : 0.0;
+    }
+    return stats;
+}
+
+} // namespace llm
+} // namespace heimdall
@@ -6,14 +6,20 @@
 #ifndef HEIMDALL_LLM_CLIENT_H
 #define HEIMDALL_LLM_CLIENT_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
 #include <functional>
+#include <utility>
+#include "budget_governor.h"
+#include "llm_response.h"
 
 namespace heimdall {
 namespace llm {
 
+class SqlGrammar;
+
 /**
  * @brief LLM生成配置
  */
@@ -23,30 +29,42 @@ struct GenerationConfig {
     int max_tokens;               // 最大token数
     int num_candidates;           // 生成候选数量
     bool use_few_shot;            // 是否使用few-shot示例
+    std::shared_ptr<const SqlGrammar> grammar;  // 约束解码语法(为空表示不约束)
+    std::string budget_scope;     // 预算归属(schema/用户)，空表示只受全局预算限制
+    double expected_savings;      // 预期收益，预算紧张时用于排序
+    size_t prompt_prefix_length;  // Prompt中跨请求稳定的前缀长度(PromptPrefix)，0表示未知
+    uint64_t prompt_prefix_hash;  // 该前缀的哈希，可用于路由到持有相同KV缓存的实例
 
     GenerationConfig()
         : model_name("gpt-4"),
           temperature(0.3),
           max_tokens(2000),
           num_candidates(3),
-          use_few_shot(true) {}
+          use_few_shot(true),
+          expected_savings(0.0),
+          prompt_prefix_length(0),
+          prompt_prefix_hash(0) {}
 };
 
 /**
- * @brief LLM响应
+ * @brief HTTP POST传输，成功时把响应体写入response
+ *
+ * 默认实现基于libcurl（编译时定义USE_CURL）；未编译CURL支持时总是失败。
+ * 可替换为自定义网络栈
  */
-struct LLMResponse {
-    std::vector<std::string> candidates;  // SQL候选列表
-    std::string raw_response;             // 原始响应
-    bool success;                         // 是否成功
-    std::string error_message;            // 错误信息
-    double latency_ms;                    // 延迟(毫秒)
-
-    LLMResponse() : success(false), latency_ms(0.0) {}
-};
+using HttpTransport = std::function<bool(const std::string& url,
+                                         const std::vector<std::string>& headers,
+                                         const std::string& body,
+                                         std::string* response,
+                                         std::string* error)>;
+
+HttpTransport defaultHttpTransport();
 
 /**
  * @brief LLM提供商接口
+ *
+ * config.grammar非空时，支持约束解码的提供商应将其作为解码约束；
+ * 进程内提供商必须只返回grammar->accepts()通过的候选。
  */
 class LLMProvider {
 public:
@@ -70,9 +88,12 @@ public:
     std::string getName() const override { return "OpenAI"; }
     bool isAvailable() const override;
 
+    void setTransport(HttpTransport transport) { transport_ = std::move(transport); }
+
 private:
     std::string api_key_;
     std::string base_url_;
+    HttpTransport transport_;
 };
 
 /**
@@ -87,8 +108,21 @@ public:
     std::string getName() const override { return "LocalModel"; }
     bool isAvailable() const override;
 
+    /**
+     * @brief 声明服务端支持GBNF语法约束
+     *
+     * 开启后请求体携带"grammar"字段(config.grammar->gbnf())；
+     * 未开启时生成结果在本地用grammar->accepts()过滤
+     */
+    void setGrammarSupported(bool supported) { grammar_supported_ = supported; }
+    bool isGrammarSupported() const { return grammar_supported_; }
+
+    void setTransport(HttpTransport transport) { transport_ = std::move(transport); }
+
 private:
     std::string endpoint_;
+    bool grammar_supported_ = false;
+    HttpTransport transport_;
 };
 
 /**
@@ -112,15 +146,58 @@ public:
     /**
      * @brief 生成SQL重写候选
      */
-    LLMResponse generateRewrites(const std::string& original_sql,
-                                const std::string& schema_context,
-                                const GenerationConfig& config = GenerationConfig());
+    LLMResponsePtr generateRewrites(const std::string& original_sql,
+                                    const std::string& schema_context,
+                                    const GenerationConfig& config = GenerationConfig());
+
+    /**
+     * @brief 直接发送已构建好的Prompt
+     *
+     * 用于修复轮次等多轮场景：调用方以上一轮Prompt为前缀追加内容，
+     * 提供商可复用前缀的KV缓存
+     */
+    LLMResponsePtr generateFromPrompt(const std::string& prompt,
+                                      const GenerationConfig& config = GenerationConfig());
 
     /**
      * @brief 设置缓存机制
+     *
+     * 缓存保存共享只读响应(ResponseCache)，命中时返回同一对象而不复制
      */
     void enableCache(bool enable, size_t max_size = 1000);
 
+    /**
+     * @brief 启用缓存值压缩
+     * @param max_bytes 缓存内存预算，0表示只按条目数限制
+     * @param retrain_interval 每写入N条重新训练字典，0表示沿用当前值
+     *
+     * 缓存值经由缓存内容训练出的共享字典压缩，相同内存可容纳更多条目
+     */
+    void enableCacheCompression(bool enable, size_t max_bytes = 0,
+                                size_t retrain_interval = 0);
+
+    /**
+     * @brief 设置缓存的TinyLFU准入过滤
+     * @param window_fraction 准入窗口占缓存容量的比例
+     *
+     * 开启时新条目先进入小窗口，只有比主区淘汰候选更常被访问才能留下
+     */
+    void enableCacheAdmission(bool enable, double window_fraction = 0.01);
+
+    /**
+     * @brief 设置预算控制器
+     *
+     * 每次调用提供商前按config.budget_scope/expected_savings申请预算，
+     * 被拒绝时立即返回budget_rejected=true的失败响应，不等待、不排队；
+     * 缓存命中不消耗预算
+     */
+    void setBudgetGovernor(std::shared_ptr<BudgetGovernor> governor);
+
+    /**
+     * @brief 当前正在进行中的提供商请求数，用于判断提供商是否空闲
+     */
+    size_t inFlightRequests() const;
+
     /**
      * @brief 获取缓存统计
      */
@@ -0,0 +1,79 @@
+/**
+ * @file llm_response.cpp
+ * @brief LLM响应构建实现
+ */
+
+#include "llm_response.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+// 没有预计大小时（错误信息等短文本）的首块大小
+constexpr size_t kMinBlockBytes = 64;
+
+} // namespace
+
+void* ResponseBuffer::CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    allocated_ += bytes;
+    return p;
+}
+
+void ResponseBuffer::CountingResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    allocated_ -= bytes;
+}
+
+ResponseBuffer::ResponseBuffer(size_t expected_bytes)
+    : arena_(std::max(expected_bytes, kMinBlockBytes), &upstream_) {}
+
+std::string_view ResponseBuffer::store(std::string_view text) {
+    if (text.empty()) {
+        return std::string_view();
+    }
+    char* dst = static_cast<char*>(arena_.allocate(text.size(), alignof(char)));
+    std::memcpy(dst, text.data(), text.size());
+    return std::string_view(dst, text.size());
+}
+
+LLMResponseBuilder::LLMResponseBuilder(size_t expected_bytes)
+    : buffer_(std::make_shared<ResponseBuffer>(expected_bytes)) {}
+
+void LLMResponseBuilder::setRawResponse(std::string_view raw) {
+    response_.raw_response = buffer_->store(raw);
+}
+
+void LLMResponseBuilder::addCandidate(std::string_view sql) {
+    response_.candidates.push_back(buffer_->store(sql));
+}
+
+void LLMResponseBuilder::setError(std::string_view message) {
+    response_.error_message = buffer_->store(message);
+}
+
+void LLMResponseBuilder::setLatency(double latency_ms) {
+    response_.latency_ms = latency_ms;
+}
+
+void LLMResponseBuilder::setBudgetRejected() {
+    response_.budget_rejected = true;
+}
+
+LLMResponse LLMResponseBuilder::build() {
+    response_.success = response_.error_message.empty() &&
+                        !response_.budget_rejected;
+    response_.buffer = std::move(buffer_);
+    return std::move(response_);
+}
+
+LLMResponsePtr LLMResponseBuilder::buildShared() {
+    return std::make_shared<const LLMResponse>(build());
+}
+
+} // namespace llm
+} // namespace heimdall
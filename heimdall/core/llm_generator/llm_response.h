@@ -0,0 +1,121 @@
+/**
+ * @file llm_response.h
+ * @brief 池化后备缓冲的LLM响应
+ */
+
+#ifndef HEIMDALL_LLM_RESPONSE_H
+#define HEIMDALL_LLM_RESPONSE_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 单次请求的响应后备缓冲
+ *
+ * monotonic_buffer_resource按顺序分配，首块按构建时给出的预计字节数申请，
+ * 不足时再向上游追加；请求内的所有文本只追加、不释放，
+ * 响应销毁时整体回收。构建完成后只读，可在线程间共享。
+ */
+class ResponseBuffer {
+public:
+    explicit ResponseBuffer(size_t expected_bytes = 0);
+    ResponseBuffer(const ResponseBuffer&) = delete;
+    ResponseBuffer& operator=(const ResponseBuffer&) = delete;
+
+    /**
+     * @brief 拷贝文本到缓冲中，返回指向缓冲的视图
+     */
+    std::string_view store(std::string_view text);
+
+    /**
+     * @brief 实际占用的内存：对象本身加上向上游申请的全部块
+     */
+    size_t footprint() const { return sizeof(*this) + upstream_.allocated(); }
+
+private:
+    // 统计向上游申请的字节数，分配本身交给默认资源
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        size_t allocated() const { return allocated_; }
+
+    private:
+        size_t allocated_ = 0;
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    CountingResource upstream_;
+    std::pmr::monotonic_buffer_resource arena_;
+};
+
+/**
+ * @brief LLM响应
+ *
+ * 所有文本字段都是指向buffer的视图；拷贝响应只增加buffer的引用计数，
+ * 不复制文本。视图的生命周期与buffer一致。
+ */
+struct LLMResponse {
+    std::shared_ptr<const ResponseBuffer> buffer;  // 共享只读后备缓冲
+    std::vector<std::string_view> candidates;      // SQL候选列表
+    std::string_view raw_response;                 // 原始响应
+    bool success;                                  // 是否成功
+    std::string_view error_message;                // 错误信息
+    double latency_ms;                             // 延迟(毫秒)
+    bool budget_rejected;                          // 因预算不足未发出请求
+
+    LLMResponse() : success(false), latency_ms(0.0), budget_rejected(false) {}
+};
+
+/**
+ * @brief 共享只读响应，缓存命中时直接交出同一份对象
+ */
+using LLMResponsePtr = std::shared_ptr<const LLMResponse>;
+
+/**
+ * @brief LLM响应构建器
+ *
+ * 提供商解析HTTP结果时把原始响应、候选与错误信息逐个写入同一块缓冲，
+ * 最终得到一次性构建、不可变的响应。
+ */
+class LLMResponseBuilder {
+public:
+    /**
+     * @param expected_bytes 预计写入的文本总字节数，用于一次申请足够的缓冲
+     */
+    explicit LLMResponseBuilder(size_t expected_bytes = 0);
+
+    void setRawResponse(std::string_view raw);
+    void addCandidate(std::string_view sql);
+    void setError(std::string_view message);
+    void setLatency(double latency_ms);
+    void setBudgetRejected();
+
+    /**
+     * @brief 以值形式取出响应（提供商接口使用），构建器随后不可再用
+     */
+    LLMResponse build();
+
+    /**
+     * @brief 以共享只读形式取出响应（客户端与缓存使用）
+     */
+    LLMResponsePtr buildShared();
+
+private:
+    std::shared_ptr<ResponseBuffer> buffer_;
+    LLMResponse response_;
+};
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
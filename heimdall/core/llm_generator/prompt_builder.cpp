@@ -0,0 +1,545 @@
+/**
+ * @file prompt_builder.cpp
+ * @brief 智能Prompt构建器实现
+ */
+
+#include "prompt_builder.h"
+#include "budget_governor.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+namespace heimdall {
+namespace llm {
+
+namespace prompts {
+
+const char* DEFAULT_SYSTEM_PROMPT =
+    "You are an expert SQL performance engineer working on TXSQL database optimization.\n"
+    "Your task is to rewrite inefficient SQL queries to achieve better performance "
+    "while maintaining 100% semantic equivalence.\n"
+    "\n"
+    "Key principles:\n"
+    "1. MUST preserve exact semantic equivalence - results must be identical\n"
+    "2. Focus on performance improvements: reduce subqueries, optimize joins, eliminate redundancy\n"
+    "3. Apply proven optimization techniques: subquery unnesting, predicate pushdown, join reordering\n"
+    "4. Output ONLY the optimized SQL code, no explanations\n";
+
+const char* PERFORMANCE_FOCUSED_PROMPT =
+    "You are an expert SQL performance engineer working on TXSQL database optimization.\n"
+    "Rewrite the query so that it runs as fast as possible on TXSQL while returning "
+    "exactly the same result.\n"
+    "Prefer plans that touch fewer rows: unnest subqueries, push predicates down, "
+    "join on indexed keys and avoid repeated scans of large fact tables.\n"
+    "Output ONLY the optimized SQL code, no explanations\n";
+
+const char* SAFETY_CONSTRAINTS =
+    "- Keep the output columns, their order, duplicates and NULL semantics unchanged\n"
+    "- Do not add non-deterministic functions or change LIMIT/ORDER BY semantics\n"
+    "- Never emit INSERT, UPDATE, DELETE or DDL statements\n";
+
+} // namespace prompts
+
+namespace {
+
+// 逻辑槽位，按名字映射到模板中的下标，模板调整槽位顺序不影响填充
+enum RewriteSlot {
+    SLOT_SYSTEM_PROMPT,
+    SLOT_CONSTRAINTS,
+    SLOT_HINTS,
+    SLOT_STABLE_EXAMPLES,
+    SLOT_SCHEMAS,
+    SLOT_EXAMPLES,
+    SLOT_QUERY,
+    SLOT_COUNT
+};
+
+// 越稳定的内容越靠前，逐请求变化的SQL放在最后，保证前缀逐字节相同
+const char* const kRewriteTemplate =
+    "{{system_prompt}}\n"
+    "{{constraints}}\n"
+    "{{hints}}"
+    "{{stable_examples}}"
+    "{{schemas}}"
+    "{{examples}}"
+    "## Query to Optimize\n\n"
+    "Rewrite the following query for better performance:\n"
+    "```sql\n{{query}}\n```\n";
+
+uint64_t hashBytes(std::string_view bytes) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : bytes) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+const char* const kRewriteSlotNames[SLOT_COUNT] = {
+    "system_prompt", "constraints", "hints", "stable_examples",
+    "schemas", "examples", "query",
+};
+
+struct RewriteTemplate {
+    PromptTemplate compiled;
+    size_t slot[SLOT_COUNT];  // 逻辑槽位 -> 模板槽位下标
+    size_t fragments;         // 片段数组长度，末尾一个留给模板中没有的槽位
+
+    RewriteTemplate()
+        : compiled(kRewriteTemplate), fragments(compiled.slotCount() + 1) {
+        for (size_t i = 0; i < SLOT_COUNT; ++i) {
+            const size_t index = compiled.slotIndex(kRewriteSlotNames[i]);
+            // 模板中没有的槽位写入末尾的空闲片段，不参与渲染
+            slot[i] = index == PromptTemplate::npos ? compiled.slotCount() : index;
+        }
+    }
+};
+
+const RewriteTemplate& rewriteTemplate() {
+    static const RewriteTemplate compiled;
+    return compiled;
+}
+
+const char* const kExamplesHeader = "## Examples of Successful Optimizations\n\n";
+const char* const kExampleTitle = "### Example ";
+
+const char* const kCompactSchemaHeader =
+    "## Database Schema\n"
+    "Format: table(column [PK | FK referenced_table] [~distinct values]) ~rows; "
+    "idx (indexed columns), U = unique\n\n";
+
+// 与BudgetGovernor::estimateTokens()的估算口径一致
+constexpr size_t kBytesPerToken = 4;
+
+// 示例标题中的序号，每个Prompt最多kMaxExamplesPerPrompt个示例
+const char* const kOrdinals[] = {"1", "2", "3", "4", "5", "6", "7", "8", "9"};
+constexpr size_t kMaxExamplesPerPrompt = sizeof(kOrdinals) / sizeof(kOrdinals[0]);
+
+struct Technique {
+    const char* name;
+    const char* description;
+};
+
+const Technique kTechniques[] = {
+    {"subquery_unnesting", "Convert correlated subqueries to JOINs when possible"},
+    {"predicate_pushdown", "Push filter conditions closer to data sources"},
+    {"join_reordering", "Reorder joins to reduce intermediate result size"},
+    {"redundancy_elimination", "Remove redundant conditions and operations"},
+    {"in_to_join", "Convert IN subqueries to JOIN operations"},
+    {"exists_to_join", "Convert EXISTS subqueries to JOIN operations"},
+};
+
+} // namespace
+
+PromptBuilder::PromptBuilder()
+    : system_prompt_(prompts::DEFAULT_SYSTEM_PROMPT),
+      optimization_goal_(OptimizationGoal::BALANCED),
+      select_examples_by_similarity_(true),
+      max_few_shot_examples_(3),
+      schema_cache_(std::make_shared<SchemaRenderCache>()),
+      max_prompt_tokens_(0),
+      schema_format_(SchemaFormat::DETAILED) {
+    constraints_section_ = generateConstraints();
+}
+
+std::string PromptBuilder::buildRewritePrompt(
+    const std::string& original_sql,
+    const std::vector<TableSchema>& schemas,
+    bool use_few_shot) const {
+    std::string prompt;
+    buildRewritePromptInto(original_sql, schemas, use_few_shot, prompt);
+    return prompt;
+}
+
+void PromptBuilder::buildRewritePromptInto(
+    const std::string& original_sql,
+    const std::vector<TableSchema>& schemas,
+    bool use_few_shot,
+    std::string& out,
+    PromptPrefix* prefix,
+    PromptTrimReport* trim) const {
+    // 片段数组按线程复用，稳态下只有输出字符串的一次分配
+    const RewriteTemplate& rewrite = rewriteTemplate();
+    thread_local std::vector<PromptFragments> fragments;
+    thread_local std::vector<size_t> example_ids;
+    thread_local std::vector<SchemaSelection> selections;
+    thread_local std::vector<TableSchema> pruned;   // 只有列被裁剪的表才生成副本
+    thread_local std::vector<TableSchema> working;  // 超出预算时删减用的副本
+    thread_local std::vector<char> trimmed;         // working中被删减过的表
+    thread_local std::vector<const TableSchema*> effective;
+    fragments.resize(rewrite.fragments);
+    for (auto& fragment : fragments) {
+        fragment.clear();
+    }
+    auto slot = [&rewrite](RewriteSlot id) -> PromptFragments& {
+        return fragments[rewrite.slot[id]];
+    };
+
+    effective.clear();
+    if (pruning_.enabled) {
+        pruneSchemas(original_sql, schemas, pruning_, selections);
+        size_t copies = 0;
+        for (const auto& selection : selections) {
+            copies += selection.all_columns ? 0 : 1;
+        }
+        // 先定好大小，之后取地址不会失效
+        if (pruned.size() < copies) {
+            pruned.resize(copies);
+        }
+        size_t next = 0;
+        for (const auto& selection : selections) {
+            const TableSchema& source = schemas[selection.table];
+            if (selection.all_columns) {
+                effective.push_back(&source);
+            } else {
+                materializeSelection(source, selection, pruned[next]);
+                effective.push_back(&pruned[next++]);
+            }
+        }
+    } else {
+        for (const auto& schema : schemas) {
+            effective.push_back(&schema);
+        }
+    }
+    example_ids.clear();
+    if (use_few_shot) {
+        selectFewShotExamples(original_sql, example_ids);
+    }
+    // 不按相似度选取时示例对所有查询相同，归入静态前缀
+    PromptFragments& example_slot = select_examples_by_similarity_
+        ? slot(SLOT_EXAMPLES) : slot(SLOT_STABLE_EXAMPLES);
+
+    slot(SLOT_SYSTEM_PROMPT).add(system_prompt_);
+    formatSchemas(effective, slot(SLOT_SCHEMAS));
+    slot(SLOT_HINTS).add(hints_section_);
+    appendFewShotExamples(example_ids, example_slot);
+    slot(SLOT_QUERY).add(original_sql);
+    slot(SLOT_CONSTRAINTS).add(constraints_section_);
+
+    const PromptTemplate& compiled = rewrite.compiled;
+    PromptTrimReport report;
+    if (max_prompt_tokens_ > 0) {
+        size_t total = compiled.staticSize();
+        for (size_t i = 0; i < compiled.slotCount(); ++i) {
+            total += fragments[i].bytes();
+        }
+        const size_t limit = max_prompt_tokens_ * kBytesPerToken;
+        if (total > limit) {
+            working.resize(effective.size());
+            for (size_t i = 0; i < effective.size(); ++i) {
+                working[i] = *effective[i];
+            }
+            trimToBudget(total, limit, example_ids, working, trimmed, report);
+            effective.clear();
+            for (const auto& schema : working) {
+                effective.push_back(&schema);
+            }
+            slot(SLOT_SCHEMAS).clear();
+            formatSchemas(effective, slot(SLOT_SCHEMAS), &trimmed);
+            example_slot.clear();
+            appendFewShotExamples(example_ids, example_slot);
+        }
+    }
+
+    compiled.renderTo(fragments.data(), out);
+
+    if (prefix) {
+        const std::string_view text(out);
+        prefix->static_length =
+            compiled.renderedOffset(fragments.data(), rewrite.slot[SLOT_SCHEMAS]);
+        prefix->context_length =
+            compiled.renderedOffset(fragments.data(), rewrite.slot[SLOT_EXAMPLES]);
+        prefix->static_hash = hashBytes(text.substr(0, prefix->static_length));
+        prefix->context_hash = hashBytes(text.substr(0, prefix->context_length));
+    }
+    if (trim) {
+        report.estimated_tokens = BudgetGovernor::estimateTokens(out);
+        report.within_budget = max_prompt_tokens_ == 0 ||
+                               report.estimated_tokens <= max_prompt_tokens_;
+        *trim = report;
+    }
+}
+
+void PromptBuilder::addFewShotExample(const FewShotExample& example) {
+    few_shot_examples_.push_back(example);
+    example_fragments_.push_back(formatFewShotExample(example));
+    example_index_.add(example.original_sql);
+}
+
+void PromptBuilder::setFewShotExamples(const std::vector<FewShotExample>& examples) {
+    few_shot_examples_.clear();
+    example_fragments_.clear();
+    example_index_.clear();
+    for (const auto& example : examples) {
+        addFewShotExample(example);
+    }
+}
+
+void PromptBuilder::setFewShotSelection(bool by_similarity, size_t max_examples) {
+    select_examples_by_similarity_ = by_similarity;
+    max_few_shot_examples_ = std::min(max_examples, kMaxExamplesPerPrompt);
+}
+
+void PromptBuilder::setSystemPrompt(const std::string& prompt) {
+    system_prompt_ = prompt;
+}
+
+void PromptBuilder::setOptimizationGoal(OptimizationGoal goal) {
+    optimization_goal_ = goal;
+    constraints_section_ = generateConstraints();
+}
+
+void PromptBuilder::enableOptimizationHints(const std::vector<std::string>& hints) {
+    optimization_hints_ = hints;
+    hints_section_ = formatOptimizationHints();
+}
+
+void PromptBuilder::setSchemaCache(std::shared_ptr<SchemaRenderCache> cache) {
+    schema_cache_ = cache ? std::move(cache) : std::make_shared<SchemaRenderCache>();
+}
+
+std::shared_ptr<SchemaRenderCache> PromptBuilder::getSchemaCache() const {
+    return schema_cache_;
+}
+
+void PromptBuilder::setSchemaPruning(const SchemaPruningOptions& options) {
+    pruning_ = options;
+}
+
+void PromptBuilder::setPromptTokenBudget(size_t max_prompt_tokens) {
+    max_prompt_tokens_ = max_prompt_tokens;
+}
+
+void PromptBuilder::setSchemaFormat(SchemaFormat format) {
+    schema_format_ = format;
+}
+
+void PromptBuilder::formatSchemas(const std::vector<const TableSchema*>& schemas,
+                                  PromptFragments& out,
+                                  const std::vector<char>* trimmed) const {
+    // 持有片段直到下一次构建，保证渲染期间视图有效
+    thread_local std::vector<std::shared_ptr<const std::string>> fragments;
+    thread_local std::vector<size_t> ordered;
+    fragments.clear();
+    if (schemas.empty()) {
+        return;
+    }
+    // 按表名排序，调用方传入顺序不同也得到相同的前缀
+    ordered.resize(schemas.size());
+    for (size_t i = 0; i < schemas.size(); ++i) {
+        ordered[i] = i;
+    }
+    std::sort(ordered.begin(), ordered.end(),
+              [&schemas](size_t a, size_t b) {
+                  return schemas[a]->table_name < schemas[b]->table_name;
+              });
+    const bool compact = schema_format_ == SchemaFormat::COMPACT;
+    out.add(compact ? kCompactSchemaHeader : "## Database Schema\n\n");
+    for (size_t i : ordered) {
+        // 按预算删减后的表只用于本次构建，不进入共享缓存
+        if (trimmed && (*trimmed)[i]) {
+            fragments.push_back(std::make_shared<const std::string>(
+                renderTableSchema(*schemas[i], schema_format_)));
+        } else {
+            fragments.push_back(schema_cache_->get(*schemas[i], schema_format_));
+        }
+        out.add(*fragments.back());
+    }
+    if (compact) {
+        out.add("\n");
+    }
+}
+
+std::string PromptBuilder::formatOptimizationHints() const {
+    std::string section;
+    for (const auto& hint : optimization_hints_) {
+        for (const auto& technique : kTechniques) {
+            if (hint == technique.name) {
+                section += "- **";
+                section += technique.name;
+                section += "**: ";
+                section += technique.description;
+                section += '\n';
+                break;
+            }
+        }
+    }
+    if (section.empty()) {
+        return section;
+    }
+    return "## Optimization Techniques to Consider\n\n" + section + "\n";
+}
+
+// 示例片段不含序号，序号在选取后按位置补上
+std::string PromptBuilder::formatFewShotExample(const FewShotExample& example) const {
+    char header[48];
+    std::snprintf(header, sizeof(header), " (Speedup: %.1fx)\n\n", example.speedup_ratio);
+    std::string fragment = header;
+    fragment += "**Original:**\n```sql\n";
+    fragment += example.original_sql;
+    fragment += "\n```\n\n**Optimized:**\n```sql\n";
+    fragment += example.optimized_sql;
+    fragment += "\n```\n";
+    if (!example.explanation.empty()) {
+        fragment += "\n*";
+        fragment += example.explanation;
+        fragment += "*\n";
+    }
+    fragment += '\n';
+    return fragment;
+}
+
+void PromptBuilder::selectFewShotExamples(const std::string& original_sql,
+                                          std::vector<size_t>& ids) const {
+    if (few_shot_examples_.empty() || max_few_shot_examples_ == 0) {
+        return;
+    }
+    if (!select_examples_by_similarity_) {
+        for (size_t i = 0; i < few_shot_examples_.size() && i < max_few_shot_examples_; ++i) {
+            ids.push_back(i);
+        }
+        return;
+    }
+    ids = example_index_.nearest(original_sql, max_few_shot_examples_);
+}
+
+void PromptBuilder::appendFewShotExamples(const std::vector<size_t>& ids,
+                                          PromptFragments& out) const {
+    if (ids.empty()) {
+        return;
+    }
+    out.add(kExamplesHeader);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        out.add(kExampleTitle);
+        out.add(kOrdinals[i]);
+        out.add(example_fragments_[ids[i]]);
+    }
+}
+
+void PromptBuilder::trimToBudget(size_t total_bytes, size_t limit_bytes,
+                                 std::vector<size_t>& example_ids,
+                                 std::vector<TableSchema>& schemas,
+                                 std::vector<char>& trimmed,
+                                 PromptTrimReport& report) const {
+    // 候选按层级排列：示例 < 非键列 < create_statement。
+    // 后一层在前一层全部用完后才会用到，因此删去create_statement时
+    // 各表已只含键列，节省量按这一状态计算
+    enum TrimKind { DROP_EXAMPLE, DROP_NON_KEY_COLUMNS, DROP_CREATE_STATEMENT };
+    struct Candidate {
+        TrimKind kind;
+        size_t target;
+        size_t saving;
+    };
+    thread_local std::vector<Candidate> candidates;
+    thread_local TableSchema reduced;
+    candidates.clear();
+
+    // 示例：相似度选取时越靠后越不相似；否则加速比越低价值越低
+    const size_t example_start = candidates.size();
+    for (size_t i = 0; i < example_ids.size(); ++i) {
+        const size_t saving = std::strlen(kExampleTitle) + std::strlen(kOrdinals[i]) +
+                              example_fragments_[example_ids[i]].size();
+        candidates.push_back({DROP_EXAMPLE, i, saving});
+    }
+    if (select_examples_by_similarity_) {
+        std::reverse(candidates.begin() + example_start, candidates.end());
+    } else {
+        std::stable_sort(candidates.begin() + example_start, candidates.end(),
+                         [&](const Candidate& a, const Candidate& b) {
+                             return few_shot_examples_[example_ids[a.target]].speedup_ratio <
+                                    few_shot_examples_[example_ids[b.target]].speedup_ratio;
+                         });
+    }
+
+    // Schema：节省量取自删减前后渲染结果的长度差；删减后的变体只在此处渲染，
+    // 不写入共享缓存
+    const size_t schema_start = candidates.size();
+    for (size_t i = 0; i < schemas.size(); ++i) {
+        const size_t full = schema_cache_->get(schemas[i], schema_format_)->size();
+        reduceSchema(schemas[i], true, false, reduced);
+        const size_t keys = renderTableSchema(reduced, schema_format_).size();
+        reduceSchema(schemas[i], true, true, reduced);
+        const size_t bare = renderTableSchema(reduced, schema_format_).size();
+        if (keys < full) {
+            candidates.push_back({DROP_NON_KEY_COLUMNS, i, full - keys});
+        }
+        if (bare < keys) {
+            candidates.push_back({DROP_CREATE_STATEMENT, i, keys - bare});
+        }
+    }
+    std::stable_sort(candidates.begin() + schema_start, candidates.end(),
+                     [](const Candidate& a, const Candidate& b) {
+                         return a.kind != b.kind ? a.kind < b.kind : a.saving > b.saving;
+                     });
+
+    // 一次遍历：按层级累加节省量，满足预算即停止
+    thread_local std::vector<char> dropped;
+    thread_local std::vector<char> key_columns_only;
+    thread_local std::vector<char> without_create_statement;
+    dropped.assign(example_ids.size(), 0);
+    key_columns_only.assign(schemas.size(), 0);
+    without_create_statement.assign(schemas.size(), 0);
+    size_t total = total_bytes;
+    for (const auto& candidate : candidates) {
+        if (total <= limit_bytes) {
+            break;
+        }
+        total -= std::min(total, candidate.saving);
+        switch (candidate.kind) {
+            case DROP_EXAMPLE:
+                dropped[candidate.target] = 1;
+                ++report.examples_dropped;
+                break;
+            case DROP_NON_KEY_COLUMNS:
+                key_columns_only[candidate.target] = 1;
+                ++report.tables_trimmed;
+                break;
+            case DROP_CREATE_STATEMENT:
+                key_columns_only[candidate.target] = 1;
+                without_create_statement[candidate.target] = 1;
+                ++report.create_statements_dropped;
+                break;
+        }
+    }
+
+    trimmed.assign(schemas.size(), 0);
+    for (size_t i = 0; i < schemas.size(); ++i) {
+        if (key_columns_only[i]) {
+            reduceSchema(schemas[i], true, without_create_statement[i], reduced);
+            std::swap(schemas[i], reduced);
+            trimmed[i] = 1;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < example_ids.size(); ++i) {
+        if (!dropped[i]) {
+            example_ids[kept++] = example_ids[i];
+        }
+    }
+    example_ids.resize(kept);
+}
+
+std::string PromptBuilder::generateConstraints() const {
+    std::string constraints =
+        "## Requirements\n\n"
+        "1. Output ONLY the optimized SQL query inside a ```sql code block\n"
+        "2. Ensure 100% semantic equivalence\n"
+        "3. Focus on measurable performance improvements\n"
+        "4. If no optimization is possible, return the original query\n";
+    switch (optimization_goal_) {
+        case OptimizationGoal::PERFORMANCE:
+            constraints += "5. Prefer the fastest plan even if the query becomes longer\n";
+            break;
+        case OptimizationGoal::READABILITY:
+            constraints += "5. Keep the rewrite readable; avoid restructuring that gains little\n";
+            break;
+        case OptimizationGoal::BALANCED:
+            break;
+    }
+    constraints += "\n## Safety Constraints\n\n";
+    constraints += prompts::SAFETY_CONSTRAINTS;
+    return constraints;
+}
+
+} // namespace llm
+} // namespace heimdall
@@ -6,6 +6,12 @@
 #ifndef HEIMDALL_PROMPT_BUILDER_H
 #define HEIMDALL_PROMPT_BUILDER_H
 
+#include "example_index.h"
+#include "prompt_template.h"
+#include "schema_cache.h"
+#include "schema_pruner.h"
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -13,15 +19,32 @@
 namespace heimdall {
 namespace llm {
 
+/**
+ * @brief 索引定义
+ */
+struct IndexDefinition {
+    std::string name;
+    std::vector<std::string> columns;
+    bool unique = false;
+};
+
 /**
  * @brief Schema信息
+ *
+ * row_count/column_ndv/indexes来自本地目录快照(CatalogSnapshot)，
+ * 未填充时Prompt中不出现统计信息
  */
 struct TableSchema {
     std::string table_name;
     std::vector<std::string> columns;
     std::vector<std::string> primary_keys;
-    std::vector<std::string> foreign_keys;
+    std::vector<std::string> foreign_keys;    // 形如"ss_item_sk -> item(i_item_sk)"
     std::string create_statement;
+    uint64_t schema_version = 0;  // 表结构版本，DDL后递增
+    uint64_t row_count = 0;       // 估计行数，0表示未知
+    std::unordered_map<std::string, uint64_t> column_ndv;  // 列名 -> 不同值个数
+    std::vector<IndexDefinition> indexes;
+    uint64_t stats_version = 0;   // 统计信息版本，ANALYZE后递增
 };
 
 /**
@@ -34,8 +57,47 @@ struct FewShotExample {
     double speedup_ratio;
 };
 
+/**
+ * @brief 重写Prompt的稳定前缀
+ *
+ * 提供商/本地服务对逐字节相同的Prompt前缀复用KV缓存，
+ * 哈希可用于把同前缀的请求路由到同一实例或统计前缀命中
+ */
+struct PromptPrefix {
+    size_t static_length;    // 系统提示词、约束、技术提示与固定示例，设置不变时恒定
+    uint64_t static_hash;
+    size_t context_length;   // 再加上按表名排序的Schema，引用相同表的查询共享
+    uint64_t context_hash;
+};
+
+/**
+ * @brief Prompt超出token预算时的裁剪结果
+ */
+struct PromptTrimReport {
+    size_t estimated_tokens;          // 裁剪后的估计token数
+    size_t examples_dropped;          // 去掉的Few-shot示例数
+    size_t tables_trimmed;            // 去掉非键列的表数
+    size_t create_statements_dropped; // 改用列清单代替create_statement的表数
+    bool within_budget;               // 裁剪后是否满足预算
+
+    PromptTrimReport()
+        : estimated_tokens(0), examples_dropped(0), tables_trimmed(0),
+          create_statements_dropped(0), within_budget(true) {}
+};
+
 /**
  * @brief Prompt构建器
+ *
+ * Prompt按稳定程度从高到低排列，待优化SQL放在最后：
+ * 系统提示词 → 约束 → 优化技术提示 → 固定示例 → Schema(按表名排序)
+ * → 按相似度选取的示例 → 待优化SQL。
+ *
+ * 重写Prompt由进程内只编译一次的PromptTemplate渲染。系统提示词、
+ * 优化技术提示、Few-shot示例和约束只随设置变化，在设置时预先渲染好；
+ * 每次构建只为Schema和SQL收集片段视图，然后一次reserve、一次追加完成。
+ *
+ * const方法可并发调用；修改方法不可与任何其他调用并发。运行期需要修改时
+ * 通过PromptSnapshotPublisher发布不可变快照。
  */
 class PromptBuilder {
 public:
@@ -49,11 +111,35 @@ public:
         const std::vector<TableSchema>& schemas,
         bool use_few_shot = true) const;
 
+    /**
+     * @brief 渲染到out，复用调用方缓冲的容量
+     */
+    void buildRewritePromptInto(
+        const std::string& original_sql,
+        const std::vector<TableSchema>& schemas,
+        bool use_few_shot,
+        std::string& out,
+        PromptPrefix* prefix = nullptr,
+        PromptTrimReport* trim = nullptr) const;
+
     /**
      * @brief 添加Few-shot示例
      */
     void addFewShotExample(const FewShotExample& example);
 
+    /**
+     * @brief 用给定示例替换全部Few-shot示例（如从ExampleStore重新加载）
+     */
+    void setFewShotExamples(const std::vector<FewShotExample>& examples);
+
+    /**
+     * @brief 设置Few-shot示例的选取方式
+     * @param by_similarity true时按MinHash相似度选取与当前查询最相近的示例，
+     *                      false时取最先加入的示例
+     * @param max_examples 每个Prompt最多包含的示例数
+     */
+    void setFewShotSelection(bool by_similarity, size_t max_examples = 3);
+
     /**
      * @brief 设置系统提示词
      */
@@ -74,15 +160,75 @@ public:
      */
     void enableOptimizationHints(const std::vector<std::string>& hints);
 
+    /**
+     * @brief 设置Schema片段缓存
+     *
+     * 默认每个构建器持有独立缓存；多个构建器共享同一缓存时，
+     * DDL只需失效一次
+     */
+    void setSchemaCache(std::shared_ptr<SchemaRenderCache> cache);
+    std::shared_ptr<SchemaRenderCache> getSchemaCache() const;
+
+    /**
+     * @brief 设置Schema裁剪
+     *
+     * 开启后Prompt只包含查询引用到的表（及可选的外键邻接表），
+     * 且只包含引用到的列与主外键列，详见pruneSchemas()
+     */
+    void setSchemaPruning(const SchemaPruningOptions& options);
+
+    /**
+     * @brief 设置Prompt的token预算，0表示不限制
+     *
+     * 超出预算时按价值从低到高裁剪，直到满足预算：
+     * 1. Few-shot示例（相似度最低的，或按加入顺序选取时加速比最低的）
+     * 2. 各表的非键列（保留主外键列与create_statement，先裁节省最多的表；
+     *    只有create_statement的表改写为只含键列的DDL）
+     * 3. create_statement（改用剩余的列清单）
+     * 每层只删减它所指的部分。裁剪计划只需一次遍历候选列表，最后只渲染一次；
+     * 删减后的Schema直接渲染，不写入共享的SchemaRenderCache。
+     * 系统提示词、约束与待优化SQL从不裁剪，因此预算过小时仍可能超出。
+     */
+    void setPromptTokenBudget(size_t max_prompt_tokens);
+
+    /**
+     * @brief 设置Schema表示形式，COMPACT每表一行，token数约为DETAILED的1/3~1/5
+     */
+    void setSchemaFormat(SchemaFormat format);
+
 private:
     std::string system_prompt_;
     std::vector<FewShotExample> few_shot_examples_;
     OptimizationGoal optimization_goal_;
     std::vector<std::string> optimization_hints_;
 
+    // 预渲染的静态段，设置变化时重建
+    std::string hints_section_;
+    std::string constraints_section_;
+    std::vector<std::string> example_fragments_;  // 与few_shot_examples_一一对应
+    ExampleIndex example_index_;
+    bool select_examples_by_similarity_;
+    size_t max_few_shot_examples_;
+    std::shared_ptr<SchemaRenderCache> schema_cache_;
+    SchemaPruningOptions pruning_;
+    size_t max_prompt_tokens_;
+    SchemaFormat schema_format_;
+
     // 辅助函数
-    std::string formatSchemas(const std::vector<TableSchema>& schemas) const;
-    std::string formatFewShotExamples() const;
+    void formatSchemas(const std::vector<const TableSchema*>& schemas,
+                       PromptFragments& out,
+                       const std::vector<char>* trimmed = nullptr) const;
+    std::string formatOptimizationHints() const;
+    std::string formatFewShotExample(const FewShotExample& example) const;
+    void selectFewShotExamples(const std::string& original_sql,
+                               std::vector<size_t>& ids) const;
+    void appendFewShotExamples(const std::vector<size_t>& ids,
+                               PromptFragments& out) const;
+    void trimToBudget(size_t total_bytes, size_t limit_bytes,
+                      std::vector<size_t>& example_ids,
+                      std::vector<TableSchema>& schemas,
+                      std::vector<char>& trimmed,
+                      PromptTrimReport& report) const;
     std::string generateConstraints() const;
 };
 
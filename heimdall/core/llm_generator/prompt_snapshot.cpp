@@ -0,0 +1,39 @@
+/**
+ * @file prompt_snapshot.cpp
+ * @brief Prompt快照发布实现
+ */
+
+#include "prompt_snapshot.h"
+
+namespace heimdall {
+namespace llm {
+
+PromptSnapshotPublisher::PromptSnapshotPublisher(const PromptBuilder& initial)
+    : snapshot_(std::make_shared<const PromptBuilder>(initial)),
+      version_(1) {}
+
+PromptSnapshot PromptSnapshotPublisher::current() const {
+    return std::atomic_load(&snapshot_);
+}
+
+uint64_t PromptSnapshotPublisher::update(
+    const std::function<void(PromptBuilder&)>& mutate) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    auto next = std::make_shared<PromptBuilder>(*std::atomic_load(&snapshot_));
+    mutate(*next);
+    std::atomic_store(&snapshot_, PromptSnapshot(std::move(next)));
+    return ++version_;
+}
+
+uint64_t PromptSnapshotPublisher::publish(const PromptBuilder& builder) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    std::atomic_store(&snapshot_, PromptSnapshot(std::make_shared<const PromptBuilder>(builder)));
+    return ++version_;
+}
+
+uint64_t PromptSnapshotPublisher::version() const {
+    return version_.load();
+}
+
+} // namespace llm
+} // namespace heimdall
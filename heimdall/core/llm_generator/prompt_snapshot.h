@@ -0,0 +1,71 @@
+/**
+ * @file prompt_snapshot.h
+ * @brief 不可变PromptBuilder快照的发布
+ */
+
+#ifndef HEIMDALL_PROMPT_SNAPSHOT_H
+#define HEIMDALL_PROMPT_SNAPSHOT_H
+
+#include "prompt_builder.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 冻结后的Prompt配置，只能调用const方法
+ *
+ * PromptBuilder的const方法（buildRewritePrompt等）只读取成员，临时数据在
+ * 线程局部缓冲中，Schema片段缓存自带锁，因此同一快照可被任意多个线程同时使用。
+ */
+using PromptSnapshot = std::shared_ptr<const PromptBuilder>;
+
+/**
+ * @brief 快照发布器
+ *
+ * 读者通过current()取得当前快照并在整个构建过程中持有它，之后发布的
+ * 新快照不影响正在进行的构建。写者通过update()在当前快照的副本上修改，
+ * 修改完成后以原子替换发布；写者之间由writer_mutex_串行化，读者不取该锁，
+ * 不会被正在复制、修改构建器的写者阻塞。
+ *
+ * 注意std::atomic_load/atomic_store(shared_ptr)并非无锁：libstdc++用按地址
+ * 散列的自旋锁池实现，读写双方都只在复制或替换指针、调整引用计数的瞬间持锁。
+ * current()每次构建Prompt只调用一次，这一开销与构建本身相比可以忽略。
+ * 所有连接线程共享同一份Few-shot示例库，不再各自复制。
+ */
+class PromptSnapshotPublisher {
+public:
+    explicit PromptSnapshotPublisher(const PromptBuilder& initial = PromptBuilder());
+
+    /**
+     * @brief 当前快照
+     */
+    PromptSnapshot current() const;
+
+    /**
+     * @brief 在当前快照的副本上执行mutate并发布结果
+     * @return 新快照的版本号
+     */
+    uint64_t update(const std::function<void(PromptBuilder&)>& mutate);
+
+    /**
+     * @brief 直接发布一个新的构建器
+     */
+    uint64_t publish(const PromptBuilder& builder);
+
+    uint64_t version() const;
+
+private:
+    PromptSnapshot snapshot_;             // 只通过std::atomic_load/atomic_store访问
+    std::mutex writer_mutex_;
+    std::atomic<uint64_t> version_;
+};
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
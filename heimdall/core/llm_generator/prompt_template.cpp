@@ -0,0 +1,88 @@
+/**
+ * @file prompt_template.cpp
+ * @brief 预编译Prompt模板实现
+ */
+
+#include "prompt_template.h"
+
+namespace heimdall {
+namespace llm {
+
+PromptTemplate::PromptTemplate(std::string_view source) : static_size_(0) {
+    text_.reserve(source.size());
+    size_t pos = 0;
+    while (pos < source.size()) {
+        const size_t open = source.find("{{", pos);
+        const size_t close = open == std::string_view::npos
+            ? std::string_view::npos : source.find("}}", open + 2);
+        const size_t literal_end = close == std::string_view::npos ? source.size() : open;
+
+        if (literal_end > pos) {
+            segments_.push_back({text_.size(), literal_end - pos, npos});
+            text_.append(source.data() + pos, literal_end - pos);
+        }
+        if (close == std::string_view::npos) {
+            break;
+        }
+
+        const std::string_view name = source.substr(open + 2, close - open - 2);
+        size_t slot = slotIndex(name);
+        if (slot == npos) {
+            slot = slot_names_.size();
+            slot_names_.emplace_back(name);
+        }
+        segments_.push_back({0, 0, slot});
+        pos = close + 2;
+    }
+    static_size_ = text_.size();
+}
+
+size_t PromptTemplate::slotIndex(std::string_view name) const {
+    for (size_t i = 0; i < slot_names_.size(); ++i) {
+        if (slot_names_[i] == name) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+void PromptTemplate::renderTo(const PromptFragments* slots, std::string& out) const {
+    size_t total = static_size_;
+    for (const auto& segment : segments_) {
+        if (segment.slot != npos) {
+            total += slots[segment.slot].bytes();
+        }
+    }
+
+    out.clear();
+    out.reserve(total);
+    for (const auto& segment : segments_) {
+        if (segment.slot == npos) {
+            out.append(text_, segment.offset, segment.length);
+            continue;
+        }
+        for (std::string_view piece : slots[segment.slot].pieces()) {
+            out.append(piece.data(), piece.size());
+        }
+    }
+}
+
+std::string PromptTemplate::render(const PromptFragments* slots) const {
+    std::string out;
+    renderTo(slots, out);
+    return out;
+}
+
+size_t PromptTemplate::renderedOffset(const PromptFragments* slots, size_t slot) const {
+    size_t offset = 0;
+    for (const auto& segment : segments_) {
+        if (segment.slot == slot) {
+            return offset;
+        }
+        offset += segment.slot == npos ? segment.length : slots[segment.slot].bytes();
+    }
+    return offset;
+}
+
+} // namespace llm
+} // namespace heimdall
@@ -0,0 +1,99 @@
+/**
+ * @file prompt_template.h
+ * @brief 预编译的Prompt模板
+ */
+
+#ifndef HEIMDALL_PROMPT_TEMPLATE_H
+#define HEIMDALL_PROMPT_TEMPLATE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 一个槽位的内容：按顺序拼接的若干文本片段
+ *
+ * 只保存视图，不复制文本；片段指向的内存须在渲染结束前保持有效。
+ * clear()保留容量，线程局部复用时稳态下不再分配内存。
+ */
+class PromptFragments {
+public:
+    void clear() {
+        pieces_.clear();
+        bytes_ = 0;
+    }
+
+    void add(std::string_view piece) {
+        if (!piece.empty()) {
+            pieces_.push_back(piece);
+            bytes_ += piece.size();
+        }
+    }
+
+    size_t bytes() const { return bytes_; }
+    const std::vector<std::string_view>& pieces() const { return pieces_; }
+
+private:
+    std::vector<std::string_view> pieces_;
+    size_t bytes_ = 0;
+};
+
+/**
+ * @brief 编译后的Prompt模板
+ *
+ * 模板文本中的"{{name}}"为槽位，其余为静态文本。构造时一次性切分为
+ * 静态段与槽位段的列表并计算静态部分总长度；渲染时先求出总长度，
+ * 只做一次reserve，再按段顺序追加，不产生中间字符串。
+ */
+class PromptTemplate {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit PromptTemplate(std::string_view source);
+
+    size_t slotCount() const { return slot_names_.size(); }
+
+    /**
+     * @brief 槽位名对应的下标，不存在时返回npos
+     */
+    size_t slotIndex(std::string_view name) const;
+
+    /**
+     * @brief 静态文本总字节数
+     */
+    size_t staticSize() const { return static_size_; }
+
+    /**
+     * @brief 渲染到out（覆盖原内容，复用out已有容量）
+     * @param slots 长度为slotCount()的数组，按slotIndex()下标排列
+     */
+    void renderTo(const PromptFragments* slots, std::string& out) const;
+
+    std::string render(const PromptFragments* slots) const;
+
+    /**
+     * @brief 槽位首次出现处在渲染结果中的字节偏移，不渲染
+     */
+    size_t renderedOffset(const PromptFragments* slots, size_t slot) const;
+
+private:
+    struct Segment {
+        size_t offset;  // 静态段：在text_中的起始位置
+        size_t length;  // 静态段长度
+        size_t slot;    // 槽位下标，静态段为npos
+    };
+
+    std::string text_;                      // 所有静态段拼接后的文本
+    std::vector<Segment> segments_;
+    std::vector<std::string> slot_names_;
+    size_t static_size_;
+};
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
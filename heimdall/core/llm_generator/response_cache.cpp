@@ -0,0 +1,319 @@
+/**
+ * @file response_cache.cpp
+ * @brief LLM响应缓存实现
+ */
+
+#include "response_cache.h"
+#include <functional>
+#include <utility>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+// 保留用于训练字典的最近样本数
+constexpr size_t kMaxSamples = 128;
+
+// 未压缩响应占用的字节数（与序列化长度同量级，避免仅为计数而序列化）
+// 共享响应实际占用的内存：响应对象、候选视图数组与后备缓冲
+size_t responseBytes(const LLMResponse& response) {
+    size_t bytes = sizeof(LLMResponse) +
+                   response.candidates.capacity() * sizeof(std::string_view);
+    if (response.buffer) {
+        bytes += response.buffer->footprint();
+    }
+    return bytes;
+}
+
+} // namespace
+
+ResponseCache::ResponseCache(size_t max_entries)
+    : ResponseCache([max_entries] {
+          ResponseCacheOptions options;
+          options.max_entries = max_entries;
+          return options;
+      }()) {}
+
+ResponseCache::ResponseCache(const ResponseCacheOptions& options)
+    : options_(options),
+      puts_since_training_(0),
+      sketch_(options.max_entries),
+      stats_{} {}
+
+LLMResponsePtr ResponseCache::get(const std::string& key) {
+    const uint64_t hash = std::hash<std::string>()(key);
+    std::lock_guard<std::mutex> lock(mutex_);
+    sketch_.increment(hash);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++stats_.misses;
+        return nullptr;
+    }
+    auto& list = listOf(*it->second);
+    list.splice(list.begin(), list, it->second);
+    LLMResponsePtr response = decodeLocked(*it->second);
+    if (!response) {
+        // 数据损坏：按未命中处理并丢弃该条目
+        removeLocked(it->second);
+        ++stats_.misses;
+        return nullptr;
+    }
+    ++stats_.hits;
+    return response;
+}
+
+void ResponseCache::put(const std::string& key, LLMResponsePtr response) {
+    if (!response) {
+        return;
+    }
+
+    std::shared_ptr<const CompressionDictionary> dictionary;
+    bool compress = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (options_.max_entries == 0) {
+            return;
+        }
+        compress = options_.compress;
+        dictionary = dictionary_;
+    }
+
+    // 序列化与压缩在锁外完成
+    Entry entry;
+    entry.key = key;
+    entry.hash = std::hash<std::string>()(key);
+    std::string serialized;
+    if (compress) {
+        serialized = serializeResponse(*response);
+        if (dictionary) {
+            entry.raw_size = serialized.size();
+            entry.compressed = dictionary->compress(serialized);
+            entry.dictionary = std::move(dictionary);
+            entry.decoded = response;
+        } else {
+            entry.response = response;
+        }
+    } else {
+        entry.response = response;
+    }
+    // 持有共享响应时按其实际内存计费，而不是文本长度
+    if (entry.response) {
+        entry.raw_size = responseBytes(*response);
+    }
+    entry.charge = key.size() +
+        (entry.dictionary ? entry.compressed.size() : entry.raw_size);
+
+    bool retrain = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 已在主区的键原地更新；新键进入准入窗口
+        auto it = index_.find(key);
+        bool in_window = options_.admission;
+        if (it != index_.end()) {
+            in_window = it->second->in_window;
+            removeLocked(it->second);
+        }
+        entry.in_window = in_window;
+        stats_.stored_bytes += entry.charge;
+        stats_.uncompressed_bytes += entry.raw_size;
+        auto& list = in_window ? window_ : main_;
+        list.push_front(std::move(entry));
+        index_.emplace(key, list.begin());
+
+        if (compress) {
+            stats_.sample_bytes += serialized.size();
+            samples_.push_back(std::move(serialized));
+            // 样本最多占内存预算的一半，其余留给条目
+            while (!samples_.empty() &&
+                   (samples_.size() > kMaxSamples ||
+                    (options_.max_bytes > 0 &&
+                     stats_.sample_bytes > options_.max_bytes / 2))) {
+                stats_.sample_bytes -= samples_.front().size();
+                samples_.pop_front();
+            }
+            retrain = ++puts_since_training_ >= options_.retrain_interval;
+        }
+        evictLocked();
+    }
+    if (retrain) {
+        retrainDictionary();
+    }
+}
+
+void ResponseCache::retrainDictionary() {
+    std::vector<std::string> samples;
+    size_t max_dictionary_entries;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        samples.assign(samples_.begin(), samples_.end());
+        max_dictionary_entries = options_.max_dictionary_entries;
+        puts_since_training_ = 0;
+    }
+    if (samples.empty()) {
+        return;
+    }
+
+    std::vector<std::string_view> views(samples.begin(), samples.end());
+    auto dictionary = CompressionDictionary::train(views, max_dictionary_entries);
+
+    // 已压缩的条目继续引用旧字典；仍未压缩的条目用新字典补压缩
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        dictionary_ = dictionary;
+    }
+    compressPending(dictionary);
+}
+
+void ResponseCache::compressPending(
+    const std::shared_ptr<const CompressionDictionary>& dictionary) {
+    std::vector<std::pair<std::string, LLMResponsePtr>> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!options_.compress) {
+            return;
+        }
+        for (const auto* list : {&window_, &main_}) {
+            for (const Entry& entry : *list) {
+                if (entry.response) {
+                    pending.emplace_back(entry.key, entry.response);
+                }
+            }
+        }
+    }
+
+    // 编码在锁外完成；期间被替换或删除的条目不再更新
+    for (auto& item : pending) {
+        const std::string serialized = serializeResponse(*item.second);
+        std::string compressed = dictionary->compress(serialized);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(item.first);
+        if (it == index_.end() || it->second->response != item.second) {
+            continue;
+        }
+        Entry& entry = *it->second;
+        stats_.stored_bytes -= entry.charge;
+        stats_.uncompressed_bytes -= entry.raw_size;
+        entry.decoded = entry.response;
+        entry.response.reset();
+        entry.compressed = std::move(compressed);
+        entry.dictionary = dictionary;
+        entry.raw_size = serialized.size();
+        entry.charge = entry.key.size() + entry.compressed.size();
+        stats_.stored_bytes += entry.charge;
+        stats_.uncompressed_bytes += entry.raw_size;
+    }
+}
+
+void ResponseCache::setCapacity(size_t max_entries) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_.max_entries = max_entries;
+    sketch_.resize(max_entries);
+    evictLocked();
+}
+
+void ResponseCache::setOptions(const ResponseCacheOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (options.max_entries != options_.max_entries) {
+        sketch_.resize(options.max_entries);
+    }
+    options_ = options;
+    if (!options_.compress) {
+        dictionary_.reset();
+        samples_.clear();
+        stats_.sample_bytes = 0;
+        puts_since_training_ = 0;
+    }
+    evictLocked();
+}
+
+size_t ResponseCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return window_.size() + main_.size();
+}
+
+void ResponseCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    window_.clear();
+    main_.clear();
+    index_.clear();
+    sketch_.clear();
+    stats_.stored_bytes = 0;
+    stats_.uncompressed_bytes = 0;
+}
+
+ResponseCache::Stats ResponseCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+LLMResponsePtr ResponseCache::decodeLocked(const Entry& entry) {
+    if (entry.response) {
+        return entry.response;
+    }
+    if (auto live = entry.decoded.lock()) {
+        return live;
+    }
+    std::string serialized;
+    if (!entry.dictionary || !entry.dictionary->decompress(entry.compressed, &serialized)) {
+        return nullptr;
+    }
+    LLMResponsePtr response = deserializeResponse(serialized);
+    entry.decoded = response;
+    return response;
+}
+
+std::list<ResponseCache::Entry>& ResponseCache::listOf(const Entry& entry) {
+    return entry.in_window ? window_ : main_;
+}
+
+bool ResponseCache::overLimitLocked() const {
+    return window_.size() + main_.size() > options_.max_entries ||
+           (options_.max_bytes > 0 &&
+            stats_.stored_bytes + stats_.sample_bytes > options_.max_bytes);
+}
+
+size_t ResponseCache::windowCapacityLocked() const {
+    if (!options_.admission) {
+        return 0;
+    }
+    const auto capacity = static_cast<size_t>(options_.max_entries * options_.window_fraction);
+    return capacity > 0 ? capacity : 1;
+}
+
+void ResponseCache::removeLocked(std::list<Entry>::iterator it) {
+    stats_.stored_bytes -= it->charge;
+    stats_.uncompressed_bytes -= it->raw_size;
+    index_.erase(it->key);
+    listOf(*it).erase(it);
+}
+
+void ResponseCache::evictLocked() {
+    // 窗口溢出：缓存已满时窗口尾部与主区尾部比较频率，胜者留在主区
+    const size_t window_capacity = windowCapacityLocked();
+    while (window_.size() > window_capacity) {
+        auto candidate = std::prev(window_.end());
+        if (overLimitLocked() && !main_.empty()) {
+            auto victim = std::prev(main_.end());
+            ++stats_.evictions;
+            if (sketch_.frequency(candidate->hash) <= sketch_.frequency(victim->hash)) {
+                ++stats_.admission_rejections;
+                removeLocked(candidate);
+                continue;
+            }
+            removeLocked(victim);
+        }
+        candidate->in_window = false;
+        main_.splice(main_.begin(), window_, candidate);
+    }
+
+    while (overLimitLocked() && !(window_.empty() && main_.empty())) {
+        auto& list = main_.empty() ? window_ : main_;
+        removeLocked(std::prev(list.end()));
+        ++stats_.evictions;
+    }
+}
+
+} // namespace llm
+} // namespace heimdall
@@ -0,0 +1,133 @@
+/**
+ * @file response_cache.h
+ * @brief LLM响应缓存
+ */
+
+#ifndef HEIMDALL_RESPONSE_CACHE_H
+#define HEIMDALL_RESPONSE_CACHE_H
+
+#include "llm_response.h"
+#include "cache_compression.h"
+#include "frequency_sketch.h"
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 响应缓存配置
+ */
+struct ResponseCacheOptions {
+    size_t max_entries;             // 最大条目数
+    size_t max_bytes;               // 内存预算(键+值字节数)，0表示只按条目数限制
+    bool compress;                  // 是否用共享字典压缩缓存值
+    size_t retrain_interval;        // 每写入N条重新训练一次字典
+    size_t max_dictionary_entries;  // 字典最大词数
+    bool admission;                 // 是否启用TinyLFU准入过滤
+    double window_fraction;         // 准入窗口占总容量的比例
+
+    ResponseCacheOptions()
+        : max_entries(1000),
+          max_bytes(0),
+          compress(false),
+          retrain_interval(256),
+          max_dictionary_entries(4096),
+          admission(true),
+          window_fraction(0.01) {}
+};
+
+/**
+ * @brief W-TinyLFU响应缓存
+ *
+ * 新条目先进入容量约1%的LRU窗口；窗口溢出的条目需要与主区LRU尾部的
+ * 淘汰候选比较访问频率（FrequencySketch，在get时记录），频率更高才能
+ * 进入主区，否则直接丢弃。一次性的临时查询因此无法挤掉反复出现的报表查询。
+ * 关闭admission时退化为单一LRU。
+ *
+ * 未压缩时缓存的是共享只读响应：命中时返回同一个LLMResponsePtr，
+ * 只增加引用计数，不复制候选与原始响应文本。
+ *
+ * 开启压缩后，值以序列化+字典编码的形式保存，命中时解压出新的响应；
+ * 若上一次解压出的响应仍被其他调用方持有，则直接复用该对象。
+ * 字典由当前缓存内容定期重新训练，旧条目保留编码时所用字典的引用，
+ * 无需重新编码；首个字典发布前写入、仍以未压缩形式保存的条目在发布时补压缩。
+ * 训练样本同样计入max_bytes，最多占其一半。配合max_bytes，同样的内存可以容纳数倍的条目。
+ */
+class ResponseCache {
+public:
+    explicit ResponseCache(size_t max_entries = 1000);
+    explicit ResponseCache(const ResponseCacheOptions& options);
+
+    /**
+     * @brief 查找响应，未命中返回nullptr
+     */
+    LLMResponsePtr get(const std::string& key);
+
+    /**
+     * @brief 写入响应，超出容量时淘汰最久未使用的条目
+     */
+    void put(const std::string& key, LLMResponsePtr response);
+
+    void setCapacity(size_t max_entries);
+    void setOptions(const ResponseCacheOptions& options);
+    size_t size() const;
+    void clear();
+
+    /**
+     * @brief 用当前缓存内容重新训练压缩字典
+     */
+    void retrainDictionary();
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        size_t stored_bytes;        // 缓存值实际占用字节数
+        size_t uncompressed_bytes;  // 缓存值未压缩时的字节数
+        size_t sample_bytes;        // 字典训练样本占用字节数(计入max_bytes)
+        uint64_t admission_rejections;  // 因频率不足未能进入主区的条目数
+    };
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        LLMResponsePtr response;                          // 未压缩的值
+        std::string compressed;                           // 压缩后的值
+        std::shared_ptr<const CompressionDictionary> dictionary;
+        mutable std::weak_ptr<const LLMResponse> decoded; // 最近一次解压结果
+        size_t raw_size;                                  // 序列化后未压缩字节数
+        size_t charge;                                    // 计入内存预算的字节数
+        uint64_t hash;                                    // 键哈希，用于频率估计
+        bool in_window;                                   // 是否位于准入窗口
+    };
+
+    ResponseCacheOptions options_;
+    mutable std::mutex mutex_;
+    std::list<Entry> window_; // 准入窗口，头部为最近使用
+    std::list<Entry> main_;   // 主区，头部为最近使用
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    std::shared_ptr<const CompressionDictionary> dictionary_;
+    std::deque<std::string> samples_;  // 最近写入值的序列化形式，用于训练字典
+    size_t puts_since_training_;
+    FrequencySketch sketch_;
+    Stats stats_;
+
+    LLMResponsePtr decodeLocked(const Entry& entry);
+    void compressPending(const std::shared_ptr<const CompressionDictionary>& dictionary);
+    std::list<Entry>& listOf(const Entry& entry);
+    bool overLimitLocked() const;
+    size_t windowCapacityLocked() const;
+    void removeLocked(std::list<Entry>::iterator it);
+    void evictLocked();
+};
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
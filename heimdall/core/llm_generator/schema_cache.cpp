@@ -0,0 +1,359 @@
+/**
+ * @file schema_cache.cpp
+ * @brief Schema片段缓存实现
+ */
+
+#include "schema_cache.h"
+#include "prompt_builder.h"
+#include "sql_lexer.h"
+#include <algorithm>
+#include <cstdio>
+#include <string_view>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+void appendJoined(std::string& out, const std::vector<std::string>& items) {
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (i > 0) out += ", ";
+        out += items[i];
+    }
+}
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+void hashText(uint64_t& hash, const std::string& text) {
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * kFnvPrime;
+    }
+    hash = (hash ^ 0xFF) * kFnvPrime;  // 分隔符，避免"ab","c"与"a","bc"相同
+}
+
+inline uint64_t mix(uint64_t hash, uint64_t value) {
+    return (hash ^ value) * kFnvPrime;
+}
+
+// 同一表、同一schema_version下区分变体的输入：格式、列子集与统计信息版本。
+// create_statement与主外键只随schema_version变化，NDV与索引随stats_version变化，
+// 命中时不再逐字节哈希它们
+uint64_t variantKey(const TableSchema& schema, SchemaFormat format) {
+    uint64_t hash = kFnvOffset ^ static_cast<uint64_t>(format);
+    for (const auto& column : schema.columns) hashText(hash, column);
+    hash = mix(hash, schema.create_statement.empty() ? 0 : 1);
+    hash = mix(hash, schema.stats_version);
+    return mix(hash, schema.row_count);
+}
+
+std::string tableKey(const std::string& table_name) {
+    std::string key(table_name);
+    for (auto& c : key) c = toLowerAscii(c);
+    return key;
+}
+
+// 以约两位有效数字输出计数：2880404 -> "2.9M"，18000 -> "18K"
+void appendCount(std::string& out, uint64_t count) {
+    static const char* const kUnits[] = {"", "K", "M", "B", "T"};
+    if (count < 1000) {
+        out += std::to_string(count);
+        return;
+    }
+    double value = static_cast<double>(count);
+    size_t unit = 0;
+    while (value >= 999.5 && unit + 1 < sizeof(kUnits) / sizeof(kUnits[0])) {
+        value /= 1000.0;
+        ++unit;
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), value < 9.95 ? "%.1f%s" : "%.0f%s",
+                  value, kUnits[unit]);
+    out += buffer;
+}
+
+std::string_view columnName(const std::string& column) {
+    const size_t end = column.find(' ');
+    return std::string_view(column).substr(0, end);
+}
+
+void appendColumns(std::string& out, const TableSchema& schema) {
+    for (size_t i = 0; i < schema.columns.size(); ++i) {
+        if (i > 0) out += ", ";
+        out += schema.columns[i];
+        if (schema.column_ndv.empty()) continue;
+        auto it = schema.column_ndv.find(std::string(columnName(schema.columns[i])));
+        if (it != schema.column_ndv.end()) {
+            out += " [ndv ";
+            appendCount(out, it->second);
+            out += ']';
+        }
+    }
+}
+
+void appendIndexes(std::string& out, const TableSchema& schema) {
+    if (schema.indexes.empty()) {
+        return;
+    }
+    out += "Indexes: ";
+    for (size_t i = 0; i < schema.indexes.size(); ++i) {
+        const auto& index = schema.indexes[i];
+        if (i > 0) out += ", ";
+        if (index.unique) out += "UNIQUE ";
+        out += index.name;
+        out += '(';
+        appendJoined(out, index.columns);
+        out += ')';
+    }
+    out += '\n';
+}
+
+// create_statement中没有NDV，单独输出一行
+void appendNdvLine(std::string& out, const TableSchema& schema) {
+    if (schema.column_ndv.empty()) {
+        return;
+    }
+    std::vector<std::pair<std::string_view, uint64_t>> ndv(schema.column_ndv.begin(),
+                                                           schema.column_ndv.end());
+    std::sort(ndv.begin(), ndv.end());
+    out += "NDV: ";
+    for (size_t i = 0; i < ndv.size(); ++i) {
+        if (i > 0) out += ", ";
+        out.append(ndv[i].first.data(), ndv[i].first.size());
+        out += '=';
+        appendCount(out, ndv[i].second);
+    }
+    out += '\n';
+}
+
+// 从CREATE TABLE中取出列名：第一层括号内逗号分隔的各项，跳过键与约束定义
+std::vector<std::string_view> columnsFromCreateStatement(std::string_view ddl) {
+    std::vector<std::string_view> columns;
+    SqlLexer lexer(ddl);
+    SqlToken token;
+    while (lexer.next(token) && !token.isPunct('(')) {
+    }
+    int depth = 0;
+    bool expect_name = true;
+    while (lexer.next(token)) {
+        if (token.isPunct('(')) {
+            ++depth;
+        } else if (token.isPunct(')')) {
+            if (depth-- == 0) break;
+        } else if (token.isPunct(',') && depth == 0) {
+            expect_name = true;
+        } else if (expect_name && depth == 0 && token.isIdentifier()) {
+            switch (token.keyword()) {
+            case SqlKeyword::PRIMARY:
+            case SqlKeyword::KEY:
+            case SqlKeyword::INDEX:
+            case SqlKeyword::UNIQUE:
+            case SqlKeyword::CONSTRAINT:
+            case SqlKeyword::FOREIGN:
+            case SqlKeyword::FULLTEXT:
+            case SqlKeyword::SPATIAL:
+            case SqlKeyword::CHECK:
+                break;
+            default:
+                columns.push_back(token.text);
+                break;
+            }
+            expect_name = false;
+        }
+    }
+    return columns;
+}
+
+// 外键描述"col -> table(col)"或"col REFERENCES table(col)"中被引用的表
+std::string_view referencedTable(std::string_view foreign_key) {
+    SqlLexer lexer(foreign_key);
+    SqlToken token;
+    int seen = 0;
+    while (lexer.next(token)) {
+        if (!token.isIdentifier()) continue;
+        if (++seen == 2 && !token.is(SqlKeyword::REFERENCES)) return token.text;
+        if (seen == 3) return token.text;
+    }
+    return std::string_view();
+}
+
+std::string renderCompact(const TableSchema& schema) {
+    std::vector<std::string_view> names;
+    if (!schema.columns.empty()) {
+        for (const auto& column : schema.columns) names.push_back(columnName(column));
+    } else {
+        names = columnsFromCreateStatement(schema.create_statement);
+    }
+
+    std::string out;
+    out.reserve(32 + schema.table_name.size() + names.size() * 24);
+    out += schema.table_name;
+    out += '(';
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (i > 0) out += ", ";
+        out.append(names[i].data(), names[i].size());
+        for (const auto& pk : schema.primary_keys) {
+            if (columnName(pk) == names[i]) {
+                out += " PK";
+                break;
+            }
+        }
+        for (const auto& fk : schema.foreign_keys) {
+            if (firstIdentifier(fk) == names[i]) {
+                const std::string_view target = referencedTable(fk);
+                out += " FK ";
+                out.append(target.data(), target.size());
+                break;
+            }
+        }
+        auto ndv = schema.column_ndv.find(std::string(names[i]));
+        if (ndv != schema.column_ndv.end()) {
+            out += " ~";
+            appendCount(out, ndv->second);
+        }
+    }
+    out += ')';
+    if (schema.row_count > 0) {
+        out += " ~";
+        appendCount(out, schema.row_count);
+        out += " rows";
+    }
+    if (!schema.indexes.empty()) {
+        out += "; idx ";
+        for (size_t i = 0; i < schema.indexes.size(); ++i) {
+            if (i > 0) out += ", ";
+            if (schema.indexes[i].unique) out += "U";
+            out += '(';
+            appendJoined(out, schema.indexes[i].columns);
+            out += ')';
+        }
+    }
+    out += '\n';
+    return out;
+}
+
+} // namespace
+
+std::string renderTableSchema(const TableSchema& schema, SchemaFormat format) {
+    if (format == SchemaFormat::COMPACT) {
+        return renderCompact(schema);
+    }
+    std::string out;
+    out.reserve(64 + schema.table_name.size() + schema.create_statement.size() +
+                schema.columns.size() * 16);
+    out += "### Table: ";
+    out += schema.table_name;
+    if (schema.row_count > 0) {
+        out += " (~";
+        appendCount(out, schema.row_count);
+        out += " rows)";
+    }
+    if (!schema.create_statement.empty()) {
+        out += "\n```sql\n";
+        out += schema.create_statement;
+        out += "\n```\n";
+        appendNdvLine(out, schema);
+        appendIndexes(out, schema);
+        out += '\n';
+        return out;
+    }
+    if (!schema.columns.empty()) {
+        out += "\nColumns: ";
+        appendColumns(out, schema);
+    }
+    if (!schema.primary_keys.empty()) {
+        out += "\nPrimary Keys: ";
+        appendJoined(out, schema.primary_keys);
+    }
+    if (!schema.foreign_keys.empty()) {
+        out += "\nForeign Keys: ";
+        appendJoined(out, schema.foreign_keys);
+    }
+    out += '\n';
+    appendIndexes(out, schema);
+    out += '\n';
+    return out;
+}
+
+SchemaRenderCache::SchemaRenderCache(size_t max_tables)
+    : max_tables_(max_tables), generation_(0), stats_{} {}
+
+std::shared_ptr<const std::string> SchemaRenderCache::get(const TableSchema& schema,
+                                                          SchemaFormat format) {
+    const uint64_t shape = variantKey(schema, format);
+    const std::string key = tableKey(schema.table_name);
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end() && it->second.version == schema.schema_version) {
+            auto variant = it->second.variants.find(shape);
+            if (variant != it->second.variants.end()) {
+                lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+                ++stats_.hits;
+                return variant->second;
+            }
+        }
+        ++stats_.misses;
+        generation = generation_;
+    }
+
+    // 渲染在锁外完成；并发未命中时重复渲染同一张表无害
+    auto rendered = std::make_shared<const std::string>(renderTableSchema(schema, format));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation != generation_) {
+        // 渲染期间有表失效，schema可能是DDL之前读到的，不写入缓存
+        return rendered;
+    }
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        if (max_tables_ == 0) {
+            return rendered;
+        }
+        if (entries_.size() >= max_tables_) {
+            entries_.erase(lru_.back());
+            lru_.pop_back();
+        }
+        lru_.push_front(key);
+        it = entries_.emplace(key, Entry()).first;
+        it->second.version = schema.schema_version;
+        it->second.lru_pos = lru_.begin();
+    } else {
+        lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+    }
+    Entry& entry = it->second;
+    if (entry.version != schema.schema_version ||
+        entry.variants.size() >= kMaxVariants) {
+        entry.version = schema.schema_version;
+        entry.variants.clear();
+    }
+    entry.variants[shape] = rendered;
+    return rendered;
+}
+
+void SchemaRenderCache::invalidate(const std::string& table_name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    auto it = entries_.find(tableKey(table_name));
+    if (it != entries_.end()) {
+        lru_.erase(it->second.lru_pos);
+        entries_.erase(it);
+        ++stats_.invalidations;
+    }
+}
+
+void SchemaRenderCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    entries_.clear();
+    lru_.clear();
+}
+
+SchemaRenderCache::Stats SchemaRenderCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace llm
+} // namespace heimdall
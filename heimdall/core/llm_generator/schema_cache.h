@@ -0,0 +1,95 @@
+/**
+ * @file schema_cache.h
+ * @brief 按表缓存渲染后的Schema片段
+ */
+
+#ifndef HEIMDALL_SCHEMA_CACHE_H
+#define HEIMDALL_SCHEMA_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace heimdall {
+namespace llm {
+
+struct TableSchema;
+
+/**
+ * @brief Schema在Prompt中的表示形式
+ */
+enum class SchemaFormat {
+    DETAILED,   // "### Table:"段落，有create_statement时原样输出
+    COMPACT     // 单行"store_sales(ss_sold_date_sk FK date_dim, ss_item_sk PK, ...)"
+};
+
+/**
+ * @brief 渲染单张表的Prompt片段
+ *
+ * COMPACT只保留列名、主外键标注、行数/NDV与索引列，不输出类型、约束
+ * 和格式化空白；没有列清单时从create_statement中提取列名。
+ */
+std::string renderTableSchema(const TableSchema& schema,
+                              SchemaFormat format = SchemaFormat::DETAILED);
+
+/**
+ * @brief Schema片段缓存
+ *
+ * 以(表名, schema_version)为键保存渲染结果，表名不区分大小写；
+ * 版本不一致时重新渲染。同一张表可能以不同列子集出现（按查询裁剪后的Schema），
+ * 每种列子集按列清单、stats_version与行数各占一个变体。
+ * create_statement、主外键视为由schema_version确定，NDV与索引由stats_version确定，
+ * 命中时只哈希列清单，不逐字节比较DDL。
+ * DDL提交后调用方须递增schema_version或调用invalidate()；
+ * 渲染期间发生的失效会使该次结果不写入缓存。
+ * 超过max_tables时淘汰最久未使用的表。片段以shared_ptr交出，失效后
+ * 正在使用旧片段的Prompt构建不受影响。线程安全。
+ */
+class SchemaRenderCache {
+public:
+    explicit SchemaRenderCache(size_t max_tables = 4096);
+
+    /**
+     * @brief 获取表的渲染片段，未命中或版本过期时渲染并写入缓存
+     */
+    std::shared_ptr<const std::string> get(const TableSchema& schema,
+                                           SchemaFormat format = SchemaFormat::DETAILED);
+
+    /**
+     * @brief 表结构发生变化（DDL）时使其片段失效
+     */
+    void invalidate(const std::string& table_name);
+    void clear();
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t invalidations;
+    };
+    Stats getStats() const;
+
+private:
+    static constexpr size_t kMaxVariants = 32;
+
+    struct Entry {
+        uint64_t version = 0;
+        // 渲染输入哈希 -> 渲染结果
+        std::unordered_map<uint64_t, std::shared_ptr<const std::string>> variants;
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    size_t max_tables_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_;    // 表头为最近使用
+    uint64_t generation_;           // 每次invalidate()/clear()递增
+    Stats stats_;
+};
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
@@ -0,0 +1,436 @@
+/**
+ * @file schema_pruner.cpp
+ * @brief Schema裁剪实现
+ */
+
+#include "schema_pruner.h"
+#include "prompt_builder.h"
+#include "sql_lexer.h"
+#include <algorithm>
+#include <string>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+int compareIgnoreCase(std::string_view a, std::string_view b) {
+    const size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; ++i) {
+        const char x = toLowerAscii(a[i]);
+        const char y = toLowerAscii(b[i]);
+        if (x != y) return x < y ? -1 : 1;
+    }
+    return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+}
+
+// 限定名的最后一段："tpcds.store_sales" -> "store_sales"
+std::string_view lastSegment(std::string_view name) {
+    const size_t dot = name.rfind('.');
+    return dot == std::string_view::npos ? name : name.substr(dot + 1);
+}
+
+bool containsName(const std::vector<std::string_view>& names, std::string_view name) {
+    for (auto candidate : names) {
+        if (equalsIgnoreCase(candidate, name)) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 查询中出现的标识符，视图指向SQL文本，按不区分大小写排序去重
+ */
+struct QueryReferences {
+    std::vector<std::string_view> identifiers;
+    bool star = false;                            // 出现SELECT *或t.*
+
+    bool contains(std::string_view name) const {
+        auto it = std::lower_bound(identifiers.begin(), identifiers.end(), name,
+                                   [](std::string_view a, std::string_view b) {
+                                       return compareIgnoreCase(a, b) < 0;
+                                   });
+        return it != identifiers.end() && equalsIgnoreCase(*it, name);
+    }
+};
+
+void scanReferences(std::string_view sql, QueryReferences& refs) {
+    refs.identifiers.clear();
+    refs.star = false;
+    // '*'紧跟SELECT/DISTINCT、逗号或点号（或位于开头）时为列通配
+    bool star_allowed = true;
+    SqlLexer lexer(sql);
+    SqlToken token;
+    while (lexer.next(token)) {
+        if (token.isIdentifier()) {
+            refs.identifiers.push_back(token.text);
+            const SqlKeyword kw = token.keyword();
+            star_allowed = kw == SqlKeyword::SELECT || kw == SqlKeyword::DISTINCT;
+            continue;
+        }
+        if (token.isPunct('*') && star_allowed) {
+            refs.star = true;
+        }
+        star_allowed = token.isPunct(',') || token.isPunct('.');
+    }
+    auto less = [](std::string_view a, std::string_view b) { return compareIgnoreCase(a, b) < 0; };
+    std::sort(refs.identifiers.begin(), refs.identifiers.end(), less);
+    refs.identifiers.erase(std::unique(refs.identifiers.begin(), refs.identifiers.end(),
+                                       equalsIgnoreCase),
+                           refs.identifiers.end());
+}
+
+bool isReferenced(const TableSchema& schema, const QueryReferences& refs) {
+    return refs.contains(schema.table_name) ||
+           refs.contains(lastSegment(schema.table_name));
+}
+
+// 外键描述（如"ss_item_sk -> item(i_item_sk)"）除首个标识符（本表列）外是否出现target表
+bool fkReferences(const std::string& foreign_key, std::string_view target) {
+    SqlLexer lexer(foreign_key);
+    SqlToken token;
+    bool first = true;
+    while (lexer.next(token)) {
+        if (!token.isIdentifier()) continue;
+        if (!first && equalsIgnoreCase(token.text, target)) return true;
+        first = false;
+    }
+    return false;
+}
+
+bool adjacent(const TableSchema& a, const TableSchema& b) {
+    const std::string_view a_name = lastSegment(a.table_name);
+    const std::string_view b_name = lastSegment(b.table_name);
+    for (const auto& fk : a.foreign_keys) {
+        if (fkReferences(fk, b_name)) return true;
+    }
+    for (const auto& fk : b.foreign_keys) {
+        if (fkReferences(fk, a_name)) return true;
+    }
+    return false;
+}
+
+std::string_view trimView(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t' ||
+                             text.front() == '\n' || text.front() == '\r')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' ||
+                             text.back() == '\n' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool containsKeyword(std::string_view text, SqlKeyword keyword) {
+    SqlLexer lexer(text);
+    SqlToken token;
+    while (lexer.next(token)) {
+        if (token.is(keyword)) return true;
+    }
+    return false;
+}
+
+bool isColumnDefinition(const SqlToken& first) {
+    switch (first.keyword()) {
+    case SqlKeyword::PRIMARY:
+    case SqlKeyword::KEY:
+    case SqlKeyword::INDEX:
+    case SqlKeyword::UNIQUE:
+    case SqlKeyword::CONSTRAINT:
+    case SqlKeyword::FOREIGN:
+    case SqlKeyword::FULLTEXT:
+    case SqlKeyword::SPATIAL:
+    case SqlKeyword::CHECK:
+        return false;
+    default:
+        return first.isIdentifier();
+    }
+}
+
+// 约束项中第一对括号内的列清单，如"PRIMARY KEY (a, b)"
+void appendKeyList(std::string_view item, std::vector<std::string_view>& keys) {
+    SqlLexer lexer(item);
+    SqlToken token;
+    while (lexer.next(token) && !token.isPunct('(')) {
+    }
+    while (lexer.next(token) && !token.isPunct(')')) {
+        if (token.isIdentifier()) keys.push_back(token.text);
+    }
+}
+
+/**
+ * @brief 把CREATE TABLE第一层括号内的各项分为列定义与键列
+ *
+ * 键列来自PRIMARY KEY/FOREIGN KEY约束的列清单，以及带内联PRIMARY KEY
+ * 或REFERENCES的列定义
+ */
+void splitCreateStatement(std::string_view ddl,
+                          std::vector<std::string_view>& columns,
+                          std::vector<std::string_view>& keys,
+                          std::vector<std::string_view>* key_constraints = nullptr) {
+    columns.clear();
+    keys.clear();
+    if (key_constraints) key_constraints->clear();
+    SqlLexer lexer(ddl);
+    SqlToken token;
+    while (lexer.next(token) && !token.isPunct('(')) {
+    }
+    if (token.type == SqlTokenType::END) {
+        return;
+    }
+    size_t item_start = lexer.position();
+    SqlToken first;             // 当前项的首个记号
+    int depth = 0;
+    auto finishItem = [&](size_t end) {
+        const std::string_view item = trimView(ddl.substr(item_start, end - item_start));
+        if (item.empty()) return;
+        if (isColumnDefinition(first)) {
+            columns.push_back(item);
+            if (containsKeyword(item, SqlKeyword::PRIMARY) ||
+                containsKeyword(item, SqlKeyword::REFERENCES)) {
+                keys.push_back(first.text);
+            }
+            return;
+        }
+        if (containsKeyword(item, SqlKeyword::PRIMARY) ||
+            containsKeyword(item, SqlKeyword::FOREIGN)) {
+            appendKeyList(item, keys);
+            if (key_constraints) key_constraints->push_back(item);
+        }
+    };
+    first.type = SqlTokenType::END;
+    while (lexer.next(token)) {
+        if (first.type == SqlTokenType::END) first = token;
+        if (token.isPunct('(')) {
+            ++depth;
+        } else if (token.isPunct(')')) {
+            if (depth-- == 0) {
+                finishItem(token.offset);
+                return;
+            }
+        } else if (token.isPunct(',') && depth == 0) {
+            finishItem(token.offset);
+            item_start = lexer.position();
+            first.type = SqlTokenType::END;
+        }
+    }
+}
+
+void selectColumns(const TableSchema& schema, const QueryReferences* refs,
+                   SchemaSelection& selection) {
+    thread_local std::vector<std::string_view> keys;
+    thread_local std::vector<std::string_view> ddl_columns;
+    keys.clear();
+    for (const auto& pk : schema.primary_keys) keys.push_back(firstIdentifier(pk));
+    for (const auto& fk : schema.foreign_keys) keys.push_back(firstIdentifier(fk));
+
+    auto keep = [&](std::string_view name) {
+        return containsName(keys, name) || (refs && refs->contains(name));
+    };
+
+    selection.columns.clear();
+    selection.ddl_columns.clear();
+    if (!schema.columns.empty()) {
+        for (size_t i = 0; i < schema.columns.size(); ++i) {
+            if (keep(firstIdentifier(schema.columns[i]))) {
+                selection.columns.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        selection.all_columns = selection.columns.size() == schema.columns.size();
+        return;
+    }
+
+    thread_local std::vector<std::string_view> ddl_keys;
+    splitCreateStatement(schema.create_statement, ddl_columns, ddl_keys);
+    keys.insert(keys.end(), ddl_keys.begin(), ddl_keys.end());
+    for (auto column : ddl_columns) {
+        if (keep(firstIdentifier(column))) {
+            selection.ddl_columns.push_back(column);
+        }
+    }
+    // 未能从DDL解析出列时保留原样
+    selection.all_columns = ddl_columns.empty() ||
+                            selection.ddl_columns.size() == ddl_columns.size();
+}
+
+} // namespace
+
+void pruneSchemas(std::string_view sql,
+                  const std::vector<TableSchema>& schemas,
+                  const SchemaPruningOptions& options,
+                  std::vector<SchemaSelection>& out) {
+    out.clear();
+    auto keepAll = [&]() {
+        out.resize(schemas.size());
+        for (size_t i = 0; i < schemas.size(); ++i) {
+            out[i].table = i;
+            out[i].all_columns = true;
+            out[i].columns.clear();
+            out[i].ddl_columns.clear();
+        }
+    };
+    if (!options.enabled || schemas.empty()) {
+        keepAll();
+        return;
+    }
+
+    thread_local QueryReferences refs;
+    scanReferences(sql, refs);
+    thread_local std::vector<char> referenced;
+    referenced.assign(schemas.size(), 0);
+    bool any = false;
+    for (size_t i = 0; i < schemas.size(); ++i) {
+        referenced[i] = isReferenced(schemas[i], refs);
+        any = any || referenced[i];
+    }
+    if (!any) {
+        keepAll();
+        return;
+    }
+
+    thread_local std::vector<char> neighbor;
+    neighbor.assign(schemas.size(), 0);
+    if (options.include_fk_neighbors) {
+        int added = 0;
+        for (size_t i = 0; i < schemas.size() && added < options.max_fk_neighbors; ++i) {
+            if (referenced[i]) continue;
+            for (size_t j = 0; j < schemas.size(); ++j) {
+                if (referenced[j] && adjacent(schemas[i], schemas[j])) {
+                    neighbor[i] = 1;
+                    ++added;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < schemas.size(); ++i) {
+        if (!referenced[i] && !neighbor[i]) {
+            continue;
+        }
+        out.emplace_back();
+        SchemaSelection& selection = out.back();
+        selection.table = i;
+        selection.all_columns = true;
+        if (!options.prune_columns || (referenced[i] && refs.star)) {
+            continue;
+        }
+        // 邻接表只用于提示可连接的键，列只保留主外键
+        selectColumns(schemas[i], referenced[i] ? &refs : nullptr, selection);
+    }
+}
+
+void materializeSelection(const TableSchema& schema,
+                          const SchemaSelection& selection,
+                          TableSchema& out) {
+    out.table_name = schema.table_name;
+    out.primary_keys = schema.primary_keys;
+    out.foreign_keys = schema.foreign_keys;
+    out.schema_version = schema.schema_version;
+    out.row_count = schema.row_count;
+    out.stats_version = schema.stats_version;
+    out.create_statement.clear();
+    out.columns.resize(selection.columns.size() + selection.ddl_columns.size());
+
+    thread_local std::vector<std::string_view> kept;
+    kept.clear();
+    size_t n = 0;
+    for (uint32_t index : selection.columns) {
+        out.columns[n++] = schema.columns[index];
+        kept.push_back(firstIdentifier(schema.columns[index]));
+    }
+    for (auto column : selection.ddl_columns) {
+        out.columns[n++].assign(column.data(), column.size());
+        kept.push_back(firstIdentifier(column));
+    }
+
+    // 统计信息只保留剩余列相关的部分
+    out.column_ndv.clear();
+    for (const auto& ndv : schema.column_ndv) {
+        if (containsName(kept, ndv.first)) out.column_ndv.insert(ndv);
+    }
+    out.indexes.clear();
+    for (const auto& index : schema.indexes) {
+        if (!index.columns.empty() && containsName(kept, firstIdentifier(index.columns[0]))) {
+            out.indexes.push_back(index);
+        }
+    }
+}
+
+void reduceSchema(const TableSchema& schema,
+                  bool key_columns_only,
+                  bool drop_create_statement,
+                  TableSchema& out) {
+    thread_local std::vector<std::string_view> keys;
+    thread_local std::vector<std::string_view> ddl_columns;
+    thread_local std::vector<std::string_view> ddl_keys;
+    thread_local std::vector<std::string_view> constraints;
+    keys.clear();
+    for (const auto& pk : schema.primary_keys) keys.push_back(firstIdentifier(pk));
+    for (const auto& fk : schema.foreign_keys) keys.push_back(firstIdentifier(fk));
+    ddl_columns.clear();
+    constraints.clear();
+    if (!schema.create_statement.empty()) {
+        splitCreateStatement(schema.create_statement, ddl_columns, ddl_keys, &constraints);
+        keys.insert(keys.end(), ddl_keys.begin(), ddl_keys.end());
+    }
+    auto keep = [&](std::string_view name) {
+        return !key_columns_only || containsName(keys, name);
+    };
+
+    out.table_name = schema.table_name;
+    out.primary_keys = schema.primary_keys;
+    out.foreign_keys = schema.foreign_keys;
+    out.schema_version = schema.schema_version;
+    out.row_count = schema.row_count;
+    out.stats_version = schema.stats_version;
+    out.columns.clear();
+    for (const auto& column : schema.columns) {
+        if (keep(firstIdentifier(column))) out.columns.push_back(column);
+    }
+
+    out.create_statement.clear();
+    if (ddl_columns.empty()) {
+        out.create_statement = schema.create_statement;
+    } else if (drop_create_statement) {
+        if (schema.columns.empty()) {
+            for (auto column : ddl_columns) {
+                if (keep(firstIdentifier(column))) out.columns.emplace_back(column);
+            }
+        }
+    } else if (key_columns_only) {
+        // 重写为只含键列定义与主外键约束的DDL，一项都不剩时不输出
+        const char* separator = "\n  ";
+        for (auto column : ddl_columns) {
+            if (!keep(firstIdentifier(column))) continue;
+            out.create_statement += separator;
+            out.create_statement.append(column.data(), column.size());
+            separator = ",\n  ";
+        }
+        for (auto constraint : constraints) {
+            out.create_statement += separator;
+            out.create_statement.append(constraint.data(), constraint.size());
+            separator = ",\n  ";
+        }
+        if (!out.create_statement.empty()) {
+            out.create_statement.insert(0, "CREATE TABLE " + schema.table_name + " (");
+            out.create_statement += "\n)";
+        }
+    } else {
+        out.create_statement = schema.create_statement;
+    }
+
+    out.column_ndv.clear();
+    for (const auto& ndv : schema.column_ndv) {
+        if (keep(ndv.first)) out.column_ndv.insert(ndv);
+    }
+    out.indexes.clear();
+    for (const auto& index : schema.indexes) {
+        if (!index.columns.empty() && keep(firstIdentifier(index.columns[0]))) {
+            out.indexes.push_back(index);
+        }
+    }
+}
+
+} // namespace llm
+} // namespace heimdall
@@ -0,0 +1,95 @@
+/**
+ * @file schema_pruner.h
+ * @brief 按查询引用裁剪Prompt中的Schema
+ */
+
+#ifndef HEIMDALL_SCHEMA_PRUNER_H
+#define HEIMDALL_SCHEMA_PRUNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace heimdall {
+namespace llm {
+
+struct TableSchema;
+
+/**
+ * @brief Schema裁剪选项
+ */
+struct SchemaPruningOptions {
+    bool enabled;               // 是否裁剪
+    bool prune_columns;         // 是否裁剪未引用的非键列
+    bool include_fk_neighbors;  // 是否附带与被引用表有外键关系的表
+    int max_fk_neighbors;       // 附带的外键邻接表上限
+
+    SchemaPruningOptions()
+        : enabled(false),
+          prune_columns(true),
+          include_fk_neighbors(false),
+          max_fk_neighbors(2) {}
+};
+
+/**
+ * @brief 一张表的裁剪结果，以下标和视图引用输入的Schema，不复制
+ */
+struct SchemaSelection {
+    size_t table;                               // 在输入schemas中的下标
+    bool all_columns;                           // true表示原样使用该表
+    std::vector<uint32_t> columns;              // 保留的列在schema.columns中的下标
+    std::vector<std::string_view> ddl_columns;  // 只有create_statement时保留的列定义，
+                                                // 指向schema.create_statement
+};
+
+/**
+ * @brief 只保留查询引用到的表与列
+ *
+ * 表：表名（或限定名的最后一段）作为标识符出现在SQL中即视为引用；
+ * 开启include_fk_neighbors时，外键指向/来自被引用表的表按出现顺序附带，
+ * 供模型考虑经由维表的改写。
+ *
+ * 列：保留SQL中出现的列与主键/外键列；查询出现"*"时保留该表全部列。
+ * 只有create_statement、没有列清单的表从DDL中逐项取列定义裁剪，
+ * PRIMARY KEY/FOREIGN KEY约束及内联PRIMARY KEY/REFERENCES涉及的列视为键列。
+ * 列被裁剪的表不再输出create_statement，改用列清单，以免整段DDL
+ * 抵消裁剪效果。
+ *
+ * 查询中一张表都没匹配上时（例如表名经视图或同义词间接引用）原样返回
+ * 全部表，宁可Prompt偏长也不丢失上下文。
+ *
+ * 结果写入out（复用其容量），按输入顺序排列；视图在schemas存活期间有效。
+ */
+void pruneSchemas(std::string_view sql,
+                  const std::vector<TableSchema>& schemas,
+                  const SchemaPruningOptions& options,
+                  std::vector<SchemaSelection>& out);
+
+/**
+ * @brief 按裁剪结果生成只含保留列的Schema
+ *
+ * 只用于all_columns为false的表；out的字符串与容器缓冲被复用
+ */
+void materializeSelection(const TableSchema& schema,
+                          const SchemaSelection& selection,
+                          TableSchema& out);
+
+/**
+ * @brief 超出token预算时按层级删减单张表
+ * @param key_columns_only 只保留主外键列；只有create_statement的表改写为
+ *                         只含键列定义与主外键约束的DDL
+ * @param drop_create_statement 不输出create_statement，改用其中的列定义清单
+ *
+ * 两项各自只删减所指的部分；DDL解析不出列定义时原样保留。
+ * out的字符串与容器缓冲被复用
+ */
+void reduceSchema(const TableSchema& schema,
+                  bool key_columns_only,
+                  bool drop_create_statement,
+                  TableSchema& out);
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
@@ -0,0 +1,466 @@
+/**
+ * @file sql_grammar.cpp
+ * @brief SELECT语句语法实现
+ */
+
+#include "sql_grammar.h"
+#include "sql_lexer.h"
+#include <algorithm>
+#include <set>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+// 语法骨架，table-name/column-name规则由Schema生成后追加
+const char* const kSelectGrammarBase = R"GBNF(root ::= ws? query ws? (";" ws?)?
+query ::= with-clause? select-core (ws set-op ws select-core)* (ws order-by)? (ws limit)?
+with-clause ::= "WITH" ws cte (ws? "," ws? cte)* ws
+cte ::= cte-name ws "AS" ws? "(" ws? query ws? ")"
+set-op ::= "UNION" (ws "ALL")? | "INTERSECT" | "EXCEPT"
+select-core ::= "SELECT" (ws "DISTINCT")? ws select-list ws "FROM" ws from-clause (ws "WHERE" ws expr)? (ws "GROUP" ws "BY" ws expr-list)? (ws "HAVING" ws expr)?
+select-list ::= select-item (ws? "," ws? select-item)*
+select-item ::= "*" | qualifier "." "*" | expr (ws ("AS" ws)? alias)?
+from-clause ::= table-ref (ws? "," ws? table-ref | ws join)*
+join ::= (join-type ws)? "JOIN" ws table-ref ws "ON" ws expr
+join-type ::= "INNER" | "CROSS" | ("LEFT" | "RIGHT") (ws "OUTER")?
+table-ref ::= (table-name | cte-name) (ws ("AS" ws)? alias)? | "(" ws? query ws? ")" ws ("AS" ws)? alias
+order-by ::= "ORDER" ws "BY" ws order-item (ws? "," ws? order-item)*
+order-item ::= expr (ws ("ASC" | "DESC"))?
+limit ::= "LIMIT" ws number (ws? "," ws? number | ws "OFFSET" ws number)?
+expr-list ::= expr (ws? "," ws? expr)*
+expr ::= term (ws logic-op ws term | ws? arith-op ws? term)*
+logic-op ::= "AND" | "OR"
+arith-op ::= "=" | "<>" | "!=" | "<=" | ">=" | "<" | ">" | "+" | "-" | "*" | "/" | "%"
+term ::= ("NOT" ws)? primary (ws predicate)?
+predicate ::= ("NOT" ws)? "IN" ws? "(" ws? (query | expr-list) ws? ")" | ("NOT" ws)? "BETWEEN" ws primary ws "AND" ws primary | "IS" ws ("NOT" ws)? "NULL" | ("NOT" ws)? "LIKE" ws string
+primary ::= "-"? (column-ref | number) | string | typed-literal | interval | "NULL" | cast | extract | function | case-expr | "EXISTS" ws? "(" ws? query ws? ")" | "(" ws? (query | expr) ws? ")"
+function ::= func-name ws? "(" ws? ("*" | ("DISTINCT" ws)? expr-list)? ws? ")" (ws "OVER" ws? "(" ws? window-spec? ws? ")")?
+window-spec ::= partition-by (ws window-order)? (ws frame)? | window-order (ws frame)?
+partition-by ::= "PARTITION" ws "BY" ws expr-list
+window-order ::= "ORDER" ws "BY" ws order-item (ws? "," ws? order-item)*
+frame ::= ("ROWS" | "RANGE") ws ("BETWEEN" ws frame-bound ws "AND" ws frame-bound | frame-bound)
+frame-bound ::= "UNBOUNDED" ws ("PRECEDING" | "FOLLOWING") | "CURRENT" ws "ROW" | number ws ("PRECEDING" | "FOLLOWING")
+cast ::= "CAST" ws? "(" ws? expr ws "AS" ws type-name ws? ")"
+type-name ::= ("DECIMAL" | "NUMERIC" | "CHAR" | "VARCHAR" | "INTEGER" | "INT" | "DATE" | "DATETIME" | "TIMESTAMP" | "TIME" | "DOUBLE" | "FLOAT") (ws? "(" ws? number (ws? "," ws? number)? ws? ")")? | ("SIGNED" | "UNSIGNED") (ws "INTEGER")?
+extract ::= "EXTRACT" ws? "(" ws? time-unit ws "FROM" ws expr ws? ")"
+interval ::= "INTERVAL" ws (number | string | "(" ws? expr ws? ")") ws time-unit
+time-unit ::= "YEAR" | "QUARTER" | "MONTH" | "WEEK" | "DAY" | "HOUR" | "MINUTE" | "SECOND"
+typed-literal ::= ("DATE" | "TIMESTAMP" | "TIME") ws? string
+case-expr ::= "CASE" (ws expr)? (ws "WHEN" ws expr ws "THEN" ws expr)+ (ws "ELSE" ws expr)? ws "END"
+column-ref ::= qualifier "." column-name | column-name | alias
+qualifier ::= table-name | cte-name | alias
+cte-name ::= [cC] [tT] [eE] "_" [a-zA-Z0-9_]+
+alias ::= [a-zA-Z_] [a-zA-Z0-9_]*
+number ::= [0-9]+ ("." [0-9]+)?
+string ::= "'" ([^'\\] | "''")* "'"
+ws ::= [ \t\n]+
+)GBNF";
+
+// 与GBNF中func-name一致
+const char* const kFunctions[] = {
+    "count", "sum", "avg", "min", "max", "coalesce", "ifnull", "nullif",
+    "abs", "round", "floor", "ceil", "substr", "substring", "upper",
+    "lower", "trim", "concat", "length", "year", "month", "day",
+    "date_add", "date_sub", "datediff", "greatest", "least", "stddev_samp",
+    "rank", "dense_rank", "row_number", "ntile", "lag", "lead",
+    "first_value", "last_value",
+};
+
+// 与GBNF中的关键字、类型名、时间单位一致
+const char* const kKeywords[] = {
+    "select", "distinct", "all", "from", "where", "group", "by", "having",
+    "order", "asc", "desc", "limit", "offset", "join", "inner", "left",
+    "right", "outer", "cross", "on", "as", "and", "or", "not", "in",
+    "exists", "between", "like", "is", "null", "case", "when", "then",
+    "else", "end", "union", "intersect", "except", "with",
+    "cast", "extract", "interval", "over", "partition", "rows", "range",
+    "unbounded", "preceding", "following", "current", "row",
+    "decimal", "numeric", "char", "varchar", "integer", "int", "date",
+    "datetime", "timestamp", "time", "double", "float", "signed", "unsigned",
+    "year", "quarter", "month", "week", "day", "hour", "minute", "second",
+};
+
+// 出现即拒绝：这些词意味着候选不是只读SELECT
+const char* const kForbidden[] = {
+    "insert", "update", "delete", "replace", "drop", "alter", "create",
+    "truncate", "grant", "revoke", "into", "load", "call", "handler",
+    "set", "lock", "unlock", "rename", "outfile", "dumpfile",
+};
+
+template <size_t N>
+bool contains(const char* const (&words)[N], const std::string& w) {
+    for (const char* k : words) {
+        if (w == k) return true;
+    }
+    return false;
+}
+
+std::string lowerCopy(std::string_view s) {
+    std::string out(s.size(), '\0');
+    std::transform(s.begin(), s.end(), out.begin(), toLowerAscii);
+    return out;
+}
+
+// 列定义可能是"name TYPE ..."，只取名称部分
+std::string columnName(const std::string& column) {
+    return std::string(firstIdentifier(column));
+}
+
+// 把单词写成不区分大小写的GBNF序列，如 "ss_sk" -> [sS] [sS] "_" [sS] [kK]
+void appendCaseInsensitive(std::string& out, std::string_view word) {
+    out += '(';
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (i > 0) out += ' ';
+        const char c = word[i];
+        const char lower = toLowerAscii(c);
+        if (lower >= 'a' && lower <= 'z') {
+            out += '[';
+            out += lower;
+            out += static_cast<char>(lower - 'a' + 'A');
+            out += ']';
+        } else {
+            out += '"';
+            out += c;
+            out += '"';
+        }
+    }
+    out += ')';
+}
+
+// 语法骨架中的大写关键字字面量改写为不区分大小写的形式，与accepts()一致
+std::string caseInsensitiveKeywords(const char* grammar) {
+    std::string out;
+    const std::string_view text(grammar);
+    size_t i = 0;
+    while (i < text.size()) {
+        if (text[i] == '"') {
+            size_t j = i + 1;
+            bool upper_word = true;
+            bool has_letter = false;
+            while (j < text.size() && text[j] != '"') {
+                const bool letter = text[j] >= 'A' && text[j] <= 'Z';
+                has_letter = has_letter || letter;
+                upper_word = upper_word && (letter || text[j] == '_');
+                ++j;
+            }
+            if (upper_word && has_letter && j < text.size()) {
+                appendCaseInsensitive(out, text.substr(i + 1, j - i - 1));
+            } else {
+                out.append(text, i, j + 1 - i);
+            }
+            i = j + 1;
+        } else if (text[i] == '[') {
+            // 字符类原样保留，其中的引号不是字面量
+            const size_t j = text.find(']', i + 1);
+            const size_t end = j == std::string_view::npos ? text.size() : j + 1;
+            out.append(text, i, end - i);
+            i = end;
+        } else {
+            out += text[i++];
+        }
+    }
+    return out;
+}
+
+void appendAlternatives(std::string& out, const char* rule,
+                        const std::set<std::string>& names) {
+    out += rule;
+    out += " ::= ";
+    if (names.empty()) {
+        out += "alias\n";
+        return;
+    }
+    bool first = true;
+    for (const auto& name : names) {
+        if (!first) out += " | ";
+        first = false;
+        appendCaseInsensitive(out, name);
+    }
+    out += '\n';
+}
+
+struct Token {
+    enum Kind { WORD, NUMBER, STRING, PUNCT } kind;
+    std::string text;   // WORD为小写文本，PUNCT为单字符
+};
+
+bool tokenize(std::string_view sql, std::vector<Token>* tokens,
+              std::string* error) {
+    SqlLexer lexer(sql);
+    SqlToken token;
+    for (;;) {
+        const bool more = lexer.next(token);
+        if (lexer.commentCount() > 0) {
+            if (error) *error = "comments are not allowed";
+            return false;
+        }
+        if (!more) {
+            return true;
+        }
+        switch (token.type) {
+        case SqlTokenType::STRING:
+            if (token.text[0] == '"') {
+                if (error) *error = "quoted identifiers are not allowed";
+                return false;
+            }
+            if (token.escaped) {
+                if (error) *error = "backslash escapes are not allowed";
+                return false;
+            }
+            if (!token.terminated) {
+                if (error) *error = "unterminated string literal";
+                return false;
+            }
+            tokens->push_back({Token::STRING, std::string()});
+            break;
+        case SqlTokenType::QUOTED_IDENTIFIER:
+            if (error) *error = "quoted identifiers are not allowed";
+            return false;
+        case SqlTokenType::NUMBER:
+            // 语法只接受十进制整数与小数，指数与十六进制写法一律拒绝
+            if (token.text[0] == '.' ||
+                token.text.find_first_not_of("0123456789.") != std::string_view::npos) {
+                if (error) *error = "malformed number";
+                return false;
+            }
+            tokens->push_back({Token::NUMBER, std::string()});
+            break;
+        case SqlTokenType::WORD:
+            tokens->push_back({Token::WORD, lowerCopy(token.text)});
+            break;
+        default:
+            // 双字符比较运算符按单字符处理即可，语法检查只关心标识符与括号
+            tokens->push_back({Token::PUNCT, std::string(1, token.text[0])});
+            break;
+        }
+    }
+}
+
+inline bool isPunct(const Token& t, char c) {
+    return t.kind == Token::PUNCT && t.text[0] == c;
+}
+
+inline bool isWord(const Token& t, const char* w) {
+    return t.kind == Token::WORD && t.text == w;
+}
+
+} // namespace
+
+std::shared_ptr<const SqlGrammar> SqlGrammar::forSelect(
+    const std::vector<TableSchema>& schemas) {
+    std::shared_ptr<SqlGrammar> grammar(new SqlGrammar());
+
+    std::set<std::string> tables;
+    std::set<std::string> columns;
+    for (const auto& schema : schemas) {
+        if (!schema.table_name.empty()) {
+            tables.insert(schema.table_name);
+            grammar->tables_.insert(lowerCopy(schema.table_name));
+        }
+        for (const auto& column : schema.columns) {
+            std::string name = columnName(column);
+            if (!name.empty()) {
+                grammar->columns_.insert(lowerCopy(name));
+                columns.insert(std::move(name));
+            }
+        }
+    }
+
+    std::string& out = grammar->gbnf_;
+    out = caseInsensitiveKeywords(kSelectGrammarBase);
+    out += "func-name ::= ";
+    bool first = true;
+    for (const char* f : kFunctions) {
+        if (!first) out += " | ";
+        first = false;
+        appendCaseInsensitive(out, f);
+    }
+    out += '\n';
+    appendAlternatives(out, "table-name", tables);
+    appendAlternatives(out, "column-name", columns);
+    return grammar;
+}
+
+bool SqlGrammar::accepts(std::string_view sql, std::string* error) const {
+    std::vector<Token> tokens;
+    if (!tokenize(sql, &tokens, error)) {
+        return false;
+    }
+
+    // 去掉结尾分号，语句中间不允许分号
+    while (!tokens.empty() && isPunct(tokens.back(), ';')) {
+        tokens.pop_back();
+    }
+    if (tokens.empty()) {
+        if (error) *error = "empty statement";
+        return false;
+    }
+
+    size_t first = 0;
+    while (first < tokens.size() && isPunct(tokens[first], '(')) ++first;
+    if (first == tokens.size() ||
+        !(isWord(tokens[first], "select") ||
+          (first == 0 && isWord(tokens[first], "with")))) {
+        if (error) *error = "statement must start with SELECT or WITH";
+        return false;
+    }
+
+    // 第一遍：括号配对、禁用词、CTE与别名声明
+    std::unordered_set<std::string> ctes;
+    std::unordered_set<std::string> aliases;
+    int depth = 0;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const Token& t = tokens[i];
+        if (t.kind == Token::PUNCT) {
+            if (t.text[0] == '(') ++depth;
+            if (t.text[0] == ')' && --depth < 0) {
+                if (error) *error = "unbalanced parentheses";
+                return false;
+            }
+            if (t.text[0] == ';') {
+                if (error) *error = "multiple statements are not allowed";
+                return false;
+            }
+            continue;
+        }
+        if (t.kind != Token::WORD) continue;
+        if (contains(kForbidden, t.text)) {
+            if (error) *error = "forbidden keyword '" + t.text + "'";
+            return false;
+        }
+        if (contains(kKeywords, t.text) || contains(kFunctions, t.text)) {
+            continue;
+        }
+
+        // name AS ( ... ) 为CTE声明
+        if (i + 2 < tokens.size() && isWord(tokens[i + 1], "as") &&
+            isPunct(tokens[i + 2], '(')) {
+            if (t.text.compare(0, 4, "cte_") != 0) {
+                if (error) *error = "CTE name '" + t.text + "' must start with cte_";
+                return false;
+            }
+            ctes.insert(t.text);
+            continue;
+        }
+
+        // AS之后、或紧跟在一个完整项之后的标识符是别名
+        if (i > 0) {
+            const Token& prev = tokens[i - 1];
+            const bool after_as = isWord(prev, "as");
+            const bool after_term =
+                prev.kind == Token::NUMBER || prev.kind == Token::STRING ||
+                isPunct(prev, ')') || isWord(prev, "end") ||
+                (prev.kind == Token::WORD && !contains(kKeywords, prev.text) &&
+                 !contains(kFunctions, prev.text) &&
+                 !(i >= 2 && isWord(tokens[i - 2], "as")));
+            const bool qualifier_part =
+                (i + 1 < tokens.size() && isPunct(tokens[i + 1], '.')) ||
+                isPunct(prev, '.');
+            if ((after_as || after_term) && !qualifier_part) {
+                aliases.insert(t.text);
+            }
+        }
+    }
+    if (depth != 0) {
+        if (error) *error = "unbalanced parentheses";
+        return false;
+    }
+
+    // 第二遍：表引用、限定列引用与无限定标识符
+    std::vector<bool> in_from(1, false);
+    std::vector<bool> in_extract(1, false);  // EXTRACT(unit FROM expr)中的FROM不引出表
+    bool expect_table = false;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const Token& t = tokens[i];
+        if (t.kind == Token::PUNCT) {
+            const char c = t.text[0];
+            if (c == '(') {
+                in_from.push_back(false);
+                in_extract.push_back(i > 0 && isWord(tokens[i - 1], "extract"));
+            } else if (c == ')') {
+                in_from.pop_back();
+                in_extract.pop_back();
+            } else if (c == ',' && in_from.back()) {
+                expect_table = true;
+                continue;
+            }
+            expect_table = false;
+            continue;
+        }
+        if (t.kind != Token::WORD) {
+            expect_table = false;
+            continue;
+        }
+
+        const std::string& w = t.text;
+        if (contains(kKeywords, w)) {
+            if (w == "from" && !in_extract.back()) {
+                in_from.back() = true;
+                expect_table = true;
+            } else if (w == "join") {
+                expect_table = true;
+            } else {
+                if (w == "where" || w == "group" || w == "having" ||
+                    w == "order" || w == "limit" || w == "union" ||
+                    w == "intersect" || w == "except" || w == "on") {
+                    in_from.back() = false;
+                }
+                expect_table = false;
+            }
+            continue;
+        }
+
+        const bool next_is_paren = i + 1 < tokens.size() && isPunct(tokens[i + 1], '(');
+        const bool next_is_dot = i + 1 < tokens.size() && isPunct(tokens[i + 1], '.');
+
+        if (expect_table) {
+            expect_table = false;
+            if (!tables_.empty() && !tables_.count(w) && !ctes.count(w)) {
+                if (error) *error = "unknown table '" + w + "'";
+                return false;
+            }
+            continue;
+        }
+
+        if (next_is_paren) {
+            if (!contains(kFunctions, w) && !ctes.count(w)) {
+                if (error) *error = "unsupported function '" + w + "'";
+                return false;
+            }
+            continue;
+        }
+
+        if (next_is_dot) {
+            if (!tables_.count(w) && !aliases.count(w) && !ctes.count(w)) {
+                if (error) *error = "unknown qualifier '" + w + "'";
+                return false;
+            }
+            if (i + 2 < tokens.size()) {
+                const Token& col = tokens[i + 2];
+                if (col.kind == Token::WORD && !columns_.empty() &&
+                    !columns_.count(col.text) && !aliases.count(col.text)) {
+                    if (error) *error = "unknown column '" + w + "." + col.text + "'";
+                    return false;
+                }
+                if (col.kind != Token::WORD && !isPunct(col, '*')) {
+                    if (error) *error = "malformed column reference";
+                    return false;
+                }
+            }
+            i += 2;
+            continue;
+        }
+
+        if (!columns_.empty() && !columns_.count(w) && !aliases.count(w) &&
+            !ctes.count(w)) {
+            if (error) *error = "unknown identifier '" + w + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace llm
+} // namespace heimdall
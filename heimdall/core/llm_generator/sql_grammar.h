@@ -0,0 +1,67 @@
+/**
+ * @file sql_grammar.h
+ * @brief 面向约束解码的SELECT语句语法
+ */
+
+#ifndef HEIMDALL_SQL_GRAMMAR_H
+#define HEIMDALL_SQL_GRAMMAR_H
+
+#include "prompt_builder.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 限定于已知Schema标识符的SELECT语法
+ *
+ * 覆盖分析型查询常用的CAST、EXTRACT、INTERVAL、DATE '...'字面量与
+ * 窗口函数OVER (PARTITION BY ... ORDER BY ... ROWS ...)。
+ *
+ * 同一份语法有两种用法：
+ * - gbnf()：GBNF文本，发送给支持语法约束解码的本地模型服务端，
+ *   使模型只能输出可解析的SELECT语句；
+ * - accepts()：进程内校验，供不支持约束解码的进程内提供商或
+ *   生成后过滤使用，规则与GBNF一致。
+ *
+ * 约定：关键字、表名与列名不区分大小写（GBNF中逐字母写成[xX]字符类）；
+ * 表名只能是Schema中的表或以"cte_"开头的CTE；
+ * 带限定的列引用（x.col）中的列必须是Schema中的列。GBNF无法表达
+ * "先声明后使用"，因此无限定标识符在GBNF中允许任意别名，
+ * accepts()额外检查它是已知列或已声明的别名。
+ */
+class SqlGrammar {
+public:
+    /**
+     * @brief 根据Schema构建SELECT语法
+     */
+    static std::shared_ptr<const SqlGrammar> forSelect(
+        const std::vector<TableSchema>& schemas);
+
+    /**
+     * @brief GBNF格式的语法文本
+     */
+    const std::string& gbnf() const { return gbnf_; }
+
+    /**
+     * @brief 检查SQL是否符合该语法
+     * @param error 可选，不符合时写入原因
+     */
+    bool accepts(std::string_view sql, std::string* error = nullptr) const;
+
+private:
+    SqlGrammar() = default;
+
+    std::string gbnf_;
+    std::unordered_set<std::string> tables_;   // 小写表名
+    std::unordered_set<std::string> columns_;  // 小写列名
+};
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
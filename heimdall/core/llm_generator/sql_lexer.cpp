@@ -0,0 +1,274 @@
+/**
+ * @file sql_lexer.cpp
+ * @brief SQL词法扫描器实现
+ */
+
+#include "sql_lexer.h"
+#include <algorithm>
+
+namespace heimdall {
+namespace llm {
+
+namespace {
+
+constexpr size_t kMaxKeywordLength = 13;
+
+struct KeywordEntry {
+    std::string_view text;
+    SqlKeyword keyword;
+};
+
+// 按text排序，同一首字母的关键字相邻
+constexpr KeywordEntry kKeywordTable[] = {
+    {"all", SqlKeyword::ALL},
+    {"and", SqlKeyword::AND},
+    {"as", SqlKeyword::AS},
+    {"asc", SqlKeyword::ASC},
+    {"between", SqlKeyword::BETWEEN},
+    {"by", SqlKeyword::BY},
+    {"case", SqlKeyword::CASE},
+    {"cast", SqlKeyword::CAST},
+    {"check", SqlKeyword::CHECK},
+    {"constraint", SqlKeyword::CONSTRAINT},
+    {"cross", SqlKeyword::CROSS},
+    {"delete", SqlKeyword::DELETE},
+    {"desc", SqlKeyword::DESC},
+    {"distinct", SqlKeyword::DISTINCT},
+    {"else", SqlKeyword::ELSE},
+    {"end", SqlKeyword::END},
+    {"except", SqlKeyword::EXCEPT},
+    {"exists", SqlKeyword::EXISTS},
+    {"extract", SqlKeyword::EXTRACT},
+    {"foreign", SqlKeyword::FOREIGN},
+    {"from", SqlKeyword::FROM},
+    {"full", SqlKeyword::FULL},
+    {"fulltext", SqlKeyword::FULLTEXT},
+    {"group", SqlKeyword::GROUP},
+    {"having", SqlKeyword::HAVING},
+    {"in", SqlKeyword::IN},
+    {"index", SqlKeyword::INDEX},
+    {"inner", SqlKeyword::INNER},
+    {"insert", SqlKeyword::INSERT},
+    {"intersect", SqlKeyword::INTERSECT},
+    {"interval", SqlKeyword::INTERVAL},
+    {"into", SqlKeyword::INTO},
+    {"is", SqlKeyword::IS},
+    {"join", SqlKeyword::JOIN},
+    {"key", SqlKeyword::KEY},
+    {"left", SqlKeyword::LEFT},
+    {"like", SqlKeyword::LIKE},
+    {"limit", SqlKeyword::LIMIT},
+    {"natural", SqlKeyword::NATURAL},
+    {"not", SqlKeyword::NOT},
+    {"offset", SqlKeyword::OFFSET},
+    {"on", SqlKeyword::ON},
+    {"or", SqlKeyword::OR},
+    {"order", SqlKeyword::ORDER},
+    {"outer", SqlKeyword::OUTER},
+    {"over", SqlKeyword::OVER},
+    {"partition", SqlKeyword::PARTITION},
+    {"primary", SqlKeyword::PRIMARY},
+    {"references", SqlKeyword::REFERENCES},
+    {"replace", SqlKeyword::REPLACE},
+    {"right", SqlKeyword::RIGHT},
+    {"select", SqlKeyword::SELECT},
+    {"set", SqlKeyword::SET},
+    {"spatial", SqlKeyword::SPATIAL},
+    {"straight", SqlKeyword::STRAIGHT},
+    {"straight_join", SqlKeyword::STRAIGHT_JOIN},
+    {"then", SqlKeyword::THEN},
+    {"union", SqlKeyword::UNION},
+    {"unique", SqlKeyword::UNIQUE},
+    {"update", SqlKeyword::UPDATE},
+    {"using", SqlKeyword::USING},
+    {"value", SqlKeyword::VALUE},
+    {"values", SqlKeyword::VALUES},
+    {"when", SqlKeyword::WHEN},
+    {"where", SqlKeyword::WHERE},
+    {"window", SqlKeyword::WINDOW},
+    {"with", SqlKeyword::WITH},
+};
+
+constexpr size_t kKeywordCount = sizeof(kKeywordTable) / sizeof(kKeywordTable[0]);
+
+/**
+ * @brief 按首字母划分的关键字区间，查找时只比较同一首字母的少数几项
+ */
+struct KeywordBuckets {
+    uint8_t begin[27] = {};
+
+    constexpr KeywordBuckets() {
+        size_t k = 0;
+        for (int letter = 0; letter < 26; ++letter) {
+            begin[letter] = static_cast<uint8_t>(k);
+            while (k < kKeywordCount && kKeywordTable[k].text[0] == 'a' + letter) ++k;
+        }
+        begin[26] = static_cast<uint8_t>(k);
+    }
+};
+
+constexpr KeywordBuckets kBuckets;
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+           c == '\f' || c == '\v';
+}
+
+} // namespace
+
+SqlKeyword lookupKeyword(std::string_view word) {
+    if (word.size() < 2 || word.size() > kMaxKeywordLength) {
+        return SqlKeyword::NONE;
+    }
+    char buf[kMaxKeywordLength];
+    for (size_t k = 0; k < word.size(); ++k) {
+        buf[k] = toLowerAscii(word[k]);
+    }
+    const int letter = buf[0] - 'a';
+    if (letter < 0 || letter >= 26) {
+        return SqlKeyword::NONE;
+    }
+    const std::string_view lower(buf, word.size());
+    for (size_t k = kBuckets.begin[letter]; k < kBuckets.begin[letter + 1]; ++k) {
+        if (kKeywordTable[k].text == lower) {
+            return kKeywordTable[k].keyword;
+        }
+    }
+    return SqlKeyword::NONE;
+}
+
+bool SqlLexer::next(SqlToken& token) {
+    const size_t n = sql_.size();
+    bool space = false;
+    while (pos_ < n) {
+        const char c = sql_[pos_];
+        if (isSpace(c)) {
+            space = true;
+            ++pos_;
+        } else if ((c == '-' && pos_ + 1 < n && sql_[pos_ + 1] == '-') || c == '#') {
+            while (pos_ < n && sql_[pos_] != '\n') ++pos_;
+            space = true;
+            ++comments_;
+        } else if (c == '/' && pos_ + 1 < n && sql_[pos_ + 1] == '*') {
+            const size_t end = sql_.find("*/", pos_ + 2);
+            pos_ = end == std::string_view::npos ? n : end + 2;
+            space = true;
+            ++comments_;
+        } else {
+            break;
+        }
+    }
+
+    token.space_before = space;
+    token.offset = pos_;
+    token.terminated = true;
+    token.escaped = false;
+    if (pos_ >= n) {
+        token.type = SqlTokenType::END;
+        token.text = std::string_view();
+        return false;
+    }
+
+    const size_t start = pos_;
+    const char c = sql_[pos_];
+    if (c == '\'' || c == '"') {
+        token.type = SqlTokenType::STRING;
+        token.terminated = false;
+        ++pos_;
+        while (pos_ < n) {
+            if (sql_[pos_] == '\\') {
+                token.escaped = true;
+                pos_ += 2;
+            } else if (sql_[pos_] == c) {
+                if (pos_ + 1 < n && sql_[pos_ + 1] == c) {
+                    pos_ += 2;
+                } else {
+                    ++pos_;
+                    token.terminated = true;
+                    break;
+                }
+            } else {
+                ++pos_;
+            }
+        }
+        pos_ = std::min(pos_, n);
+        token.text = sql_.substr(start, pos_ - start);
+        return true;
+    }
+    if (c == '`') {
+        token.type = SqlTokenType::QUOTED_IDENTIFIER;
+        token.terminated = false;
+        ++pos_;
+        size_t end = n;
+        while (pos_ < n) {
+            if (sql_[pos_] == '`') {
+                if (pos_ + 1 < n && sql_[pos_ + 1] == '`') {
+                    pos_ += 2;
+                    continue;
+                }
+                end = pos_++;
+                token.terminated = true;
+                break;
+            }
+            ++pos_;
+        }
+        token.text = sql_.substr(start + 1, end - start - 1);
+        return true;
+    }
+    if (isDigit(c) || (c == '.' && pos_ + 1 < n && isDigit(sql_[pos_ + 1]))) {
+        token.type = SqlTokenType::NUMBER;
+        ++pos_;
+        while (pos_ < n) {
+            const char d = sql_[pos_];
+            if (isSqlWordChar(d) || d == '.') {
+                ++pos_;
+            } else if ((d == '+' || d == '-') &&
+                       (sql_[pos_ - 1] == 'e' || sql_[pos_ - 1] == 'E') &&
+                       pos_ + 1 < n && isDigit(sql_[pos_ + 1])) {
+                ++pos_;
+            } else {
+                break;
+            }
+        }
+        token.text = sql_.substr(start, pos_ - start);
+        return true;
+    }
+    if (isSqlWordChar(c)) {
+        token.type = SqlTokenType::WORD;
+        while (pos_ < n && isSqlWordChar(sql_[pos_])) ++pos_;
+        token.text = sql_.substr(start, pos_ - start);
+        return true;
+    }
+    token.type = SqlTokenType::PUNCT;
+    token.text = sql_.substr(start, 1);
+    ++pos_;
+    return true;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (toLowerAscii(a[i]) != toLowerAscii(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view firstIdentifier(std::string_view text) {
+    SqlLexer lexer(text);
+    SqlToken token;
+    while (lexer.next(token)) {
+        if (token.isIdentifier()) {
+            return token.text;
+        }
+    }
+    return std::string_view();
+}
+
+} // namespace llm
+} // namespace heimdall
@@ -0,0 +1,143 @@
+/**
+ * @file sql_lexer.h
+ * @brief 各模块共用的SQL词法扫描器
+ */
+
+#ifndef HEIMDALL_SQL_LEXER_H
+#define HEIMDALL_SQL_LEXER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace heimdall {
+namespace llm {
+
+/**
+ * @brief 记号类型
+ */
+enum class SqlTokenType {
+    END,                // 输入结束
+    WORD,               // 未加引号的关键字或标识符
+    QUOTED_IDENTIFIER,  // `name`，text为反引号内原文（``未还原）
+    STRING,             // '...'或"..."，text含引号
+    NUMBER,             // 数值字面量（含小数、指数与十六进制）
+    PUNCT               // 单个符号字符，多字符运算符逐字符给出
+};
+
+/**
+ * @brief 各扫描方需要识别的关键字
+ */
+enum class SqlKeyword : uint8_t {
+    NONE,
+    ALL, AND, AS, ASC, BETWEEN, BY, CASE, CAST, CHECK, CONSTRAINT, CROSS,
+    DELETE, DESC, DISTINCT, ELSE, END, EXCEPT, EXISTS, EXTRACT, FOREIGN, FROM,
+    FULL, FULLTEXT, GROUP, HAVING, IN, INDEX, INNER, INSERT, INTERSECT, INTERVAL,
+    INTO, IS, JOIN, KEY, LEFT, LIKE, LIMIT, NATURAL, NOT, OFFSET, ON, OR,
+    ORDER, OUTER, OVER, PARTITION, PRIMARY, REFERENCES, REPLACE, RIGHT, SELECT,
+    SET, SPATIAL, STRAIGHT, STRAIGHT_JOIN, THEN, UNION, UNIQUE, UPDATE,
+    USING, VALUE, VALUES, WHEN, WHERE, WINDOW, WITH,
+};
+
+/**
+ * @brief 不区分大小写地查找关键字，不是关键字时返回NONE
+ */
+SqlKeyword lookupKeyword(std::string_view word);
+
+/**
+ * @brief 词法记号，text为指向原SQL的视图
+ */
+struct SqlToken {
+    SqlTokenType type = SqlTokenType::END;
+    std::string_view text;
+    size_t offset = 0;          // 记号（含引号）在SQL中的起始位置
+    bool space_before = false;  // 与前一记号之间有空白或注释
+    bool terminated = true;     // STRING/QUOTED_IDENTIFIER有结束引号
+    bool escaped = false;       // STRING中出现反斜杠转义
+
+    bool isPunct(char c) const {
+        return type == SqlTokenType::PUNCT && text[0] == c;
+    }
+
+    bool isIdentifier() const {
+        return type == SqlTokenType::WORD || type == SqlTokenType::QUOTED_IDENTIFIER;
+    }
+
+    bool isLiteral() const {
+        return type == SqlTokenType::STRING || type == SqlTokenType::NUMBER;
+    }
+
+    /**
+     * @brief WORD记号对应的关键字，其余类型为NONE
+     */
+    SqlKeyword keyword() const {
+        return type == SqlTokenType::WORD ? lookupKeyword(text) : SqlKeyword::NONE;
+    }
+
+    bool is(SqlKeyword kw) const { return keyword() == kw; }
+};
+
+/**
+ * @brief MySQL方言的单遍词法扫描器
+ *
+ * 跳过空白与注释（--、#与C风格块注释），字符串支持反斜杠转义与重复引号，
+ * 反引号标识符支持``转义；双引号按MySQL默认模式视为字符串。
+ * 以数字或".数字"开头的连续字符为数值字面量（"1e-5"、"0x1F"为一个记号）。
+ * 不分配内存、可复制：复制一份再调用next()即为向前看。
+ */
+class SqlLexer {
+public:
+    explicit SqlLexer(std::string_view sql) : sql_(sql) {}
+
+    /**
+     * @brief 读取下一个记号，到达结尾时token.type为END并返回false
+     */
+    bool next(SqlToken& token);
+
+    /**
+     * @brief 下一个记号，不移动位置
+     */
+    SqlToken peek() const {
+        SqlLexer copy(*this);
+        SqlToken token;
+        copy.next(token);
+        return token;
+    }
+
+    /**
+     * @brief 已读记号之后的位置
+     */
+    size_t position() const { return pos_; }
+
+    /**
+     * @brief 已跳过的注释数
+     */
+    size_t commentCount() const { return comments_; }
+
+private:
+    std::string_view sql_;
+    size_t pos_ = 0;
+    size_t comments_ = 0;
+};
+
+inline bool isSqlWordChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_' || c == '$' ||
+           static_cast<unsigned char>(c) >= 0x80;
+}
+
+inline char toLowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+/**
+ * @brief 文本中第一个标识符（反引号名去掉引号），如列描述"name TYPE"中的name
+ */
+std::string_view firstIdentifier(std::string_view text);
+
+} // namespace llm
+} // namespace heimdall
+
+#endif
@@ -0,0 +1,181 @@
+/**
+ * @file background_optimizer.cpp
+ * @brief 后台优化队列实现
+ */
+
+#include "background_optimizer.h"
+#include <algorithm>
+#include <utility>
+
+namespace heimdall {
+namespace optimizer {
+
+BackgroundOptimizer::BackgroundOptimizer(OptimizeFunction optimize,
+                                         const AsyncOptimizationConfig& config)
+    : optimize_(std::move(optimize)),
+      config_(config),
+      running_(false),
+      stats_{} {}
+
+BackgroundOptimizer::~BackgroundOptimizer() {
+    stop();
+}
+
+void BackgroundOptimizer::start() {
+    bool expected = false;
+    if (!running_.compare_exchange_strong(expected, true)) {
+        return;
+    }
+    const size_t count = std::max<size_t>(1, config_.workers);
+    for (size_t i = 0; i < count; ++i) {
+        workers_.emplace_back(&BackgroundOptimizer::loop, this);
+    }
+}
+
+void BackgroundOptimizer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.exchange(false)) {
+            return;
+        }
+    }
+    wakeup_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+}
+
+bool BackgroundOptimizer::enqueue(uint64_t digest, const std::string& sql) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (inflight_.count(digest)) {
+            ++stats_.duplicates;
+            return false;
+        }
+        auto failed = failed_.find(digest);
+        if (failed != failed_.end()) {
+            if (std::chrono::steady_clock::now() - failed->second < config_.retry_after) {
+                ++stats_.dropped;
+                return false;
+            }
+            failed_.erase(failed);    // failed_order_中的旧项过期时跳过
+        }
+        if (queue_.size() >= std::max<size_t>(1, config_.queue_capacity)) {
+            ++stats_.dropped;
+            return false;
+        }
+        queue_.push_back(Task{digest, sql});
+        inflight_.insert(digest);
+        ++stats_.enqueued;
+    }
+    wakeup_.notify_one();
+    return true;
+}
+
+bool BackgroundOptimizer::popLocked(Task* task) {
+    if (queue_.empty()) {
+        return false;
+    }
+    *task = std::move(queue_.front());
+    queue_.pop_front();
+    return true;
+}
+
+void BackgroundOptimizer::recordFailureLocked(uint64_t digest) {
+    const auto now = std::chrono::steady_clock::now();
+    failed_[digest] = now;
+    failed_order_.emplace_back(digest, now);
+    const size_t limit = std::max<size_t>(1, config_.max_failed_entries);
+    while (!failed_order_.empty()) {
+        const auto& oldest = failed_order_.front();
+        auto it = failed_.find(oldest.first);
+        const bool current = it != failed_.end() && it->second == oldest.second;
+        if (current && now - oldest.second < config_.retry_after &&
+            failed_.size() <= limit) {
+            break;
+        }
+        if (current) {
+            failed_.erase(it);
+        }
+        failed_order_.pop_front();
+    }
+}
+
+bool BackgroundOptimizer::process(const Task& task) {
+    bool ok = false;
+    try {
+        ok = optimize_ && optimize_(task.sql);
+    } catch (...) {
+        ok = false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    inflight_.erase(task.digest);
+    if (ok) {
+        ++stats_.optimized;
+    } else {
+        ++stats_.failed;
+        recordFailureLocked(task.digest);
+    }
+    return ok;
+}
+
+void BackgroundOptimizer::loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wakeup_.wait(lock, [this] { return !running_.load() || !queue_.empty(); });
+        if (!running_.load()) {
+            break;
+        }
+        Task task;
+        if (!popLocked(&task)) {
+            continue;
+        }
+        lock.unlock();
+        process(task);
+        lock.lock();
+    }
+}
+
+size_t BackgroundOptimizer::drain() {
+    size_t optimized = 0;
+    while (true) {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!popLocked(&task)) {
+                break;
+            }
+        }
+        if (process(task)) {
+            ++optimized;
+        }
+    }
+    return optimized;
+}
+
+bool BackgroundOptimizer::tracking(uint64_t digest) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (inflight_.count(digest)) {
+        return true;
+    }
+    auto failed = failed_.find(digest);
+    return failed != failed_.end() &&
+           std::chrono::steady_clock::now() - failed->second < config_.retry_after;
+}
+
+size_t BackgroundOptimizer::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+BackgroundOptimizer::Stats BackgroundOptimizer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace optimizer
+} // namespace heimdall
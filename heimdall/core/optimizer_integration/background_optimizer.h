@@ -0,0 +1,124 @@
+/**
+ * @file background_optimizer.h
+ * @brief 分层优化：首次执行走原计划，后台生成重写
+ */
+
+#ifndef HEIMDALL_BACKGROUND_OPTIMIZER_H
+#define HEIMDALL_BACKGROUND_OPTIMIZER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace heimdall {
+namespace optimizer {
+
+/**
+ * @brief 后台优化配置
+ */
+struct AsyncOptimizationConfig {
+    size_t queue_capacity;              // 待优化队列上限，满时丢弃新请求
+    size_t workers;                     // 后台线程数
+    std::chrono::seconds retry_after;   // 优化失败的模板在此期间不再入队
+    size_t max_failed_entries;          // 失败记录上限，超出时先淘汰最早的记录
+
+    AsyncOptimizationConfig()
+        : queue_capacity(256),
+          workers(1),
+          retry_after(3600),
+          max_failed_entries(4096) {}
+};
+
+/**
+ * @brief 后台优化队列
+ *
+ * 查询路径只调用enqueue()：按模板摘要去重后放入有界队列并立即返回，
+ * 不等待LLM。后台线程依次对队列中的SQL调用optimize回调（通常是完整的
+ * 生成-验证-代价比较流程，成功时写入RewriteCache），同一模板的后续执行
+ * 从RewriteCache取得重写。
+ *
+ * 回调返回false或抛出异常都记为失败，该模板retry_after内不再入队。
+ * 失败记录按失败时间先后过期，总数不超过max_failed_entries。
+ */
+class BackgroundOptimizer {
+public:
+    using OptimizeFunction = std::function<bool(const std::string& sql)>;
+
+    explicit BackgroundOptimizer(OptimizeFunction optimize,
+                                 const AsyncOptimizationConfig& config = AsyncOptimizationConfig());
+    ~BackgroundOptimizer();
+
+    BackgroundOptimizer(const BackgroundOptimizer&) = delete;
+    BackgroundOptimizer& operator=(const BackgroundOptimizer&) = delete;
+
+    void start();
+    void stop();
+    bool isRunning() const { return running_.load(); }
+
+    /**
+     * @brief 提交一个模板，已在队列中、正在优化或近期失败时忽略
+     * @return 是否新加入队列
+     */
+    bool enqueue(uint64_t digest, const std::string& sql);
+
+    /**
+     * @brief 在调用线程上处理完当前队列，返回成功优化的模板数
+     */
+    size_t drain();
+
+    /**
+     * @brief 模板是否在排队、处理中或retry_after内失败过，此时enqueue()会忽略它
+     */
+    bool tracking(uint64_t digest) const;
+
+    size_t pending() const;
+
+    struct Stats {
+        uint64_t enqueued;
+        uint64_t duplicates;     // 已在队列/处理中而被忽略
+        uint64_t dropped;        // 队列满或近期失败而被丢弃
+        uint64_t optimized;
+        uint64_t failed;
+    };
+    Stats getStats() const;
+
+private:
+    struct Task {
+        uint64_t digest;
+        std::string sql;
+    };
+
+    OptimizeFunction optimize_;
+    AsyncOptimizationConfig config_;
+
+    std::atomic<bool> running_;
+    std::vector<std::thread> workers_;
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::deque<Task> queue_;
+    std::unordered_set<uint64_t> inflight_;  // 排队中或处理中的摘要
+    std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> failed_;
+    // 按失败时间排序的(摘要, 时间)，与failed_中时间不同的项已被后来的失败取代
+    std::deque<std::pair<uint64_t, std::chrono::steady_clock::time_point>> failed_order_;
+    Stats stats_;
+
+    bool popLocked(Task* task);
+    void recordFailureLocked(uint64_t digest);
+    bool process(const Task& task);
+    void loop();
+};
+
+} // namespace optimizer
+} // namespace heimdall
+
+#endif
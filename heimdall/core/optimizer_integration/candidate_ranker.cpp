@@ -0,0 +1,90 @@
+/**
+ * @file candidate_ranker.cpp
+ * @brief 候选预排序实现
+ */
+
+#include "candidate_ranker.h"
+#include "query_fingerprint.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace heimdall {
+namespace optimizer {
+
+CandidateRanker::CandidateRanker(RowEstimator estimator,
+                                 const RankingWeights& weights)
+    : estimator_(std::move(estimator)), weights_(weights) {}
+
+std::vector<RankedCandidate> CandidateRanker::rank(
+    std::string_view original_sql,
+    const std::vector<std::string_view>& candidates,
+    size_t top_k) const {
+    std::vector<RankedCandidate> ranked;
+    ranked.reserve(candidates.size());
+
+    const Profile original = profile(original_sql);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        ranked.push_back({i, score(original, profile(candidates[i]))});
+    }
+
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const RankedCandidate& a, const RankedCandidate& b) {
+                         return a.score > b.score;
+                     });
+    if (top_k > 0 && ranked.size() > top_k) {
+        ranked.resize(top_k);
+    }
+    return ranked;
+}
+
+CandidateRanker::Profile CandidateRanker::profile(std::string_view sql) const {
+    Profile p;
+    p.log_rows = 0.0;
+    if (estimator_) {
+        TableVisitor visitor = [this, &p](std::string_view table) {
+            const double rows = estimator_(table);
+            if (rows > 0.0) {
+                p.log_rows += std::log10(rows + 1.0);
+            }
+        };
+        p.features = extractQueryFeatures(sql, &visitor);
+    } else {
+        p.features = extractQueryFeatures(sql);
+    }
+    p.digest = computeQueryDigest(sql);
+    return p;
+}
+
+double CandidateRanker::score(const Profile& original,
+                              const Profile& candidate) const {
+    const QueryFeatures& o = original.features;
+    const QueryFeatures& c = candidate.features;
+
+    // 语句类型改变的候选不可能通过验证，排到最后
+    if (c.statement_type != o.statement_type) {
+        return -std::numeric_limits<double>::infinity();
+    }
+
+    double s = 0.0;
+    if (candidate.digest == original.digest) {
+        s += weights_.unchanged_template;
+    }
+
+    s += weights_.removed_subquery * (o.subquery_count - c.subquery_count);
+    s += weights_.removed_in_subquery *
+         ((o.in_subquery_count + o.exists_count) -
+          (c.in_subquery_count + c.exists_count));
+    s += weights_.added_join * std::max(0, c.join_count - o.join_count);
+    s += weights_.added_distinct * std::max(0, c.distinct_count - o.distinct_count);
+    s += weights_.added_union * std::max(0, c.union_count - o.union_count);
+
+    if (estimator_) {
+        s += weights_.scanned_rows * (original.log_rows - candidate.log_rows);
+    }
+    return s;
+}
+
+} // namespace optimizer
+} // namespace heimdall
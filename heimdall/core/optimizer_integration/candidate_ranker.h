@@ -0,0 +1,90 @@
+/**
+ * @file candidate_ranker.h
+ * @brief 验证前的候选廉价预排序
+ */
+
+#ifndef HEIMDALL_CANDIDATE_RANKER_H
+#define HEIMDALL_CANDIDATE_RANKER_H
+
+#include "query_features.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <functional>
+
+namespace heimdall {
+namespace optimizer {
+
+/**
+ * @brief 预排序结果
+ */
+struct RankedCandidate {
+    size_t index;       // 候选在原列表中的下标
+    double score;       // 得分，越高越有希望
+};
+
+/**
+ * @brief 预排序权重
+ */
+struct RankingWeights {
+    double removed_subquery;     // 每消除一个子查询
+    double removed_in_subquery;  // 每消除一个IN/EXISTS子查询（额外加分）
+    double added_join;           // 每增加一个JOIN
+    double added_distinct;       // 每增加一个DISTINCT
+    double added_union;          // 每增加一个UNION
+    double scanned_rows;         // 扫描行数(log10)每减少一个数量级
+    double unchanged_template;   // 与原查询模板相同（没有实质改写）
+
+    RankingWeights()
+        : removed_subquery(3.0),
+          removed_in_subquery(1.0),
+          added_join(-0.5),
+          added_distinct(-0.5),
+          added_union(-1.0),
+          scanned_rows(2.0),
+          unchanged_template(-10.0) {}
+};
+
+/**
+ * @brief 基于形状特征的候选打分器
+ *
+ * 只做词法扫描和统计信息查表，开销远小于语义验证与代价估算。
+ * 排序用于决定验证/代价估算的先后顺序，与FIRST_VALID等提前退出的
+ * 选择策略配合可减少每次优化的本地工作量；只有指定top_k时才截去低分候选。
+ */
+class CandidateRanker {
+public:
+    /**
+     * @brief 表行数估计回调，未知时返回负数
+     */
+    using RowEstimator = std::function<double(std::string_view table_name)>;
+
+    explicit CandidateRanker(RowEstimator estimator = nullptr,
+                             const RankingWeights& weights = RankingWeights());
+
+    /**
+     * @brief 按得分降序排列候选，得分相同时保持原顺序
+     * @param top_k 大于0时只返回得分最高的top_k个，其余候选不再验证
+     */
+    std::vector<RankedCandidate> rank(
+        std::string_view original_sql,
+        const std::vector<std::string_view>& candidates,
+        size_t top_k = 0) const;
+
+private:
+    RowEstimator estimator_;
+    RankingWeights weights_;
+
+    struct Profile {
+        QueryFeatures features;
+        double log_rows;        // 所有表引用的log10(行数)之和
+        uint64_t digest;
+    };
+    Profile profile(std::string_view sql) const;
+    double score(const Profile& original, const Profile& candidate) const;
+};
+
+} // namespace optimizer
+} // namespace heimdall
+
+#endif
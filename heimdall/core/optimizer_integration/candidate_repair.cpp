@@ -0,0 +1,131 @@
+/**
+ * @file candidate_repair.cpp
+ * @brief 候选修复辅助函数实现
+ */
+
+#include "candidate_repair.h"
+#include "../llm_generator/budget_governor.h"
+
+namespace heimdall {
+namespace optimizer {
+
+namespace {
+
+// 超过该长度的差异通常是整棵子树不同，不属于"小而具体"的差异
+constexpr size_t kMaxDifferenceLength = 240;
+
+const char* const kPreviousAttemptHeader =
+    "\n\n## Previous Attempt\n```sql\n";
+
+const char* const kFeedbackHeader =
+    "\n```\n\n## Validator Feedback\n"
+    "The rewrite above is NOT semantically equivalent to the original query:\n";
+
+const char* const kRepairInstructions =
+    "\nFix only the listed differences and keep the rest of the rewrite unchanged.\n"
+    "Output ONLY the corrected SQL query inside a ```sql code block.";
+
+} // namespace
+
+bool isNearMiss(const validator::ValidationResult& validation,
+                int max_differences) {
+    if (validation.is_equivalent || validation.differences.empty()) {
+        return false;
+    }
+    if (max_differences <= 0 ||
+        validation.differences.size() > static_cast<size_t>(max_differences)) {
+        return false;
+    }
+    for (const auto& diff : validation.differences) {
+        if (diff.empty() || diff.size() > kMaxDifferenceLength) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string formatRepairFeedback(const validator::ValidationResult& validation,
+                                 int max_differences) {
+    std::string feedback;
+    int count = 0;
+    for (const auto& diff : validation.differences) {
+        if (count++ >= max_differences) {
+            break;
+        }
+        feedback += "- ";
+        feedback += diff;
+        feedback += '\n';
+    }
+    return feedback;
+}
+
+std::string buildRepairPrompt(const std::string& rewrite_prompt,
+                              std::string_view failed_candidate,
+                              const std::string& feedback) {
+    std::string prompt;
+    prompt.reserve(rewrite_prompt.size() + failed_candidate.size() +
+                   feedback.size() + 256);
+    prompt += rewrite_prompt;
+    prompt += kPreviousAttemptHeader;
+    prompt += failed_candidate;
+    prompt += kFeedbackHeader;
+    prompt += feedback;
+    prompt += kRepairInstructions;
+    return prompt;
+}
+
+RepairResult runRepairLoop(const std::string& rewrite_prompt,
+                           const std::vector<NearMiss>& near_misses,
+                           int max_rounds,
+                           int max_differences,
+                           const RepairGenerator& generate,
+                           const RepairValidator& validate) {
+    RepairResult result;
+    if (!generate || !validate) {
+        return result;
+    }
+
+    for (const auto& near_miss : near_misses) {
+        if (result.rounds >= max_rounds) {
+            break;
+        }
+        if (!isNearMiss(near_miss.validation, max_differences)) {
+            continue;
+        }
+
+        std::string conversation = rewrite_prompt;
+        std::string_view candidate = near_miss.candidate;
+        validator::ValidationResult validation = near_miss.validation;
+        while (result.rounds < max_rounds) {
+            std::string prompt = buildRepairPrompt(
+                conversation, candidate,
+                formatRepairFeedback(validation, max_differences));
+            ++result.rounds;
+            result.prompt_tokens += llm::BudgetGovernor::estimateTokens(prompt);
+
+            llm::LLMResponsePtr response = generate(prompt);
+            if (!response || !response->success || response->candidates.empty()) {
+                break;
+            }
+            result.completion_tokens +=
+                llm::BudgetGovernor::estimateTokens(response->raw_response);
+            result.responses.push_back(response);
+
+            candidate = response->candidates.front();
+            validation = validate(candidate);
+            if (validation.is_equivalent) {
+                result.repaired.push_back(candidate);
+                break;
+            }
+            if (!isNearMiss(validation, max_differences)) {
+                break;
+            }
+            // 下一轮以本轮完整Prompt为前缀，提供商可继续复用前缀缓存
+            conversation = std::move(prompt);
+        }
+    }
+    return result;
+}
+
+} // namespace optimizer
+} // namespace heimdall
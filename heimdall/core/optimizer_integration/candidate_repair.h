@@ -0,0 +1,95 @@
+/**
+ * @file candidate_repair.h
+ * @brief 验证未通过的"近似正确"候选的修复辅助函数
+ */
+
+#ifndef HEIMDALL_CANDIDATE_REPAIR_H
+#define HEIMDALL_CANDIDATE_REPAIR_H
+
+#include "../validator/semantic_validator.h"
+#include "../llm_generator/llm_response.h"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace heimdall {
+namespace optimizer {
+
+/**
+ * @brief 判断验证失败的候选是否值得修复
+ *
+ * 仅当差异列表非空、条数不超过max_differences且每条差异足够简短
+ * （例如"缺少谓词 ss_sales_price > 100"）时才视为近似正确；
+ * 解析失败或差异过多的候选直接丢弃。
+ */
+bool isNearMiss(const validator::ValidationResult& validation,
+                int max_differences);
+
+/**
+ * @brief 将验证器差异整理为简洁的修复反馈
+ */
+std::string formatRepairFeedback(const validator::ValidationResult& validation,
+                                 int max_differences);
+
+/**
+ * @brief 构建修复轮次的Prompt
+ *
+ * 以原始重写Prompt作为逐字节相同的前缀，追加失败候选与验证反馈，
+ * 使支持前缀缓存的提供商可以复用已计算的上下文。
+ */
+std::string buildRepairPrompt(const std::string& rewrite_prompt,
+                              std::string_view failed_candidate,
+                              const std::string& feedback);
+
+/**
+ * @brief 验证未通过但isNearMiss()成立的候选
+ */
+struct NearMiss {
+    std::string_view candidate;               // 指向生成响应缓冲的视图
+    validator::ValidationResult validation;
+};
+
+/**
+ * @brief 修复循环的结果
+ */
+struct RepairResult {
+    std::vector<std::string_view> repaired;        // 修复后验证通过的候选
+    std::vector<llm::LLMResponsePtr> responses;    // 持有repaired指向的缓冲
+    int rounds;                                    // 实际发出的修复请求数
+    size_t prompt_tokens;                          // 修复请求的估计token数
+    size_t completion_tokens;
+
+    RepairResult() : rounds(0), prompt_tokens(0), completion_tokens(0) {}
+};
+
+/**
+ * @brief 发送修复Prompt，返回为空或失败表示本轮没有结果
+ */
+using RepairGenerator = std::function<llm::LLMResponsePtr(const std::string& prompt)>;
+
+/**
+ * @brief 验证修复后的候选与原始SQL是否等价
+ */
+using RepairValidator =
+    std::function<validator::ValidationResult(std::string_view candidate)>;
+
+/**
+ * @brief 有界修复循环
+ *
+ * 按顺序处理near_misses：每轮把当前候选与验证差异追加在上一轮Prompt之后
+ * 发给LLM，取返回的第一个候选重新验证。验证通过即收下并处理下一个；
+ * 仍是近似正确则以新候选和新差异继续下一轮；差异变多、生成失败或没有候选
+ * 时放弃该候选。所有候选共享max_rounds轮上限，用完即停止。
+ */
+RepairResult runRepairLoop(const std::string& rewrite_prompt,
+                           const std::vector<NearMiss>& near_misses,
+                           int max_rounds,
+                           int max_differences,
+                           const RepairGenerator& generate,
+                           const RepairValidator& validate);
+
+} // namespace optimizer
+} // namespace heimdall
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * @file cost_cache.cpp
+ * @brief 代价估算缓存实现
+ */
+
+#include "cost_cache.h"
+#include <algorithm>
+
+namespace heimdall {
+namespace optimizer {
+
+CostCache::CostCache(const CostCacheConfig& config)
+    : config_(config),
+      stats_{} {
+    config_.max_entries = std::max<size_t>(1, config_.max_entries);
+}
+
+bool CostCache::lookup(uint64_t fingerprint, uint64_t stats_version, double* cost) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(fingerprint);
+    if (it == index_.end()) {
+        ++stats_.misses;
+        return false;
+    }
+    const Entry& entry = *it->second;
+    if (entry.stats_version != stats_version ||
+        (config_.ttl.count() > 0 && now - entry.created >= config_.ttl)) {
+        lru_.erase(it->second);
+        index_.erase(it);
+        ++stats_.misses;
+        ++stats_.stale;
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    *cost = entry.cost;
+    ++stats_.hits;
+    return true;
+}
+
+void CostCache::insert(uint64_t fingerprint, uint64_t stats_version, double cost) {
+    if (cost < 0) {
+        return;
+    }
+    const Entry entry{fingerprint, stats_version, cost, std::chrono::steady_clock::now()};
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(fingerprint);
+    if (it != index_.end()) {
+        *it->second = entry;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+    lru_.push_front(entry);
+    index_[fingerprint] = lru_.begin();
+    evictLocked();
+}
+
+void CostCache::evictLocked() {
+    while (lru_.size() > config_.max_entries) {
+        index_.erase(lru_.back().fingerprint);
+        lru_.pop_back();
+        ++stats_.evictions;
+    }
+}
+
+void CostCache::setConfig(const CostCacheConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    config_.max_entries = std::max<size_t>(1, config_.max_entries);
+    evictLocked();
+}
+
+size_t CostCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return index_.size();
+}
+
+void CostCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+}
+
+CostCache::Stats CostCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace optimizer
+} // namespace heimdall
@@ -0,0 +1,87 @@
+/**
+ * @file cost_cache.h
+ * @brief 按语句指纹与统计信息版本缓存代价估算结果
+ */
+
+#ifndef HEIMDALL_COST_CACHE_H
+#define HEIMDALL_COST_CACHE_H
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace heimdall {
+namespace optimizer {
+
+/**
+ * @brief 代价缓存配置
+ */
+struct CostCacheConfig {
+    size_t max_entries;
+    std::chrono::seconds ttl;   // 超过该时长的估算视为过期（0表示不过期）
+
+    CostCacheConfig()
+        : max_entries(50000),
+          ttl(600) {}
+};
+
+/**
+ * @brief 代价估算缓存
+ *
+ * 键为computeStatementFingerprint()得到的语句指纹，值记录估算时所用的
+ * 统计信息版本（语句引用各表stats_version的组合）。查询时版本不一致或
+ * 超过TTL均视为未命中并删除该条目，因此ANALYZE之后不会用到旧代价，
+ * 而统计信息未变化的数据分布漂移由TTL兜底。LRU淘汰，线程安全。
+ *
+ * 原始查询每次优化都要估算一次，重复出现的候选重写也会被反复估算；
+ * 对周期性出现的报表模板，命中后代价估算阶段几乎不再调用优化器。
+ */
+class CostCache {
+public:
+    explicit CostCache(const CostCacheConfig& config = CostCacheConfig());
+
+    /**
+     * @brief 查找代价，未命中返回false
+     */
+    bool lookup(uint64_t fingerprint, uint64_t stats_version, double* cost);
+
+    /**
+     * @brief 写入代价，负数（估算失败）不缓存
+     */
+    void insert(uint64_t fingerprint, uint64_t stats_version, double cost);
+
+    void setConfig(const CostCacheConfig& config);
+    size_t size() const;
+    void clear();
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t stale;        // 统计信息版本变化或过期导致的未命中
+        uint64_t evictions;
+    };
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        uint64_t fingerprint;
+        uint64_t stats_version;
+        double cost;
+        std::chrono::steady_clock::time_point created;
+    };
+
+    CostCacheConfig config_;
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  // 头部为最近使用
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+    Stats stats_;
+
+    void evictLocked();
+};
+
+} // namespace optimizer
+} // namespace heimdall
+
+#endif
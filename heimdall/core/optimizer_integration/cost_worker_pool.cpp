@@ -0,0 +1,121 @@
+/**
+ * @file cost_worker_pool.cpp
+ * @brief 并行代价估算工作线程池实现
+ */
+
+#include "cost_worker_pool.h"
+#include <algorithm>
+#include <utility>
+
+namespace heimdall {
+namespace optimizer {
+
+CostWorkerPool::CostWorkerPool(size_t workers,
+                               Estimator estimator,
+                               ContextFactory context_factory,
+                               ContextDeleter context_deleter)
+    : estimator_(std::move(estimator)),
+      context_factory_(std::move(context_factory)),
+      context_deleter_(std::move(context_deleter)),
+      running_(true),
+      stats_{} {
+    const size_t count = std::max<size_t>(1, workers);
+    threads_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        threads_.emplace_back(&CostWorkerPool::loop, this);
+    }
+}
+
+CostWorkerPool::~CostWorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.store(false);
+    }
+    wakeup_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+std::vector<double> CostWorkerPool::estimateAll(const std::vector<std::string_view>& sqls) {
+    if (sqls.empty()) {
+        return {};
+    }
+    auto batch = std::make_shared<Batch>();
+    batch->sqls.reserve(sqls.size());
+    for (auto sql : sqls) {
+        batch->sqls.emplace_back(sql);
+    }
+    batch->costs.assign(sqls.size(), -1.0);
+    batch->remaining = sqls.size();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.batches;
+        for (size_t i = 0; i < sqls.size(); ++i) {
+            queue_.push_back(Task{batch, i});
+        }
+    }
+    if (sqls.size() == 1) {
+        wakeup_.notify_one();
+    } else {
+        wakeup_.notify_all();
+    }
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->done.wait(lock, [&batch] { return batch->remaining == 0; });
+    return std::move(batch->costs);
+}
+
+void CostWorkerPool::loop() {
+    void* context = context_factory_ ? context_factory_() : nullptr;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wakeup_.wait(lock, [this] { return !running_.load() || !queue_.empty(); });
+        // 析构前所有estimateAll()都已返回，队列此时必为空
+        if (!running_.load() && queue_.empty()) {
+            break;
+        }
+        Task task = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+
+        double cost = -1.0;
+        if (estimator_) {
+            try {
+                cost = estimator_(task.batch->sqls[task.index], context);
+            } catch (...) {
+                cost = -1.0;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> batch_lock(task.batch->mutex);
+            task.batch->costs[task.index] = cost;
+            if (--task.batch->remaining == 0) {
+                task.batch->done.notify_all();
+            }
+        }
+
+        lock.lock();
+        ++stats_.estimates;
+        if (cost < 0) {
+            ++stats_.failures;
+        }
+    }
+    lock.unlock();
+
+    if (context && context_deleter_) {
+        context_deleter_(context);
+    }
+}
+
+CostWorkerPool::Stats CostWorkerPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace optimizer
+} // namespace heimdall
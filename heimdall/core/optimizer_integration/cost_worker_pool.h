@@ -0,0 +1,99 @@
+/**
+ * @file cost_worker_pool.h
+ * @brief 并行代价估算工作线程池
+ */
+
+#ifndef HEIMDALL_COST_WORKER_POOL_H
+#define HEIMDALL_COST_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace heimdall {
+namespace optimizer {
+
+/**
+ * @brief 代价估算线程池
+ *
+ * 代价估算需要会话级上下文（TXSQL中为THD），同一上下文不能被多个线程
+ * 同时使用。每个工作线程启动时在本线程内调用context_factory创建自己的
+ * 估算上下文，退出时交给context_deleter释放，此后只在该线程上使用。
+ *
+ * estimateAll()把一批SQL拆成单条任务放入共享队列，调用线程阻塞直到整批完成；
+ * 结果按输入顺序写回，与各任务完成的先后无关，因此后续按下标比较代价、
+ * 代价相同取下标较小者的选择结果与串行估算完全一致。
+ * 多个连接同时优化时，各批任务在同一队列中按提交顺序交替执行。
+ */
+class CostWorkerPool {
+public:
+    /**
+     * @brief 估算函数，返回负数表示估算失败
+     */
+    using Estimator = std::function<double(const std::string& sql, void* context)>;
+    using ContextFactory = std::function<void*()>;
+    using ContextDeleter = std::function<void(void*)>;
+
+    CostWorkerPool(size_t workers,
+                   Estimator estimator,
+                   ContextFactory context_factory = nullptr,
+                   ContextDeleter context_deleter = nullptr);
+    ~CostWorkerPool();
+
+    CostWorkerPool(const CostWorkerPool&) = delete;
+    CostWorkerPool& operator=(const CostWorkerPool&) = delete;
+
+    /**
+     * @brief 并行估算一批SQL的代价
+     * @return 与sqls一一对应的代价，估算失败或抛出异常的为-1
+     */
+    std::vector<double> estimateAll(const std::vector<std::string_view>& sqls);
+
+    size_t workers() const { return threads_.size(); }
+
+    struct Stats {
+        uint64_t batches;
+        uint64_t estimates;
+        uint64_t failures;
+    };
+    Stats getStats() const;
+
+private:
+    struct Batch {
+        std::vector<std::string> sqls;
+        std::vector<double> costs;
+        size_t remaining;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    struct Task {
+        std::shared_ptr<Batch> batch;
+        size_t index;
+    };
+
+    Estimator estimator_;
+    ContextFactory context_factory_;
+    ContextDeleter context_deleter_;
+
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_;
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::deque<Task> queue_;
+    Stats stats_;
+
+    void loop();
+};
+
+} // namespace optimizer
+} // namespace heimdall
+
+#endif
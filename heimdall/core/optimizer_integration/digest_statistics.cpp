@@ -0,0 +1,127 @@
+/**
+ * @file digest_statistics.cpp
+ * @brief 查询模板执行统计实现
+ */
+
+#include "digest_statistics.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace heimdall {
+namespace optimizer {
+
+DigestStatistics::DigestStatistics(size_t max_digests,
+                                   std::chrono::seconds half_life)
+    : max_digests_(std::max<size_t>(1, max_digests)),
+      half_life_sec_(static_cast<double>(std::max<std::chrono::seconds::rep>(1, half_life.count()))) {}
+
+double DigestStatistics::decayedHotness(
+    const DigestStats& stats, std::chrono::steady_clock::time_point now) const {
+    const double age = std::chrono::duration<double>(now - stats.last_seen).count();
+    return stats.hotness * std::exp2(-std::max(0.0, age) / half_life_sec_);
+}
+
+void DigestStatistics::record(uint64_t digest, const std::string& sql,
+                              double latency_ms) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = stats_.find(digest);
+    if (it == stats_.end()) {
+        if (stats_.size() >= max_digests_) {
+            pruneLocked(now);
+        }
+        DigestStats fresh;
+        fresh.digest = digest;
+        fresh.executions = 0;
+        fresh.total_latency_ms = 0.0;
+        fresh.hotness = 0.0;
+        fresh.last_seen = now;
+        it = stats_.emplace(digest, std::move(fresh)).first;
+    }
+
+    DigestStats& s = it->second;
+    s.hotness = decayedHotness(s, now) + latency_ms;
+    s.last_seen = now;
+    ++s.executions;
+    s.total_latency_ms += latency_ms;
+    if (s.sample_sql != sql) {
+        s.sample_sql = sql;
+    }
+}
+
+std::vector<DigestStats> DigestStatistics::hottest(
+    size_t k, double min_avg_latency_ms, uint64_t min_executions,
+    const std::function<bool(uint64_t)>& exclude) const {
+    std::vector<DigestStats> result;
+    if (k == 0) {
+        return result;
+    }
+    const auto now = std::chrono::steady_clock::now();
+
+    // 锁内只收集(热度, 摘要)，不复制SQL文本
+    std::vector<std::pair<double, uint64_t>> ranked;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ranked.reserve(stats_.size());
+        for (const auto& entry : stats_) {
+            const DigestStats& s = entry.second;
+            if (s.executions < min_executions ||
+                s.avgLatencyMs() < min_avg_latency_ms) {
+                continue;
+            }
+            ranked.emplace_back(decayedHotness(s, now), entry.first);
+        }
+    }
+
+    // 按热度从高到低逐个弹出，exclude可能访问其他加锁结构，放在锁外执行
+    std::vector<uint64_t> chosen;
+    std::make_heap(ranked.begin(), ranked.end());
+    while (!ranked.empty() && chosen.size() < k) {
+        std::pop_heap(ranked.begin(), ranked.end());
+        const uint64_t digest = ranked.back().second;
+        ranked.pop_back();
+        if (!exclude || !exclude(digest)) {
+            chosen.push_back(digest);
+        }
+    }
+
+    // 只复制选中的k个模板；期间被淘汰的跳过
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.reserve(chosen.size());
+    for (uint64_t digest : chosen) {
+        auto it = stats_.find(digest);
+        if (it == stats_.end()) continue;
+        result.push_back(it->second);
+        result.back().hotness = decayedHotness(it->second, now);
+    }
+    return result;
+}
+
+size_t DigestStatistics::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_.size();
+}
+
+void DigestStatistics::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.clear();
+}
+
+void DigestStatistics::pruneLocked(std::chrono::steady_clock::time_point now) {
+    std::vector<std::pair<double, uint64_t>> order;
+    order.reserve(stats_.size());
+    for (const auto& entry : stats_) {
+        order.emplace_back(decayedHotness(entry.second, now), entry.first);
+    }
+    const size_t drop = order.size() / 2 + 1;
+    std::nth_element(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(drop - 1),
+                     order.end());
+    for (size_t i = 0; i < drop && i < order.size(); ++i) {
+        stats_.erase(order[i].second);
+    }
+}
+
+} // namespace optimizer
+} // namespace heimdall
@@ -0,0 +1,78 @@
+/**
+ * @file digest_statistics.h
+ * @brief 按查询模板摘要聚合的执行统计
+ */
+
+#ifndef HEIMDALL_DIGEST_STATISTICS_H
+#define HEIMDALL_DIGEST_STATISTICS_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace heimdall {
+namespace optimizer {
+
+/**
+ * @brief 单个查询模板的执行统计
+ */
+struct DigestStats {
+    uint64_t digest;
+    std::string sample_sql;       // 最近一次执行的SQL文本
+    uint64_t executions;
+    double total_latency_ms;
+    double hotness;               // 按半衰期衰减的累计耗时，越大越"热"
+    std::chrono::steady_clock::time_point last_seen;
+
+    double avgLatencyMs() const {
+        return executions > 0 ? total_latency_ms / static_cast<double>(executions) : 0.0;
+    }
+};
+
+/**
+ * @brief 查询模板执行统计表
+ *
+ * 由执行路径调用record()累积，热度按半衰期指数衰减，
+ * 使最近频繁出现的慢查询排在前面。超过容量时淘汰最冷的一半。
+ */
+class DigestStatistics {
+public:
+    explicit DigestStatistics(size_t max_digests = 10000,
+                              std::chrono::seconds half_life = std::chrono::hours(1));
+
+    void record(uint64_t digest, const std::string& sql, double latency_ms);
+
+    /**
+     * @brief 返回最热的k个模板，按热度从高到低
+     *
+     * 锁内只收集符合条件模板的(热度, 摘要)，锁外按堆顺序逐个弹出并过滤，
+     * 最后只复制选中的k个模板的统计与SQL文本
+     * @param min_avg_latency_ms 平均耗时低于该值的模板不视为慢查询
+     * @param exclude 返回true的摘要被跳过（如已缓存）
+     */
+    std::vector<DigestStats> hottest(
+        size_t k, double min_avg_latency_ms, uint64_t min_executions,
+        const std::function<bool(uint64_t)>& exclude = nullptr) const;
+
+    size_t size() const;
+    void clear();
+
+private:
+    size_t max_digests_;
+    double half_life_sec_;
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, DigestStats> stats_;
+
+    double decayedHotness(const DigestStats& stats,
+                          std::chrono::steady_clock::time_point now) const;
+    void pruneLocked(std::chrono::steady_clock::time_point now);
+};
+
+} // namespace optimizer
+} // namespace heimdall
+
+#endif
@@ -0,0 +1,1324 @@
+/**
+ * @file heimdall_optimizer.cpp
+ * @brief Heimdall主优化器实现
+ *
+ * set*()/enable*()为配置接口，应在optimize()并发调用之前完成；
+ * optimize()本身可由多个连接线程同时调用。
+ */
+
+#include "heimdall_optimizer.h"
+#include "query_features.h"
+#include "query_fingerprint.h"
+#include "../llm_generator/sql_grammar.h"
+#include "../llm_generator/sql_lexer.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace heimdall {
+namespace optimizer {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::chrono::seconds kExampleSaveInterval(60);
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::string trim(const std::string& s) {
+    const size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return std::string();
+    const size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+// 展开${VAR}形式的环境变量
+std::string expandEnvironment(const std::string& value) {
+    std::string out;
+    size_t i = 0;
+    while (i < value.size()) {
+        const size_t start = value.find("${", i);
+        if (start == std::string::npos) {
+            out.append(value, i, std::string::npos);
+            break;
+        }
+        const size_t end = value.find('}', start + 2);
+        if (end == std::string::npos) {
+            out.append(value, i, std::string::npos);
+            break;
+        }
+        out.append(value, i, start - i);
+        const std::string name = value.substr(start + 2, end - start - 2);
+        if (const char* env = std::getenv(name.c_str())) {
+            out += env;
+        }
+        i = end + 1;
+    }
+    return out;
+}
+
+/**
+ * @brief 读取heimdall_config.yaml中的标量配置，键为点分路径（如"optimization.enabled"）
+ *
+ * 只支持本项目配置文件用到的子集：按缩进嵌套的"key: value"、
+ * '#'注释与${ENV}；列表项被忽略
+ */
+bool loadYamlScalars(const std::string& path,
+                     std::unordered_map<std::string, std::string>* values) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::vector<std::pair<size_t, std::string>> sections;  // (缩进, 键)
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t indent = line.find_first_not_of(' ');
+        if (indent == std::string::npos || line[indent] == '#' || line[indent] == '-') {
+            continue;
+        }
+        const size_t colon = line.find(':', indent);
+        if (colon == std::string::npos) {
+            continue;
+        }
+        while (!sections.empty() && sections.back().first >= indent) {
+            sections.pop_back();
+        }
+
+        std::string key = trim(line.substr(indent, colon - indent));
+        std::string value = line.substr(colon + 1);
+        const size_t comment = value.find(" #");
+        if (comment != std::string::npos) {
+            value.erase(comment);
+        }
+        value = trim(value);
+
+        std::string full_key;
+        for (const auto& section : sections) {
+            full_key += section.second;
+            full_key += '.';
+        }
+        full_key += key;
+
+        if (value.empty()) {
+            sections.emplace_back(indent, key);
+        } else {
+            (*values)[full_key] = expandEnvironment(value);
+        }
+    }
+    return true;
+}
+
+class ConfigValues {
+public:
+    explicit ConfigValues(const std::unordered_map<std::string, std::string>& values)
+        : values_(values) {}
+
+    std::string getString(const std::string& key, const std::string& fallback) const {
+        auto it = values_.find(key);
+        return it == values_.end() ? fallback : it->second;
+    }
+
+    bool getBool(const std::string& key, bool fallback) const {
+        auto it = values_.find(key);
+        if (it == values_.end()) return fallback;
+        return it->second == "true" || it->second == "yes" || it->second == "on";
+    }
+
+    double getDouble(const std::string& key, double fallback) const {
+        auto it = values_.find(key);
+        if (it == values_.end()) return fallback;
+        char* end = nullptr;
+        const double value = std::strtod(it->second.c_str(), &end);
+        return end == it->second.c_str() ? fallback : value;
+    }
+
+    int getInt(const std::string& key, int fallback) const {
+        return static_cast<int>(getDouble(key, fallback));
+    }
+
+private:
+    const std::unordered_map<std::string, std::string>& values_;
+};
+
+llm::BudgetLimits loadBudgetLimits(const ConfigValues& config, const std::string& prefix) {
+    llm::BudgetLimits limits;
+    limits.requests_per_minute = config.getDouble(prefix + ".requests_per_minute", 0);
+    limits.requests_per_hour = config.getDouble(prefix + ".requests_per_hour", 0);
+    limits.prompt_tokens_per_minute = config.getDouble(prefix + ".prompt_tokens_per_minute", 0);
+    limits.prompt_tokens_per_hour = config.getDouble(prefix + ".prompt_tokens_per_hour", 0);
+    limits.completion_tokens_per_minute =
+        config.getDouble(prefix + ".completion_tokens_per_minute", 0);
+    limits.completion_tokens_per_hour =
+        config.getDouble(prefix + ".completion_tokens_per_hour", 0);
+    return limits;
+}
+
+llm::BudgetGovernorConfig loadBudgetConfig(const ConfigValues& config) {
+    llm::BudgetGovernorConfig budget;
+    budget.global = loadBudgetLimits(config, "llm.budget.global");
+    budget.per_scope = loadBudgetLimits(config, "llm.budget.per_scope");
+    budget.reserve_fraction =
+        config.getDouble("llm.budget.reserve_fraction", budget.reserve_fraction);
+    budget.priority_window = static_cast<size_t>(config.getInt(
+        "llm.budget.priority_window", static_cast<int>(budget.priority_window)));
+    budget.max_scopes = static_cast<size_t>(
+        config.getInt("llm.budget.max_scopes", static_cast<int>(budget.max_scopes)));
+    return budget;
+}
+
+// 表名比较不区分大小写，版本表与缓存键统一用小写
+std::string lowerCopy(std::string_view text) {
+    std::string lower;
+    lower.reserve(text.size());
+    for (char c : text) lower += llm::toLowerAscii(c);
+    return lower;
+}
+
+// CONSERVATIVE模式要求的改进幅度是min_improvement_ratio超出1部分的两倍
+double requiredRatio(const OptimizationStrategy& strategy) {
+    if (strategy.selection_mode == OptimizationStrategy::SelectionMode::CONSERVATIVE) {
+        return 1.0 + 2.0 * std::max(0.0, strategy.min_improvement_ratio - 1.0);
+    }
+    return strategy.min_improvement_ratio;
+}
+
+} // namespace
+
+class HeimdallOptimizer::Impl {
+public:
+    OptimizationStrategy strategy;
+    llm::GenerationConfig generation;
+    std::atomic<bool> enabled{true};
+
+    std::shared_ptr<llm::LLMClient> llm_client;
+    std::shared_ptr<validator::SemanticValidator> validator;
+    std::shared_ptr<llm::CandidateBudgetController> budget;
+    std::shared_ptr<CandidateRanker> ranker;
+    SchemaProvider schema_provider;
+    CostEstimator cost_estimator;
+    BudgetScopeResolver budget_scope_resolver;
+    bool grammar_constrained = false;       // 按查询Schema构建SELECT语法约束候选
+    // 连接线程只读取当前快照；示例库更新等运行期修改发布新快照
+    std::shared_ptr<llm::PromptSnapshotPublisher> prompts =
+        std::make_shared<llm::PromptSnapshotPublisher>();
+    // initialize()读取的Prompt配置；setPromptSnapshots()换用新发布器时重新应用
+    bool prompt_configured = false;
+    llm::SchemaPruningOptions schema_pruning;
+    bool few_shot_by_similarity = true;
+    size_t max_few_shot_examples = 3;
+    size_t max_prompt_tokens = 0;           // 0表示不限制
+    llm::SchemaFormat schema_format = llm::SchemaFormat::DETAILED;
+    std::shared_ptr<llm::CatalogSnapshot> catalog;
+    std::shared_ptr<RewriteCache> rewrite_cache = std::make_shared<RewriteCache>();
+    // 后台优化队列，分层优化与空闲预取共用
+    std::unique_ptr<BackgroundOptimizer> background;
+    std::shared_ptr<DigestStatistics> digest_stats = std::make_shared<DigestStatistics>();
+    std::unique_ptr<RewritePrefetcher> prefetcher;
+    std::shared_ptr<TriggerModel> trigger_model;
+    std::unique_ptr<CostWorkerPool> cost_pool;    // 为空时串行估算
+    std::shared_ptr<CostCache> cost_cache;
+
+    // onStatisticsChanged()推送的统计信息版本，键为小写表名；
+    // 比目录快照新时以此为准
+    mutable std::mutex stats_versions_mutex;
+    std::unordered_map<std::string, uint64_t> stats_versions;
+    // onSchemaChanged()递增的表结构版本，键为小写表名；
+    // Schema片段缓存与RewriteCache都按它区分DDL前后
+    mutable std::mutex schema_versions_mutex;
+    std::unordered_map<std::string, uint64_t> schema_versions;
+    std::string trigger_model_path;         // 为空时不持久化
+
+    std::shared_ptr<llm::ExampleStore> example_store;
+    std::string example_store_path;         // 为空时不持久化
+    std::mutex example_save_mutex;
+    Clock::time_point last_example_save;
+
+    mutable std::mutex stats_mutex;
+    Statistics stats{};
+    double improvement_sum = 0.0;
+    double time_sum_ms = 0.0;
+
+    // 查询引用到的表的Schema，按首次出现顺序、去重
+    std::vector<llm::TableSchema> collectSchemas(const std::string& sql) const {
+        std::vector<llm::TableSchema> schemas;
+        if (!schema_provider) {
+            return schemas;
+        }
+        std::unordered_set<std::string> seen;
+        TableVisitor visitor = [&](std::string_view table) {
+            std::string name(table);
+            if (!seen.insert(name).second) {
+                return;
+            }
+            llm::TableSchema schema;
+            if (schema_provider(table, &schema)) {
+                if (schema.table_name.empty()) {
+                    schema.table_name = name;
+                }
+                // 数据源没有提供版本时以推送的版本为准，DDL后不再命中旧片段
+                if (schema.schema_version == 0) {
+                    schema.schema_version = schemaVersion(lowerCopy(schema.table_name));
+                }
+                schemas.push_back(std::move(schema));
+            }
+        };
+        extractQueryFeatures(sql, &visitor);
+        if (catalog) {
+            catalog->annotate(schemas);
+        }
+        return schemas;
+    }
+
+    // 表的当前统计信息版本：目录快照与onStatisticsChanged()推送中较新者
+    uint64_t statsVersion(const std::string& lower_table) const {
+        uint64_t version = catalog ? catalog->statsVersion(lower_table) : 0;
+        std::lock_guard<std::mutex> lock(stats_versions_mutex);
+        auto it = stats_versions.find(lower_table);
+        if (it != stats_versions.end()) {
+            version = std::max(version, it->second);
+        }
+        return version;
+    }
+
+    uint64_t schemaVersion(const std::string& lower_table) const {
+        std::lock_guard<std::mutex> lock(schema_versions_mutex);
+        auto it = schema_versions.find(lower_table);
+        return it == schema_versions.end() ? 0 : it->second;
+    }
+
+    // 调用代价估算回调；异常视为估算失败
+    double callEstimator(const std::string& sql, void* thd) const {
+        if (!cost_estimator) {
+            return -1.0;
+        }
+        try {
+            return cost_estimator(sql, thd);
+        } catch (...) {
+            return -1.0;
+        }
+    }
+
+    // 不经过缓存估算代价。后台优化、预取与触发判断没有会话（thd为nullptr），
+    // 启用了线程池时改用工作线程自己的估算上下文，否则以nullptr调用回调
+    double estimateUncached(const std::string& sql, void* thd) const {
+        if (!thd && cost_pool && cost_estimator) {
+            return cost_pool->estimateAll({std::string_view(sql)})[0];
+        }
+        return callEstimator(sql, thd);
+    }
+
+    // 查询引用到的表及其当前结构/统计信息版本，表名按不区分大小写去重
+    std::vector<TableVersion> tableVersions(const std::string& sql) const {
+        std::vector<TableVersion> tables;
+        std::unordered_set<std::string> seen;
+        TableVisitor visitor = [&](std::string_view table) {
+            std::string key = lowerCopy(table);
+            if (!seen.insert(key).second) {
+                return;
+            }
+            tables.push_back(
+                TableVersion{std::string(table), schemaVersion(key), statsVersion(key)});
+        };
+        extractQueryFeatures(sql, &visitor);
+        return tables;
+    }
+
+    // 按示例库价值顺序重新加载示例并发布新快照；在发布器的写锁内读取示例库，
+    // 并发收录时后发布的快照总包含先收录的示例
+    void publishExamples() {
+        prompts->update([this](llm::PromptBuilder& builder) {
+            builder.setFewShotExamples(example_store->examples());
+        });
+    }
+
+    // 把配置文件中的Prompt设置发布到当前发布器；未调用initialize()时保留构建器原有设置
+    void applyPromptConfig() {
+        if (!prompt_configured) {
+            return;
+        }
+        prompts->update([this](llm::PromptBuilder& builder) {
+            builder.setSchemaPruning(schema_pruning);
+            builder.setFewShotSelection(few_shot_by_similarity, max_few_shot_examples);
+            builder.setPromptTokenBudget(max_prompt_tokens);
+            builder.setSchemaFormat(schema_format);
+        });
+    }
+
+    // 示例库有变化时写回文件，两次写入至少间隔kExampleSaveInterval
+    void saveExamples(bool force) {
+        if (example_store_path.empty() || !example_store->dirty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(example_save_mutex);
+        const auto now = Clock::now();
+        if (!force && now - last_example_save < kExampleSaveInterval) {
+            return;
+        }
+        last_example_save = now;
+        example_store->save(example_store_path);
+    }
+
+    void recordResult(const OptimizationResult& result) {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        const double ms = static_cast<double>(result.total_time.count());
+        time_sum_ms += ms;
+        if (result.optimized) {
+            ++stats.optimized_queries;
+            improvement_sum += result.improvement_ratio;
+        }
+        stats.failed_validations += static_cast<uint64_t>(
+            std::max(0, result.stats.candidates_examined -
+                            (result.stats.candidates_validated -
+                             result.stats.candidates_repaired)));
+        if (stats.total_queries > 0) {
+            stats.avg_optimization_time_ms =
+                time_sum_ms / static_cast<double>(stats.total_queries);
+        }
+        if (stats.optimized_queries > 0) {
+            stats.avg_improvement_ratio =
+                improvement_sum / static_cast<double>(stats.optimized_queries);
+        }
+    }
+};
+
+HeimdallOptimizer::HeimdallOptimizer() : pimpl_(new Impl()) {}
+
+HeimdallOptimizer::~HeimdallOptimizer() {
+    // 后台线程回调本对象，须在成员析构前停止
+    disablePrefetch();
+    disableAsyncOptimization();
+    pimpl_->cost_pool.reset();
+    if (pimpl_->example_store) {
+        pimpl_->saveExamples(true);
+    }
+    if (pimpl_->trigger_model && !pimpl_->trigger_model_path.empty()) {
+        pimpl_->trigger_model->save(pimpl_->trigger_model_path);
+    }
+}
+
+bool HeimdallOptimizer::initialize(const std::string& config_path) {
+    std::unordered_map<std::string, std::string> raw;
+    if (!loadYamlScalars(config_path, &raw)) {
+        return false;
+    }
+    const ConfigValues config(raw);
+
+    OptimizationStrategy strategy = pimpl_->strategy;
+    strategy.enable_for_subqueries =
+        config.getBool("optimization.triggers.enable_for_subqueries", strategy.enable_for_subqueries);
+    strategy.enable_for_complex_joins =
+        config.getBool("optimization.triggers.enable_for_complex_joins", strategy.enable_for_complex_joins);
+    strategy.min_estimated_cost =
+        config.getInt("optimization.triggers.min_estimated_cost", strategy.min_estimated_cost);
+    strategy.min_table_count =
+        config.getInt("optimization.triggers.min_table_count", strategy.min_table_count);
+    strategy.min_in_list_size =
+        config.getInt("optimization.triggers.min_in_list_size", strategy.min_in_list_size);
+    strategy.use_trigger_model =
+        config.getBool("optimization.triggers.trigger_model.enabled", strategy.use_trigger_model);
+    strategy.max_candidates =
+        config.getInt("optimization.generation.max_candidates", strategy.max_candidates);
+    strategy.validation_timeout_sec =
+        config.getDouble("optimization.generation.validation_timeout_sec", strategy.validation_timeout_sec);
+    strategy.adaptive_candidates =
+        config.getBool("llm.generation.adaptive.enabled", strategy.adaptive_candidates);
+    strategy.max_repair_rounds =
+        config.getInt("optimization.repair.max_rounds", strategy.max_repair_rounds);
+    strategy.max_repair_differences =
+        config.getInt("optimization.repair.max_differences", strategy.max_repair_differences);
+    strategy.prerank_candidates =
+        config.getBool("optimization.prerank_candidates", strategy.prerank_candidates);
+    strategy.prerank_top_k = config.getInt("optimization.prerank_top_k", strategy.prerank_top_k);
+    strategy.min_improvement_ratio =
+        config.getDouble("optimization.min_improvement_ratio", strategy.min_improvement_ratio);
+    const std::string mode = config.getString("optimization.selection_mode", "best_cost");
+    if (mode == "first_valid") {
+        strategy.selection_mode = OptimizationStrategy::SelectionMode::FIRST_VALID;
+    } else if (mode == "conservative") {
+        strategy.selection_mode = OptimizationStrategy::SelectionMode::CONSERVATIVE;
+    } else {
+        strategy.selection_mode = OptimizationStrategy::SelectionMode::BEST_COST;
+    }
+    setStrategy(strategy);
+    setEnabled(config.getBool("optimization.enabled", true));
+
+    const int rewrite_cache_size = config.getInt("optimization.async.rewrite_cache_size", 0);
+    if (rewrite_cache_size > 0) {
+        pimpl_->rewrite_cache =
+            std::make_shared<RewriteCache>(static_cast<size_t>(rewrite_cache_size));
+    }
+
+    llm::GenerationConfig& generation = pimpl_->generation;
+    generation.model_name = config.getString("llm.generation.model_name", generation.model_name);
+    generation.temperature = static_cast<float>(
+        config.getDouble("llm.generation.temperature", generation.temperature));
+    generation.max_tokens = config.getInt("llm.generation.max_tokens", generation.max_tokens);
+    generation.num_candidates =
+        config.getInt("llm.generation.num_candidates", generation.num_candidates);
+    generation.use_few_shot = config.getBool("prompt.use_few_shot", generation.use_few_shot);
+    pimpl_->few_shot_by_similarity =
+        config.getBool("prompt.few_shot_by_similarity", pimpl_->few_shot_by_similarity);
+    pimpl_->max_few_shot_examples = static_cast<size_t>(std::max(
+        0, config.getInt("prompt.max_few_shot_examples",
+                         static_cast<int>(pimpl_->max_few_shot_examples))));
+    pimpl_->max_prompt_tokens =
+        static_cast<size_t>(std::max(0, config.getInt("prompt.max_prompt_tokens", 0)));
+    pimpl_->schema_format = config.getString("prompt.schema_format", "detailed") == "compact"
+                                ? llm::SchemaFormat::COMPACT
+                                : llm::SchemaFormat::DETAILED;
+
+    llm::SchemaPruningOptions& pruning = pimpl_->schema_pruning;
+    pruning.enabled = config.getBool("prompt.schema_pruning.enabled", false);
+    pruning.prune_columns =
+        config.getBool("prompt.schema_pruning.prune_columns", pruning.prune_columns);
+    pruning.include_fk_neighbors = config.getBool("prompt.schema_pruning.include_fk_neighbors",
+                                                  pruning.include_fk_neighbors);
+    pruning.max_fk_neighbors =
+        config.getInt("prompt.schema_pruning.max_fk_neighbors", pruning.max_fk_neighbors);
+    pimpl_->prompt_configured = true;
+    pimpl_->applyPromptConfig();
+
+    // 只有本地服务端能在解码时施加GBNF约束，其他提供商不构建语法
+    pimpl_->grammar_constrained = config.getString("llm.provider", "openai") == "local" &&
+                                  config.getBool("llm.local_grammar", false);
+    if (!pimpl_->llm_client) {
+        auto client = std::make_shared<llm::LLMClient>();
+        const std::string provider = config.getString("llm.provider", "openai");
+        if (provider == "local") {
+            auto local = std::make_shared<llm::LocalModelProvider>(
+                config.getString("llm.local_endpoint", "http://localhost:8000/generate"));
+            local->setGrammarSupported(pimpl_->grammar_constrained);
+            client->registerProvider(local);
+            client->setProvider(local->getName());
+        } else {
+            auto openai = std::make_shared<llm::OpenAIProvider>(
+                config.getString("llm.api_key", std::string()));
+            client->registerProvider(openai);
+            client->setProvider(openai->getName());
+        }
+        client->enableCache(config.getBool("llm.cache.enabled", true),
+                            static_cast<size_t>(config.getInt("llm.cache.max_size", 1000)));
+        client->enableCacheAdmission(
+            config.getBool("llm.cache.admission.enabled", true),
+            config.getDouble("llm.cache.admission.window_fraction", 0.01));
+        if (config.getBool("llm.cache.compression.enabled", false)) {
+            client->enableCacheCompression(
+                true,
+                static_cast<size_t>(config.getInt("llm.cache.compression.max_bytes", 0)),
+                static_cast<size_t>(config.getInt("llm.cache.compression.retrain_interval", 0)));
+        }
+        client->setBudgetGovernor(
+            std::make_shared<llm::BudgetGovernor>(loadBudgetConfig(config)));
+        pimpl_->llm_client = std::move(client);
+    }
+    if (!pimpl_->validator) {
+        pimpl_->validator = std::make_shared<validator::SemanticValidator>();
+    }
+    if (!pimpl_->budget && strategy.adaptive_candidates) {
+        llm::CandidateBudgetConfig budget;
+        budget.min_candidates =
+            config.getInt("llm.generation.adaptive.min_candidates", budget.min_candidates);
+        budget.max_candidates =
+            config.getInt("llm.generation.adaptive.max_candidates", budget.max_candidates);
+        budget.min_temperature = static_cast<float>(
+            config.getDouble("llm.generation.adaptive.min_temperature", budget.min_temperature));
+        budget.max_temperature = static_cast<float>(
+            config.getDouble("llm.generation.adaptive.max_temperature", budget.max_temperature));
+        budget.warmup_samples =
+            config.getInt("llm.generation.adaptive.warmup_samples", budget.warmup_samples);
+        budget.target_win_coverage = config.getDouble(
+            "llm.generation.adaptive.target_win_coverage", budget.target_win_coverage);
+        pimpl_->budget = std::make_shared<llm::CandidateBudgetController>(budget);
+    }
+    if (!pimpl_->ranker && strategy.prerank_candidates) {
+        // 行数取自调用时的目录快照；快照未加载或表不在快照中时不计扫描行数
+        Impl& impl = *pimpl_;
+        pimpl_->ranker = std::make_shared<CandidateRanker>(
+            [&impl](std::string_view table) {
+                uint64_t rows = 0;
+                if (!impl.catalog || !impl.catalog->rowCount(table, &rows)) {
+                    return -1.0;
+                }
+                return static_cast<double>(rows);
+            });
+    }
+    if (!pimpl_->example_store && config.getBool("prompt.example_store.enabled", false)) {
+        llm::ExampleStoreConfig store_config;
+        store_config.max_examples = static_cast<size_t>(config.getInt(
+            "prompt.example_store.max_examples", static_cast<int>(store_config.max_examples)));
+        store_config.min_speedup =
+            config.getDouble("prompt.example_store.min_speedup", store_config.min_speedup);
+        store_config.max_sql_length = static_cast<size_t>(config.getInt(
+            "prompt.example_store.max_sql_length", static_cast<int>(store_config.max_sql_length)));
+        auto store = std::make_shared<llm::ExampleStore>(store_config);
+        pimpl_->example_store_path = config.getString("prompt.example_store.path", "");
+        // 首次运行时文件不存在，从空库开始
+        if (!pimpl_->example_store_path.empty()) {
+            store->load(pimpl_->example_store_path);
+        }
+        setExampleStore(std::move(store));
+    }
+    if (!pimpl_->catalog && config.getBool("prompt.statistics.enabled", false)) {
+        // 快照缺失或损坏时不附带统计，Prompt退回只含表结构
+        auto catalog = std::make_shared<llm::CatalogSnapshot>();
+        if (catalog->loadFromFile(config.getString("prompt.statistics.snapshot_path", ""))) {
+            pimpl_->catalog = std::move(catalog);
+        }
+    }
+    if (!pimpl_->trigger_model && strategy.use_trigger_model) {
+        const std::string prefix = "optimization.triggers.trigger_model.";
+        TriggerModelConfig model_config;
+        model_config.learning_rate =
+            config.getDouble(prefix + "learning_rate", model_config.learning_rate);
+        model_config.min_samples = static_cast<uint64_t>(config.getInt(
+            prefix + "min_samples", static_cast<int>(model_config.min_samples)));
+        model_config.min_probability =
+            config.getDouble(prefix + "min_probability", model_config.min_probability);
+        model_config.min_expected_benefit =
+            config.getDouble(prefix + "min_expected_benefit", model_config.min_expected_benefit);
+        model_config.exploration_interval = static_cast<uint64_t>(config.getInt(
+            prefix + "exploration_interval", static_cast<int>(model_config.exploration_interval)));
+        auto model = std::make_shared<TriggerModel>(model_config);
+        pimpl_->trigger_model_path = config.getString(prefix + "path", "");
+        // 首次运行时文件不存在，从零开始训练
+        if (!pimpl_->trigger_model_path.empty()) {
+            model->load(pimpl_->trigger_model_path);
+        }
+        pimpl_->trigger_model = std::move(model);
+    }
+    if (!pimpl_->cost_cache && config.getBool("optimization.cost_estimation.cache.enabled", false)) {
+        CostCacheConfig cache_config;
+        cache_config.max_entries = static_cast<size_t>(config.getInt(
+            "optimization.cost_estimation.cache.max_entries",
+            static_cast<int>(cache_config.max_entries)));
+        cache_config.ttl = std::chrono::seconds(config.getInt(
+            "optimization.cost_estimation.cache.ttl_seconds",
+            static_cast<int>(cache_config.ttl.count())));
+        setCostCache(std::make_shared<CostCache>(cache_config));
+    }
+    const int cost_workers = config.getInt("optimization.cost_estimation.parallel_workers", 0);
+    if (!pimpl_->cost_pool && cost_workers > 0) {
+        enableParallelCostEstimation(static_cast<size_t>(cost_workers));
+    }
+    if (config.getBool("optimization.prefetch.enabled", false)) {
+        PrefetchConfig prefetch;
+        prefetch.poll_interval = std::chrono::milliseconds(config.getInt(
+            "optimization.prefetch.poll_interval_ms",
+            static_cast<int>(prefetch.poll_interval.count())));
+        prefetch.max_per_cycle = static_cast<size_t>(config.getInt(
+            "optimization.prefetch.max_per_cycle", static_cast<int>(prefetch.max_per_cycle)));
+        prefetch.min_avg_latency_ms = config.getDouble(
+            "optimization.prefetch.min_avg_latency_ms", prefetch.min_avg_latency_ms);
+        prefetch.min_executions = static_cast<uint64_t>(config.getInt(
+            "optimization.prefetch.min_executions", static_cast<int>(prefetch.min_executions)));
+        enablePrefetch(prefetch);
+    }
+    if (config.getBool("optimization.async.enabled", false)) {
+        AsyncOptimizationConfig async;
+        async.queue_capacity = static_cast<size_t>(config.getInt(
+            "optimization.async.queue_capacity", static_cast<int>(async.queue_capacity)));
+        async.workers = static_cast<size_t>(
+            config.getInt("optimization.async.workers", static_cast<int>(async.workers)));
+        async.retry_after = std::chrono::seconds(config.getInt(
+            "optimization.async.retry_after_seconds", static_cast<int>(async.retry_after.count())));
+        enableAsyncOptimization(async);
+    }
+    return true;
+}
+
+OptimizationResult HeimdallOptimizer::optimize(const std::string& sql,
+                                               void* txsql_thd) {
+    const auto start = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->stats_mutex);
+        ++pimpl_->stats.total_queries;
+    }
+
+    OptimizationResult result;
+    if (!pimpl_->enabled.load()) {
+        result = OptimizationResult();
+        result.original_sql = sql;
+        result.reason = "optimizer disabled";
+    } else if (!shouldOptimize(sql)) {
+        result = OptimizationResult();
+        result.original_sql = sql;
+        result.reason = "trigger conditions not met";
+    } else {
+        Impl& impl = *pimpl_;
+        const uint64_t digest = computeQueryDigest(sql);
+        std::string bound;
+        const CachedRewritePtr cached = impl.rewrite_cache->lookup(digest);
+        if (cached && bindRewrite(*cached, sql, &bound)) {
+            result = OptimizationResult();
+            result.original_sql = sql;
+            result.optimized = true;
+            result.optimized_sql = std::move(bound);
+            result.estimated_cost_original = cached->cost_original;
+            result.estimated_cost_optimized = cached->cost_optimized;
+            result.improvement_ratio =
+                (cached->cost_original > 0 && cached->cost_optimized > 0)
+                    ? cached->cost_original / cached->cost_optimized : 1.0;
+            result.stats.chosen_candidate_index = -1;
+            result.from_rewrite_cache = true;
+            result.reason = "rewrite cache hit";
+            std::lock_guard<std::mutex> lock(impl.stats_mutex);
+            ++impl.stats.rewrite_cache_hits;
+        } else if (impl.strategy.async_optimization && impl.background) {
+            // 本次按原计划执行，不在连接线程上等待LLM
+            result = OptimizationResult();
+            result.original_sql = sql;
+            result.stats.chosen_candidate_index = -1;
+            result.queued = impl.background->enqueue(digest, sql);
+            result.reason = "queued for background optimization";
+            if (result.queued) {
+                std::lock_guard<std::mutex> lock(impl.stats_mutex);
+                ++impl.stats.async_enqueued;
+            }
+        } else {
+            result = optimizeAndCache(sql, txsql_thd);
+        }
+    }
+
+    result.total_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - start);
+    pimpl_->recordResult(result);
+    return result;
+}
+
+OptimizationResult HeimdallOptimizer::optimizeNow(const std::string& sql, void* thd) {
+    Impl& impl = *pimpl_;
+    const OptimizationStrategy& strategy = impl.strategy;
+
+    OptimizationResult result = OptimizationResult();
+    result.original_sql = sql;
+    result.stats.chosen_candidate_index = -1;
+    if (!impl.llm_client || !impl.validator) {
+        result.reason = "LLM client or validator not configured";
+        return result;
+    }
+
+    // 1. 生成配置：按查询类别自适应候选数与温度
+    const uint64_t query_class = computeQueryDigest(sql);
+    llm::GenerationConfig config = impl.generation;
+    config.num_candidates = std::min(config.num_candidates, strategy.max_candidates);
+    if (strategy.adaptive_candidates && impl.budget) {
+        config = impl.budget->adapt(query_class, config);
+        config.num_candidates = std::min(config.num_candidates, strategy.max_candidates);
+    }
+
+    // 原查询代价是改写收益的上界，预算紧张时用于排名；代价未知时按0处理
+    config.expected_savings = std::max(0.0, estimateCost(sql, thd));
+    // 后台与预取请求没有会话，只受全局预算限制
+    if (impl.budget_scope_resolver && thd) {
+        config.budget_scope = impl.budget_scope_resolver(sql, thd);
+    }
+
+    // 2. 生成候选
+    auto phase = Clock::now();
+    std::string prompt;
+    llm::LLMResponsePtr response = generateCandidates(sql, &config, &prompt);
+    result.stats.llm_time_ms = elapsedMs(phase);
+    if (!response || !response->success) {
+        if (response && response->budget_rejected) {
+            std::lock_guard<std::mutex> lock(impl.stats_mutex);
+            ++impl.stats.budget_rejections;
+            result.reason = "LLM budget exhausted";
+        } else {
+            result.reason = "LLM generation failed";
+        }
+        return result;
+    }
+    size_t prompt_tokens = llm::BudgetGovernor::estimateTokens(prompt);
+    size_t completion_tokens = llm::BudgetGovernor::estimateTokens(response->raw_response);
+
+    // 3. 预排序：有希望的候选先验证，FIRST_VALID时即为得分最高的有效候选
+    std::vector<std::string_view> candidates = response->candidates;
+    std::vector<size_t> generation_order(candidates.size());
+    for (size_t i = 0; i < generation_order.size(); ++i) generation_order[i] = i;
+    if (strategy.prerank_candidates && impl.ranker && candidates.size() > 1) {
+        const auto ranked = impl.ranker->rank(
+            sql, candidates, static_cast<size_t>(std::max(0, strategy.prerank_top_k)));
+        std::vector<std::string_view> ordered;
+        ordered.reserve(ranked.size());
+        for (size_t i = 0; i < ranked.size(); ++i) {
+            ordered.push_back(candidates[ranked[i].index]);
+            generation_order[i] = ranked[i].index;
+        }
+        candidates = std::move(ordered);
+        generation_order.resize(candidates.size());
+    }
+    result.stats.candidates_generated = static_cast<int>(response->candidates.size());
+
+    // 4. 验证，近似正确的失败候选进入修复循环
+    phase = Clock::now();
+    std::vector<NearMiss> near_misses;
+    std::vector<std::string_view> validated = validateCandidates(sql, candidates, &near_misses);
+    result.stats.validation_time_ms = elapsedMs(phase);
+    // FIRST_VALID在首个有效候选处停止，其后的候选未经验证，不能算作失败
+    result.stats.candidates_examined = static_cast<int>(candidates.size());
+    if (strategy.selection_mode == OptimizationStrategy::SelectionMode::FIRST_VALID &&
+        !validated.empty()) {
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (candidates[i].data() == validated.front().data()) {
+                result.stats.candidates_examined = static_cast<int>(i + 1);
+                break;
+            }
+        }
+    }
+
+    RepairResult repair;
+    if (strategy.max_repair_rounds > 0 && !near_misses.empty()) {
+        phase = Clock::now();
+        repair = repairCandidates(sql, prompt, config, near_misses);
+        result.stats.llm_time_ms += elapsedMs(phase);
+        prompt_tokens += repair.prompt_tokens;
+        completion_tokens += repair.completion_tokens;
+        result.stats.candidates_repaired = static_cast<int>(repair.repaired.size());
+        validated.insert(validated.end(), repair.repaired.begin(), repair.repaired.end());
+    }
+    result.stats.candidates_validated = static_cast<int>(validated.size());
+
+    // 5. 代价比较与选择
+    phase = Clock::now();
+    double original_cost = -1.0;
+    double chosen_cost = -1.0;
+    const int chosen = validated.empty()
+                           ? -1
+                           : selectBestCandidate(sql, validated, thd, &original_cost, &chosen_cost);
+    result.stats.cost_estimation_time_ms = elapsedMs(phase);
+    result.estimated_cost_original = original_cost;
+    result.estimated_cost_optimized = chosen_cost;
+
+    if (chosen >= 0) {
+        const std::string_view chosen_sql = validated[static_cast<size_t>(chosen)];
+        result.optimized = true;
+        result.optimized_sql.assign(chosen_sql.data(), chosen_sql.size());
+        result.improvement_ratio = (original_cost > 0 && chosen_cost > 0)
+                                       ? original_cost / chosen_cost : 1.0;
+        result.reason = "rewrite validated and selected";
+
+        // 选中候选在生成顺序中的位置；修复得到的候选记在全部原始候选之后
+        result.stats.chosen_candidate_index = static_cast<int>(response->candidates.size());
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (candidates[i].data() == chosen_sql.data()) {
+                result.stats.chosen_candidate_index = static_cast<int>(generation_order[i]);
+                break;
+            }
+        }
+    } else {
+        result.reason = validated.empty() ? "no candidate passed validation"
+                                          : "no candidate met the improvement threshold";
+    }
+
+    if (strategy.adaptive_candidates && impl.budget) {
+        // 修复得到的胜出者不占生成顺序，不计入胜出位置分布
+        const bool repaired_winner = result.stats.chosen_candidate_index >=
+                                     static_cast<int>(response->candidates.size());
+        impl.budget->recordOutcome(query_class, result.stats.candidates_generated,
+                                   result.stats.candidates_validated -
+                                       result.stats.candidates_repaired,
+                                   repaired_winner ? -1 : result.stats.chosen_candidate_index,
+                                   prompt_tokens, completion_tokens,
+                                   result.stats.candidates_examined);
+    }
+    // 只用得到了候选的优化训练；生成失败、预算不足不反映查询本身的可优化性
+    if (impl.trigger_model) {
+        impl.trigger_model->update(
+            makeTriggerFeatures(extractQueryFeatures(sql), config.expected_savings),
+            result.optimized, result.improvement_ratio);
+    }
+    return result;
+}
+
+OptimizationResult HeimdallOptimizer::optimizeAndCache(const std::string& sql, void* thd) {
+    Impl& impl = *pimpl_;
+    const auto started = Clock::now();
+    // 先取epoch再取版本：生成期间的任何失效都会让写入被拒绝
+    const uint64_t epoch = impl.rewrite_cache->epoch();
+    std::vector<TableVersion> tables = impl.tableVersions(sql);
+    OptimizationResult result = optimizeNow(sql, thd);
+    if (result.optimized) {
+        CachedRewrite rewrite;
+        rewrite.digest = computeQueryDigest(sql);
+        rewrite.original_sql = sql;
+        rewrite.rewritten_sql = result.optimized_sql;
+        rewrite.cost_original = result.estimated_cost_original;
+        rewrite.cost_optimized = result.estimated_cost_optimized;
+        rewrite.tables = std::move(tables);
+        rewrite.created = started;
+        rewrite.epoch = epoch;
+        impl.rewrite_cache->insert(std::move(rewrite));
+    }
+    return result;
+}
+
+void HeimdallOptimizer::setStrategy(const OptimizationStrategy& strategy) {
+    pimpl_->strategy = strategy;
+}
+
+void HeimdallOptimizer::setLLMClient(std::shared_ptr<llm::LLMClient> client) {
+    pimpl_->llm_client = std::move(client);
+}
+
+void HeimdallOptimizer::setValidator(std::shared_ptr<validator::SemanticValidator> validator) {
+    pimpl_->validator = std::move(validator);
+}
+
+void HeimdallOptimizer::setSchemaProvider(SchemaProvider provider) {
+    pimpl_->schema_provider = std::move(provider);
+}
+
+void HeimdallOptimizer::setCostEstimator(CostEstimator estimator) {
+    pimpl_->cost_estimator = std::move(estimator);
+}
+
+void HeimdallOptimizer::setBudgetScopeResolver(BudgetScopeResolver resolver) {
+    pimpl_->budget_scope_resolver = std::move(resolver);
+}
+
+void HeimdallOptimizer::setCandidateBudget(
+    std::shared_ptr<llm::CandidateBudgetController> budget) {
+    pimpl_->budget = std::move(budget);
+}
+
+void HeimdallOptimizer::setCandidateRanker(std::shared_ptr<CandidateRanker> ranker) {
+    pimpl_->ranker = std::move(ranker);
+}
+
+void HeimdallOptimizer::setSchemaCache(std::shared_ptr<llm::SchemaRenderCache> cache) {
+    pimpl_->prompts->update([&cache](llm::PromptBuilder& builder) {
+        builder.setSchemaCache(cache);
+    });
+}
+
+void HeimdallOptimizer::onSchemaChanged(const std::string& table_name) {
+    Impl& impl = *pimpl_;
+    uint64_t version = 0;
+    {
+        std::lock_guard<std::mutex> lock(impl.schema_versions_mutex);
+        version = ++impl.schema_versions[lowerCopy(table_name)];
+    }
+    impl.prompts->current()->getSchemaCache()->invalidate(table_name);
+    impl.rewrite_cache->invalidateSchema(table_name, version);
+}
+
+void HeimdallOptimizer::onStatisticsChanged(const std::string& table_name,
+                                            uint64_t stats_version) {
+    Impl& impl = *pimpl_;
+    const std::string key = lowerCopy(table_name);
+    {
+        // 版本变化使缓存的代价在下次查找时失效
+        std::lock_guard<std::mutex> lock(impl.stats_versions_mutex);
+        uint64_t& known = impl.stats_versions[key];
+        known = std::max(known, stats_version);
+    }
+    impl.rewrite_cache->invalidateStatistics(table_name, stats_version);
+}
+
+void HeimdallOptimizer::enableAsyncOptimization(const AsyncOptimizationConfig& config) {
+    if (pimpl_->background) {
+        pimpl_->background->stop();
+    }
+    // 后台线程没有会话，以nullptr代替thd，见CostEstimator与BudgetScopeResolver
+    pimpl_->background.reset(new BackgroundOptimizer(
+        [this](const std::string& sql) { return optimizeAndCache(sql, nullptr).optimized; },
+        config));
+    pimpl_->background->start();
+    pimpl_->strategy.async_optimization = true;
+}
+
+void HeimdallOptimizer::disableAsyncOptimization() {
+    pimpl_->strategy.async_optimization = false;
+    // 预取仍在使用后台队列时保留
+    if (pimpl_->background && !pimpl_->prefetcher) {
+        pimpl_->background->stop();
+        pimpl_->background.reset();
+    }
+}
+
+void HeimdallOptimizer::recordExecution(const std::string& sql, double latency_ms) {
+    Impl& impl = *pimpl_;
+    impl.digest_stats->record(computeQueryDigest(sql), sql, latency_ms);
+    if (impl.prefetcher) {
+        impl.prefetcher->maybeRun();
+    }
+}
+
+void HeimdallOptimizer::enablePrefetch(const PrefetchConfig& config) {
+    Impl& impl = *pimpl_;
+    if (!impl.background) {
+        impl.background.reset(new BackgroundOptimizer(
+            [this](const std::string& sql) { return optimizeAndCache(sql, nullptr).optimized; }));
+        impl.background->start();
+    }
+    impl.prefetcher.reset(new RewritePrefetcher(
+        impl.digest_stats,
+        [&impl] { return impl.llm_client && impl.llm_client->inFlightRequests() == 0; },
+        [&impl](uint64_t digest) {
+            return impl.rewrite_cache->contains(digest) || impl.background->tracking(digest);
+        },
+        [&impl](uint64_t digest, const std::string& sql) {
+            if (!impl.background->enqueue(digest, sql)) {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(impl.stats_mutex);
+            ++impl.stats.prefetched_rewrites;
+            return true;
+        },
+        config));
+}
+
+void HeimdallOptimizer::disablePrefetch() {
+    pimpl_->prefetcher.reset();
+    if (pimpl_->background && !pimpl_->strategy.async_optimization) {
+        pimpl_->background->stop();
+        pimpl_->background.reset();
+    }
+}
+
+void HeimdallOptimizer::setRewriteCache(std::shared_ptr<RewriteCache> cache) {
+    if (cache) {
+        pimpl_->rewrite_cache = std::move(cache);
+    }
+}
+
+std::shared_ptr<RewriteCache> HeimdallOptimizer::getRewriteCache() const {
+    return pimpl_->rewrite_cache;
+}
+
+void HeimdallOptimizer::setCatalogSnapshot(std::shared_ptr<llm::CatalogSnapshot> snapshot) {
+    pimpl_->catalog = std::move(snapshot);
+}
+
+void HeimdallOptimizer::setPromptSnapshots(
+    std::shared_ptr<llm::PromptSnapshotPublisher> prompts) {
+    if (!prompts) {
+        return;
+    }
+    pimpl_->prompts = std::move(prompts);
+    pimpl_->applyPromptConfig();
+    if (pimpl_->example_store) {
+        pimpl_->publishExamples();
+    }
+}
+
+void HeimdallOptimizer::setTriggerModel(std::shared_ptr<TriggerModel> model) {
+    pimpl_->trigger_model = std::move(model);
+}
+
+void HeimdallOptimizer::setExampleStore(std::shared_ptr<llm::ExampleStore> store) {
+    pimpl_->example_store = std::move(store);
+    if (pimpl_->example_store) {
+        pimpl_->publishExamples();
+    }
+}
+
+void HeimdallOptimizer::reportMeasuredSpeedup(const std::string& original_sql,
+                                              const std::string& rewritten_sql,
+                                              double speedup_ratio) {
+    Impl& impl = *pimpl_;
+    if (!impl.example_store) {
+        return;
+    }
+    llm::FewShotExample example;
+    example.original_sql = original_sql;
+    example.optimized_sql = rewritten_sql;
+    example.speedup_ratio = speedup_ratio;
+    if (impl.example_store->harvest(computeQueryDigest(original_sql), example)) {
+        impl.publishExamples();
+    }
+    impl.saveExamples(false);
+}
+
+HeimdallOptimizer::Statistics HeimdallOptimizer::getStatistics() const {
+    Statistics stats;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->stats_mutex);
+        stats = pimpl_->stats;
+    }
+    if (pimpl_->llm_client) {
+        stats.cache_hits = pimpl_->llm_client->getCacheStats().hits;
+    }
+    return stats;
+}
+
+void HeimdallOptimizer::resetStatistics() {
+    std::lock_guard<std::mutex> lock(pimpl_->stats_mutex);
+    pimpl_->stats = Statistics{};
+    pimpl_->improvement_sum = 0.0;
+    pimpl_->time_sum_ms = 0.0;
+}
+
+void HeimdallOptimizer::setEnabled(bool enabled) {
+    pimpl_->enabled.store(enabled);
+}
+
+bool HeimdallOptimizer::isEnabled() const {
+    return pimpl_->enabled.load();
+}
+
+bool HeimdallOptimizer::shouldOptimize(const std::string& sql) {
+    const OptimizationStrategy& strategy = pimpl_->strategy;
+    ClassifierRules rules;
+    rules.enable_for_subqueries = strategy.enable_for_subqueries;
+    rules.enable_for_complex_joins = strategy.enable_for_complex_joins;
+    rules.min_table_count = strategy.min_table_count;
+    rules.min_in_list_size = strategy.min_in_list_size;
+    // 单遍初筛，不分配内存；只有SELECT进入重写流程
+    const QueryClassification classification = classifyQuery(sql, rules);
+    if (!classification.candidate ||
+        classification.statement_type != StatementType::SELECT) {
+        return false;
+    }
+    const std::shared_ptr<TriggerModel>& model = pimpl_->trigger_model;
+    const bool use_model = strategy.use_trigger_model && model;
+    if (strategy.min_estimated_cost <= 0 && !use_model) {
+        return true;
+    }
+    // 代价未知时不以代价阈值拦截
+    const double cost = estimateCost(sql, nullptr);
+    if (strategy.min_estimated_cost > 0 && cost >= 0 &&
+        cost < static_cast<double>(strategy.min_estimated_cost)) {
+        return false;
+    }
+    if (!use_model) {
+        return true;
+    }
+    // 只有通过规则与代价检查的语句才提取完整特征
+    const TriggerDecision decision =
+        model->decide(makeTriggerFeatures(extractQueryFeatures(sql), std::max(0.0, cost)));
+    if (!decision.optimize) {
+        std::lock_guard<std::mutex> lock(pimpl_->stats_mutex);
+        ++pimpl_->stats.model_skipped;
+    }
+    return decision.optimize;
+}
+
+llm::LLMResponsePtr HeimdallOptimizer::generateCandidates(
+    const std::string& sql, llm::GenerationConfig* config, std::string* prompt) {
+    const std::vector<llm::TableSchema> schemas = pimpl_->collectSchemas(sql);
+    const llm::PromptSnapshot snapshot = pimpl_->prompts->current();
+    llm::PromptPrefix prefix;
+    snapshot->buildRewritePromptInto(sql, schemas, config->use_few_shot, *prompt, &prefix);
+    // 引用相同表的查询共享到Schema为止的前缀
+    config->prompt_prefix_length = prefix.context_length;
+    config->prompt_prefix_hash = prefix.context_hash;
+    // 没有任何已知表时语法只剩CTE，会拒绝所有候选，此时不约束
+    if (pimpl_->grammar_constrained && !schemas.empty()) {
+        config->grammar = llm::SqlGrammar::forSelect(schemas);
+    }
+    return pimpl_->llm_client->generateFromPrompt(*prompt, *config);
+}
+
+std::vector<std::string_view> HeimdallOptimizer::validateCandidates(
+    const std::string& original_sql,
+    const std::vector<std::string_view>& candidates,
+    std::vector<NearMiss>* near_misses) {
+    const OptimizationStrategy& strategy = pimpl_->strategy;
+    const bool first_valid =
+        strategy.selection_mode == OptimizationStrategy::SelectionMode::FIRST_VALID;
+
+    std::vector<std::string_view> validated;
+    for (auto candidate : candidates) {
+        validator::ValidationResult validation = pimpl_->validator->validate(
+            original_sql, std::string(candidate));
+        if (validation.is_equivalent) {
+            validated.push_back(candidate);
+            if (first_valid) {
+                break;
+            }
+        } else if (near_misses &&
+                   isNearMiss(validation, strategy.max_repair_differences)) {
+            near_misses->push_back(NearMiss{candidate, std::move(validation)});
+        }
+    }
+    // FIRST_VALID已有有效候选时不再修复
+    if (first_valid && !validated.empty() && near_misses) {
+        near_misses->clear();
+    }
+    return validated;
+}
+
+RepairResult HeimdallOptimizer::repairCandidates(
+    const std::string& original_sql,
+    const std::string& rewrite_prompt,
+    const llm::GenerationConfig& config,
+    const std::vector<NearMiss>& near_misses) {
+    // 修复只需要一个候选，低温度减少与反馈无关的改动
+    llm::GenerationConfig repair_config = config;
+    repair_config.num_candidates = 1;
+    repair_config.temperature = std::min(config.temperature, 0.2f);
+
+    auto& client = *pimpl_->llm_client;
+    auto& validator = *pimpl_->validator;
+    return runRepairLoop(
+        rewrite_prompt, near_misses,
+        pimpl_->strategy.max_repair_rounds,
+        pimpl_->strategy.max_repair_differences,
+        [&client, &repair_config](const std::string& prompt) {
+            return client.generateFromPrompt(prompt, repair_config);
+        },
+        [&validator, &original_sql](std::string_view candidate) {
+            return validator.validate(original_sql, std::string(candidate));
+        });
+}
+
+int HeimdallOptimizer::selectBestCandidate(
+    const std::string& original_sql,
+    const std::vector<std::string_view>& validated_candidates,
+    void* thd,
+    double* original_cost,
+    double* chosen_cost) {
+    const OptimizationStrategy& strategy = pimpl_->strategy;
+    const double required = requiredRatio(strategy);
+    const bool first_valid =
+        strategy.selection_mode == OptimizationStrategy::SelectionMode::FIRST_VALID;
+
+    // 原始SQL与候选作为一批估算，costs[0]为原始代价
+    std::vector<std::string_view> batch;
+    batch.reserve(validated_candidates.size() + 1);
+    batch.push_back(original_sql);
+    if (first_valid) {
+        batch.push_back(validated_candidates.front());
+    } else {
+        batch.insert(batch.end(), validated_candidates.begin(), validated_candidates.end());
+    }
+    const std::vector<double> costs = estimateCosts(batch, thd);
+    *original_cost = costs[0];
+
+    if (first_valid) {
+        *chosen_cost = costs[1];
+        if (*original_cost < 0 || *chosen_cost <= 0) {
+            return 0;  // 代价未知时按首个有效候选采用
+        }
+        return *original_cost / *chosen_cost >= required ? 0 : -1;
+    }
+
+    if (*original_cost <= 0) {
+        return -1;
+    }
+    int best = -1;
+    double best_cost = 0.0;
+    for (size_t i = 0; i < validated_candidates.size(); ++i) {
+        const double cost = costs[i + 1];
+        if (cost > 0 && (best < 0 || cost < best_cost)) {
+            best = static_cast<int>(i);
+            best_cost = cost;
+        }
+    }
+    if (best < 0 || *original_cost / best_cost < required) {
+        return -1;
+    }
+    *chosen_cost = best_cost;
+    return best;
+}
+
+double HeimdallOptimizer::estimateCost(const std::string& sql, void* thd) {
+    Impl& impl = *pimpl_;
+    if (!impl.cost_estimator) {
+        return -1.0;
+    }
+    if (!impl.cost_cache) {
+        return impl.estimateUncached(sql, thd);
+    }
+    const uint64_t fingerprint = computeStatementFingerprint(sql);
+    const uint64_t version = statisticsVersionOf(sql);
+    double cost = -1.0;
+    if (impl.cost_cache->lookup(fingerprint, version, &cost)) {
+        return cost;
+    }
+    cost = impl.estimateUncached(sql, thd);
+    impl.cost_cache->insert(fingerprint, version, cost);
+    return cost;
+}
+
+uint64_t HeimdallOptimizer::statisticsVersionOf(std::string_view sql) const {
+    const Impl& impl = *pimpl_;
+    uint64_t combined = 0;
+    std::unordered_set<std::string> seen;
+    TableVisitor visitor = [&](std::string_view table) {
+        std::string key = lowerCopy(table);
+        if (!seen.insert(key).second) {
+            return;
+        }
+        // 与表名一起混入，统计信息回退到别的表的同一版本号时组合值也不同
+        const uint64_t h = std::hash<std::string>()(key) ^
+                           (impl.statsVersion(key) * 0x9e3779b97f4a7c15ULL);
+        combined ^= h + 0x9e3779b97f4a7c15ULL + (combined << 6) + (combined >> 2);
+    };
+    extractQueryFeatures(sql, &visitor);
+    return combined;
+}
+
+std::vector<double> HeimdallOptimizer::estimateCosts(
+    const std::vector<std::string_view>& sqls, void* thd) {
+    Impl& impl = *pimpl_;
+    if (!impl.cost_pool || !impl.cost_estimator || sqls.size() < 2) {
+        std::vector<double> costs;
+        costs.reserve(sqls.size());
+        for (auto sql : sqls) {
+            costs.push_back(estimateCost(std::string(sql), thd));
+        }
+        return costs;
+    }
+
+    if (!impl.cost_cache) {
+        return impl.cost_pool->estimateAll(sqls);
+    }
+    std::vector<double> costs(sqls.size(), -1.0);
+    // 只把缓存未命中的语句分发给工作线程
+    std::vector<size_t> missing;
+    std::vector<std::string_view> batch;
+    std::vector<std::pair<uint64_t, uint64_t>> keys(sqls.size());
+    for (size_t i = 0; i < sqls.size(); ++i) {
+        keys[i] = {computeStatementFingerprint(sqls[i]), statisticsVersionOf(sqls[i])};
+        if (!impl.cost_cache->lookup(keys[i].first, keys[i].second, &costs[i])) {
+            missing.push_back(i);
+            batch.push_back(sqls[i]);
+        }
+    }
+    if (batch.size() == 1) {
+        costs[missing[0]] = impl.estimateUncached(std::string(batch[0]), thd);
+    } else if (!batch.empty()) {
+        const std::vector<double> estimated = impl.cost_pool->estimateAll(batch);
+        for (size_t k = 0; k < missing.size(); ++k) {
+            costs[missing[k]] = estimated[k];
+        }
+    }
+    for (size_t i : missing) {
+        impl.cost_cache->insert(keys[i].first, keys[i].second, costs[i]);
+    }
+    return costs;
+}
+
+void HeimdallOptimizer::setCostCache(std::shared_ptr<CostCache> cache) {
+    pimpl_->cost_cache = std::move(cache);
+}
+
+void HeimdallOptimizer::enableParallelCostEstimation(
+    size_t workers,
+    CostWorkerPool::ContextFactory context_factory,
+    CostWorkerPool::ContextDeleter context_deleter) {
+    pimpl_->cost_pool.reset();
+    if (workers == 0) {
+        return;
+    }
+    // 工作线程以自己的估算上下文代替调用方的thd
+    pimpl_->cost_pool.reset(new CostWorkerPool(
+        workers,
+        [this](const std::string& sql, void* context) {
+            return pimpl_->callEstimator(sql, context);
+        },
+        std::move(context_factory), std::move(context_deleter)));
+}
+
+} // namespace optimizer
+} // namespace heimdall
@@ -9,9 +9,26 @@
 #include "../validator/semantic_validator.h"
 #include "../llm_generator/llm_client.h"
 #include "../llm_generator/prompt_builder.h"
+#include "../llm_generator/candidate_budget.h"
+#include "../llm_generator/schema_cache.h"
+#include "../llm_generator/catalog_snapshot.h"
+#include "../llm_generator/example_store.h"
+#include "../llm_generator/prompt_snapshot.h"
+#include "candidate_ranker.h"
+#include "candidate_repair.h"
+#include "rewrite_prefetcher.h"
+#include "rewrite_cache.h"
+#include "background_optimizer.h"
+#include "query_classifier.h"
+#include "trigger_model.h"
+#include "cost_worker_pool.h"
+#include "cost_cache.h"
 #include <string>
+#include <string_view>
 #include <memory>
 #include <chrono>
+#include <functional>
+#include <vector>
 
 namespace heimdall {
 namespace optimizer {
@@ -30,12 +47,18 @@ struct OptimizationResult {
 
     struct Stats {
         int candidates_generated;      // 生成的候选数
+        int candidates_examined;       // 实际验证的候选数(FIRST_VALID在首个有效候选处停止)
         int candidates_validated;      // 验证通过的候选数
+        int chosen_candidate_index;    // 选中候选的生成顺序下标(-1表示无)
+        int candidates_repaired;       // 经修复轮次后验证通过的候选数
         double llm_time_ms;           // LLM生成时间
         double validation_time_ms;    // 验证时间
         double cost_estimation_time_ms;  // 代价估算时间
     } stats;
 
+    bool from_rewrite_cache;          // 重写来自RewriteCache（未调用LLM）
+    bool queued;                      // 已提交后台优化，本次按原计划执行
+
     std::string reason;               // 优化/未优化原因
 };
 
@@ -46,12 +69,22 @@ struct OptimizationStrategy {
     // 触发条件
     bool enable_for_subqueries;       // 包含子查询时触发
     bool enable_for_complex_joins;    // 复杂JOIN时触发
+    int min_table_count;              // 引用表数达到该值视为复杂JOIN
+    int min_in_list_size;             // IN列表达到该长度时触发(0表示禁用)
     int min_estimated_cost;           // 最小估算代价阈值
+    bool use_trigger_model;           // 通过初筛与代价检查后，再由TriggerModel预测收益
 
     // 生成配置
     int max_candidates;               // 最大候选数
+    bool adaptive_candidates;         // 按查询类别自适应候选数与温度
+    bool prerank_candidates;          // 验证前按形状特征预排序候选
+    int prerank_top_k;                // 预排序后只验证得分最高的K个(0表示全部)
     double validation_timeout_sec;    // 验证超时
 
+    // 修复策略：对差异小而具体的失败候选发起一次纠正轮次
+    int max_repair_rounds;            // 每次优化最多的修复轮次(0表示禁用)
+    int max_repair_differences;       // 可修复的最大差异条数
+
     // 选择策略
     enum class SelectionMode {
         BEST_COST,                    // 选择代价最低
@@ -61,14 +94,26 @@ struct OptimizationStrategy {
 
     double min_improvement_ratio;     // 最小改进比率
 
+    // 分层优化：查询路径只查RewriteCache，未命中时提交后台优化并按原计划执行
+    bool async_optimization;
+
     OptimizationStrategy()
         : enable_for_subqueries(true),
           enable_for_complex_joins(true),
+          min_table_count(2),
+          min_in_list_size(32),
           min_estimated_cost(1000),
+          use_trigger_model(false),
           max_candidates(5),
+          adaptive_candidates(true),
+          prerank_candidates(true),
+          prerank_top_k(0),
           validation_timeout_sec(10.0),
+          max_repair_rounds(1),
+          max_repair_differences(2),
           selection_mode(SelectionMode::BEST_COST),
-          min_improvement_ratio(1.2) {}
+          min_improvement_ratio(1.2),
+          async_optimization(false) {}
 };
 
 /**
@@ -86,6 +131,9 @@ public:
 
     /**
      * @brief 优化SQL查询
+     *
+     * async_optimization开启时不在调用线程上调用LLM：RewriteCache命中且
+     * 能套用到当前字面量时直接返回重写，否则提交后台优化并返回optimized=false
      */
     OptimizationResult optimize(const std::string& sql,
                                void* txsql_thd = nullptr);
@@ -105,6 +153,169 @@ public:
      */
     void setValidator(std::shared_ptr<validator::SemanticValidator> validator);
 
+    /**
+     * @brief 表结构查询回调，找到时填充schema并返回true
+     *
+     * 由TXSQL从数据字典提供；构建Prompt时对查询引用到的每张表调用一次
+     */
+    using SchemaProvider =
+        std::function<bool(std::string_view table_name, llm::TableSchema* schema)>;
+    void setSchemaProvider(SchemaProvider provider);
+
+    /**
+     * @brief 代价估算回调，返回负数表示估算失败
+     *
+     * 由TXSQL用thd对应会话的优化器代价模型实现；未设置时代价未知，
+     * 只有FIRST_VALID模式会在代价未知时采用候选。
+     * 后台优化、预取与shouldOptimize()的代价判断没有会话：启用并行代价估算时
+     * 这些估算改由工作线程以各自的上下文执行，否则thd为nullptr，实现须能处理
+     */
+    using CostEstimator = std::function<double(const std::string& sql, void* thd)>;
+    void setCostEstimator(CostEstimator estimator);
+
+    /**
+     * @brief 预算归属回调，返回语句所属的schema/用户，作为LLM预算的scope
+     *
+     * 由TXSQL按thd对应会话的当前库与用户实现；返回空串或未设置时
+     * 请求只受全局预算限制。只在有会话时调用，thd不为nullptr；
+     * 后台优化与预取没有会话，不调用此回调
+     */
+    using BudgetScopeResolver = std::function<std::string(const std::string& sql, void* thd)>;
+    void setBudgetScopeResolver(BudgetScopeResolver resolver);
+
+    /**
+     * @brief 设置自适应候选预算控制器
+     *
+     * adaptive_candidates开启时，按查询模板摘要调整每次请求的
+     * num_candidates/temperature，并在优化结束后回报生成/验证/选中情况
+     */
+    void setCandidateBudget(std::shared_ptr<llm::CandidateBudgetController> budget);
+
+    /**
+     * @brief 设置候选预排序器
+     *
+     * prerank_candidates开启时，候选按得分顺序进入验证与代价估算，
+     * FIRST_VALID模式下第一个通过验证的即为得分最高的有效候选
+     */
+    void setCandidateRanker(std::shared_ptr<CandidateRanker> ranker);
+
+    /**
+     * @brief 记录一次查询执行，累积到按模板摘要聚合的执行统计
+     *
+     * 由TXSQL在语句执行结束后调用，是预取器挑选热点慢查询的依据；
+     * 启用预取时顺带按poll_interval触发一轮预取
+     */
+    void recordExecution(const std::string& sql, double latency_ms);
+
+    /**
+     * @brief 启用空闲时预取
+     *
+     * LLM客户端没有进行中的请求时，把最热且不在RewriteCache中的慢查询模板
+     * 提交后台优化队列（未启用分层优化时按默认配置创建），生成的重写写入
+     * RewriteCache，用户再次执行时直接命中
+     */
+    void enablePrefetch(const PrefetchConfig& config = PrefetchConfig());
+    void disablePrefetch();
+
+    /**
+     * @brief 启用分层（后台）优化
+     *
+     * 同时打开策略中的async_optimization。后台线程对提交的模板执行完整的
+     * 生成-验证-代价比较流程，得到满足min_improvement_ratio的重写后写入RewriteCache
+     */
+    void enableAsyncOptimization(const AsyncOptimizationConfig& config = AsyncOptimizationConfig());
+    void disableAsyncOptimization();
+
+    /**
+     * @brief 设置重写缓存，默认使用优化器内部实例
+     */
+    void setRewriteCache(std::shared_ptr<RewriteCache> cache);
+    std::shared_ptr<RewriteCache> getRewriteCache() const;
+
+    /**
+     * @brief 设置Schema片段缓存，与PromptBuilder共享同一实例
+     */
+    void setSchemaCache(std::shared_ptr<llm::SchemaRenderCache> cache);
+
+    /**
+     * @brief 表结构发生变化（DDL提交）时调用
+     *
+     * 递增该表的结构版本（表名不区分大小写），使其Schema片段失效，
+     * 并删除RewriteCache中基于旧版本、引用该表的重写
+     */
+    void onSchemaChanged(const std::string& table_name);
+
+    /**
+     * @brief 表统计信息更新（ANALYZE）后调用
+     *
+     * 删除RewriteCache中基于更旧统计信息生成的、引用该表的重写；
+     * 记录新版本，引用该表的语句的缓存代价在下次查找时失效
+     */
+    void onStatisticsChanged(const std::string& table_name, uint64_t stats_version);
+
+    /**
+     * @brief 设置目录统计快照
+     *
+     * 构建Prompt前用快照为Schema补充行数、列NDV与索引定义
+     */
+    void setCatalogSnapshot(std::shared_ptr<llm::CatalogSnapshot> snapshot);
+
+    /**
+     * @brief 设置Prompt快照发布器
+     *
+     * 各连接线程构建Prompt时取当前快照，共享同一份配置与示例库；
+     * 示例库、提示词等运行期修改在副本上完成后原子替换发布，读者不等待写者。
+     * 默认使用优化器内部的发布器；设置后initialize()读取的Prompt配置与
+     * 已配置的示例库会重新发布到新发布器
+     */
+    void setPromptSnapshots(std::shared_ptr<llm::PromptSnapshotPublisher> prompts);
+
+    /**
+     * @brief 启用并行代价估算
+     *
+     * 原始SQL与所有验证通过的候选作为一批提交到CostWorkerPool，每个工作线程
+     * 使用context_factory创建的独立估算上下文；代价阶段耗时由各候选之和变为最大值。
+     * 结果按候选顺序合并，选择结果与串行估算一致
+     * @param workers 工作线程数，0表示恢复串行估算
+     */
+    void enableParallelCostEstimation(size_t workers,
+                                      CostWorkerPool::ContextFactory context_factory = nullptr,
+                                      CostWorkerPool::ContextDeleter context_deleter = nullptr);
+
+    /**
+     * @brief 设置代价估算缓存
+     *
+     * estimateCost先以语句指纹和所引用表统计信息版本的组合查缓存，
+     * 命中时不再调用优化器估算；与并行估算同时启用时只把未命中的语句分发给工作线程
+     */
+    void setCostCache(std::shared_ptr<CostCache> cache);
+
+    /**
+     * @brief 设置触发模型
+     *
+     * use_trigger_model开启时，shouldOptimize对通过规则与代价检查的查询再预测
+     * 成功概率与预期收益，任一低于阈值的跳过；每次得到候选的完整优化结束后
+     * 以结果在线训练模型
+     */
+    void setTriggerModel(std::shared_ptr<TriggerModel> model);
+
+    /**
+     * @brief 设置自动收集的Few-shot示例库
+     *
+     * 收录新示例后，按示例库价值排序重新加载示例并发布新的Prompt快照
+     */
+    void setExampleStore(std::shared_ptr<llm::ExampleStore> store);
+
+    /**
+     * @brief 回报重写的实测加速比
+     *
+     * 由TXSQL在执行重写后的语句、与原始语句的历史平均耗时比较后调用；
+     * 加速比达到阈值的(原始SQL, 重写, 加速比)被收录进示例库
+     */
+    void reportMeasuredSpeedup(const std::string& original_sql,
+                               const std::string& rewritten_sql,
+                               double speedup_ratio);
+
     /**
      * @brief 获取统计信息
      */
@@ -115,6 +326,11 @@ public:
         double avg_improvement_ratio;
         double avg_optimization_time_ms;
         uint64_t cache_hits;
+        uint64_t budget_rejections;    // 因LLM预算不足跳过的优化数
+        uint64_t prefetched_rewrites;  // 空闲时提交预取的模板数
+        uint64_t rewrite_cache_hits;   // 直接套用缓存重写的查询数
+        uint64_t async_enqueued;       // 提交后台优化的模板数
+        uint64_t model_skipped;        // 触发模型预测收益过低而跳过的查询数
     };
     Statistics getStatistics() const;
 
@@ -134,15 +350,46 @@ private:
     std::unique_ptr<Impl> pimpl_;
 
     // 核心流程
+    // 先用classifyQuery()按触发条件初筛，只有初筛通过的语句才调用
+    // estimateCost()与min_estimated_cost比较，最后由触发模型（若启用）决定
     bool shouldOptimize(const std::string& sql);
-    std::vector<std::string> generateCandidates(const std::string& sql);
-    std::vector<std::string> validateCandidates(
+    // 完整的同步优化流程，后台线程与同步模式共用
+    OptimizationResult optimizeNow(const std::string& sql, void* thd);
+    // optimizeNow()，成功时连同所引用表的版本写入RewriteCache；
+    // 版本在生成开始前取得，期间发生的DDL/ANALYZE会使写入被拒绝
+    OptimizationResult optimizeAndCache(const std::string& sql, void* thd);
+    // 候选为指向共享响应缓冲的视图，调用方持有返回的响应直到选择结束；
+    // prompt返回本次的重写Prompt，修复轮次以它为前缀；
+    // config中按查询确定的字段（语法约束）在此填入，修复轮次沿用
+    llm::LLMResponsePtr generateCandidates(const std::string& sql,
+                                           llm::GenerationConfig* config,
+                                           std::string* prompt);
+    // 返回通过验证的候选；未通过但差异小而具体的候选写入near_misses
+    std::vector<std::string_view> validateCandidates(
+        const std::string& original_sql,
+        const std::vector<std::string_view>& candidates,
+        std::vector<NearMiss>* near_misses);
+    // 将近似正确的失败候选与验证差异发回LLM纠正(runRepairLoop)，
+    // 轮次受max_repair_rounds限制
+    RepairResult repairCandidates(
         const std::string& original_sql,
-        const std::vector<std::string>& candidates);
-    std::string selectBestCandidate(
+        const std::string& rewrite_prompt,
+        const llm::GenerationConfig& config,
+        const std::vector<NearMiss>& near_misses);
+    // 返回选中候选在validated_candidates中的下标，没有满足改进要求的候选时为-1
+    int selectBestCandidate(
         const std::string& original_sql,
-        const std::vector<std::string>& validated_candidates);
+        const std::vector<std::string_view>& validated_candidates,
+        void* thd,
+        double* original_cost,
+        double* chosen_cost);
     double estimateCost(const std::string& sql, void* thd);
+    // 语句引用各表stats_version的组合（CatalogSnapshot与onStatisticsChanged()推送中
+    // 较新者），作为代价缓存键的一部分
+    uint64_t statisticsVersionOf(std::string_view sql) const;
+    // 启用并行估算时分发到CostWorkerPool，否则逐条调用estimateCost；
+    // 返回值与sqls一一对应，失败为负数
+    std::vector<double> estimateCosts(const std::vector<std::string_view>& sqls, void* thd);
 };
 
 /**
@@ -165,6 +412,22 @@ public:
      */
     static int optimizerCallback(void* thd, void* query_block);
 
+    /**
+     * @brief DDL回调
+     *
+     * TXSQL在CREATE/ALTER/DROP/RENAME TABLE提交后调用，
+     * 转发给全局优化器实例的onSchemaChanged()
+     */
+    static void schemaChangeCallback(const char* table_name);
+
+    /**
+     * @brief 统计信息回调
+     *
+     * TXSQL在ANALYZE TABLE或持久化统计信息自动重算后调用，
+     * 转发给全局优化器实例的onStatisticsChanged()
+     */
+    static void statisticsChangeCallback(const char* table_name, uint64_t stats_version);
+
     /**
      * @brief 获取全局优化器实例
      */
@@ -0,0 +1,256 @@
+/**
+ * @file query_classifier.cpp
+ * @brief shouldOptimize快速初筛实现
+ */
+
+#include "query_classifier.h"
+#include "../llm_generator/sql_lexer.h"
+#include <cstdint>
+
+namespace heimdall {
+namespace optimizer {
+
+namespace {
+
+constexpr int kMaxTrackedDepth = 64;
+using llm::SqlKeyword;
+using llm::SqlLexer;
+using llm::SqlToken;
+using llm::SqlTokenType;
+
+class Classifier {
+public:
+    Classifier(std::string_view sql, const ClassifierRules& rules)
+        : sql_(sql), rules_(rules) {
+        result_.candidate = false;
+        result_.verdict = ClassifierVerdict::NO_TRIGGER;
+        result_.statement_type = StatementType::OTHER;
+        result_.subquery_count = 0;
+        result_.table_count = 0;
+        result_.max_in_list_size = 0;
+    }
+
+    QueryClassification run() {
+        SqlLexer lexer(sql_);
+        SqlToken token;
+        while (!done_ && lexer.next(token)) {
+            if (token.type == SqlTokenType::WORD) {
+                onWord(token.keyword());
+                continue;
+            }
+            if (token.type != SqlTokenType::PUNCT) {
+                onOperand();
+                continue;
+            }
+
+            switch (token.text[0]) {
+            case '(':
+                openParen();
+                break;
+            case ')':
+                closeParen();
+                break;
+            case ',':
+                onComma();
+                break;
+            default:
+                onOperand();
+                break;
+            }
+        }
+
+        if (!done_ && !statement_seen_) {
+            result_.verdict = ClassifierVerdict::UNSUPPORTED;
+        }
+        return result_;
+    }
+
+private:
+    std::string_view sql_;
+    const ClassifierRules& rules_;
+    QueryClassification result_;
+
+    int depth_ = 0;
+    uint64_t in_from_ = 0;       // 各层是否处于FROM子句（逗号即连接）
+    int list_depth_ = -1;        // 当前IN列表所在层，-1表示不在列表中
+    int list_size_ = 0;
+    bool statement_seen_ = false;
+    bool paren_opened_ = false;  // 刚遇到'('，等待判断括号类型
+    bool after_in_ = false;      // 上一个词法单元是IN
+    bool paren_after_in_ = false;
+    bool done_ = false;
+
+    static uint64_t bit(int depth) {
+        return (depth >= 0 && depth < kMaxTrackedDepth)
+                   ? (uint64_t{1} << depth) : 0;
+    }
+
+    void finish(bool candidate, ClassifierVerdict verdict) {
+        result_.candidate = candidate;
+        result_.verdict = verdict;
+        done_ = true;
+    }
+
+    void beginList() {
+        if (paren_opened_ && paren_after_in_) {
+            list_depth_ = depth_;
+            list_size_ = 1;
+        }
+        paren_opened_ = false;
+        after_in_ = false;
+    }
+
+    void onOperand() {
+        beginList();
+    }
+
+    void openParen() {
+        ++depth_;
+        in_from_ &= ~bit(depth_);
+        paren_after_in_ = after_in_;
+        paren_opened_ = true;
+        after_in_ = false;
+    }
+
+    void closeParen() {
+        if (list_depth_ == depth_) {
+            if (list_size_ > result_.max_in_list_size) {
+                result_.max_in_list_size = list_size_;
+            }
+            list_depth_ = -1;
+        }
+        in_from_ &= ~bit(depth_);
+        if (depth_ > 0) --depth_;
+        paren_opened_ = false;
+        after_in_ = false;
+    }
+
+    void onComma() {
+        if (in_from_ & bit(depth_)) {
+            addTable();
+        } else if (list_depth_ == depth_) {
+            ++list_size_;
+            if (rules_.min_in_list_size > 0 && list_size_ >= rules_.min_in_list_size) {
+                result_.max_in_list_size = list_size_;
+                finish(true, ClassifierVerdict::LARGE_IN_LIST);
+            }
+        }
+        paren_opened_ = false;
+        after_in_ = false;
+    }
+
+    void addTable() {
+        ++result_.table_count;
+        if (rules_.enable_for_complex_joins &&
+            result_.table_count >= rules_.min_table_count) {
+            finish(true, ClassifierVerdict::COMPLEX_JOIN);
+        }
+    }
+
+    void onSubquery() {
+        ++result_.subquery_count;
+        if (rules_.enable_for_subqueries) {
+            finish(true, ClassifierVerdict::SUBQUERY);
+        }
+    }
+
+    void setStatement(StatementType type) {
+        result_.statement_type = type;
+        statement_seen_ = true;
+    }
+
+    void onWord(SqlKeyword kw) {
+        const bool opened = paren_opened_;
+        beginList();
+
+        if (!statement_seen_) {
+            onFirstWord(kw);
+            return;
+        }
+
+        switch (kw) {
+        case SqlKeyword::SELECT:
+            // "(SELECT"为子查询；INSERT ... SELECT等顶层SELECT继续按查询扫描
+            if (opened) {
+                if (list_depth_ == depth_) list_depth_ = -1;
+                onSubquery();
+            }
+            break;
+        case SqlKeyword::FROM:
+            in_from_ |= bit(depth_);
+            addTable();
+            break;
+        case SqlKeyword::JOIN:
+        case SqlKeyword::STRAIGHT_JOIN:
+            addTable();
+            break;
+        case SqlKeyword::IN:
+            after_in_ = true;
+            break;
+        case SqlKeyword::VALUES:
+        case SqlKeyword::VALUE:
+            if (depth_ == 0 && (result_.statement_type == StatementType::INSERT ||
+                                result_.statement_type == StatementType::REPLACE)) {
+                finish(false, ClassifierVerdict::UNSUPPORTED);
+            }
+            break;
+        case SqlKeyword::WHERE:
+        case SqlKeyword::ON:
+        case SqlKeyword::USING:
+        case SqlKeyword::SET:
+        case SqlKeyword::GROUP:
+        case SqlKeyword::ORDER:
+        case SqlKeyword::HAVING:
+        case SqlKeyword::LIMIT:
+        case SqlKeyword::UNION:
+        case SqlKeyword::INTERSECT:
+        case SqlKeyword::EXCEPT:
+        case SqlKeyword::WINDOW:
+            in_from_ &= ~bit(depth_);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void onFirstWord(SqlKeyword kw) {
+        switch (kw) {
+        case SqlKeyword::SELECT:
+            setStatement(StatementType::SELECT);
+            break;
+        case SqlKeyword::UPDATE:
+            setStatement(StatementType::UPDATE);
+            // UPDATE a, b SET ... 中的逗号同样是连接
+            in_from_ |= bit(depth_);
+            addTable();
+            break;
+        case SqlKeyword::DELETE:
+            setStatement(StatementType::DELETE);
+            break;
+        case SqlKeyword::INSERT:
+            setStatement(StatementType::INSERT);
+            break;
+        case SqlKeyword::REPLACE:
+            setStatement(StatementType::REPLACE);
+            break;
+        case SqlKeyword::WITH:
+            // 公共表表达式的"(SELECT"随后按子查询识别
+            setStatement(StatementType::SELECT);
+            break;
+        default:
+            setStatement(StatementType::OTHER);
+            finish(false, ClassifierVerdict::UNSUPPORTED);
+            break;
+        }
+    }
+};
+
+} // namespace
+
+QueryClassification classifyQuery(std::string_view sql, const ClassifierRules& rules) {
+    Classifier classifier(sql, rules);
+    return classifier.run();
+}
+
+} // namespace optimizer
+} // namespace heimdall
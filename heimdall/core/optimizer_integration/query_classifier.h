@@ -0,0 +1,64 @@
+/**
+ * @file query_classifier.h
+ * @brief shouldOptimize的快速初筛
+ */
+
+#ifndef HEIMDALL_QUERY_CLASSIFIER_H
+#define HEIMDALL_QUERY_CLASSIFIER_H
+
+#include "query_features.h"
+#include <string_view>
+
+namespace heimdall {
+namespace optimizer {
+
+/**
+ * @brief 初筛规则，对应OptimizationStrategy中的触发条件
+ */
+struct ClassifierRules {
+    bool enable_for_subqueries;    // 含子查询/CTE时进入代价检查
+    bool enable_for_complex_joins; // 引用表数达到min_table_count时进入代价检查
+    int min_table_count;
+    int min_in_list_size;          // IN字面量列表达到该长度时进入代价检查(0表示不检查)
+
+    ClassifierRules()
+        : enable_for_subqueries(true),
+          enable_for_complex_joins(true),
+          min_table_count(2),
+          min_in_list_size(32) {}
+};
+
+/**
+ * @brief 初筛结论
+ */
+enum class ClassifierVerdict {
+    SUBQUERY,          // 含子查询或CTE
+    COMPLEX_JOIN,      // 多表连接
+    LARGE_IN_LIST,     // 长IN列表
+    NO_TRIGGER,        // 可优化的语句类型，但没有值得重写的结构
+    UNSUPPORTED        // INSERT ... VALUES、SET、SHOW、事务控制等
+};
+
+struct QueryClassification {
+    bool candidate;                // 是否值得进入代价检查
+    ClassifierVerdict verdict;
+    StatementType statement_type;
+    int subquery_count;            // 以下计数只覆盖触发前已扫描的部分
+    int table_count;
+    int max_in_list_size;
+};
+
+/**
+ * @brief 单遍扫描SQL，判断是否值得进入基于代价的检查
+ *
+ * 与extractQueryFeatures()共用llm::SqlLexer（跳过注释、字符串、反引号标识符），
+ * 但只识别决定结论所需的少数关键字，不分配内存、不回调；任一触发条件满足或首个单词表明语句不可优化时立即返回。
+ * 典型OLTP语句在1微秒内得出结论，shouldOptimize只对candidate为true的语句估算代价。
+ */
+QueryClassification classifyQuery(std::string_view sql,
+                                  const ClassifierRules& rules = ClassifierRules());
+
+} // namespace optimizer
+} // namespace heimdall
+
+#endif
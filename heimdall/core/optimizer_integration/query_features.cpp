@@ -0,0 +1,322 @@
+/**
+ * @file query_features.cpp
+ * @brief SQL形状特征提取实现
+ */
+
+#include "query_features.h"
+#include "../llm_generator/sql_lexer.h"
+#include <cstdint>
+
+namespace heimdall {
+namespace optimizer {
+
+namespace {
+
+using llm::SqlKeyword;
+using llm::SqlLexer;
+using llm::SqlToken;
+using llm::SqlTokenType;
+
+constexpr int kMaxTrackedDepth = 64;
+
+/**
+ * @brief 上一个有意义的词法单元
+ */
+enum class Prev {
+    NONE, TABLE_START, IN, GROUP, ORDER, OTHER
+};
+
+class FeatureScanner {
+public:
+    FeatureScanner(std::string_view sql, const TableVisitor* visitor)
+        : lexer_(sql), visitor_(visitor) {}
+
+    QueryFeatures run() {
+        SqlToken token;
+        while (lexer_.next(token)) {
+            if (token.isLiteral()) {
+                onLiteral();
+                continue;
+            }
+            if (token.isIdentifier()) {
+                if (prev_ == Prev::TABLE_START && !paren_opened_) {
+                    readTableName(token);
+                } else if (token.type == SqlTokenType::QUOTED_IDENTIFIER) {
+                    onIdentifier();
+                } else {
+                    onWord(token.keyword());
+                }
+                continue;
+            }
+
+            switch (token.text[0]) {
+            case '(':
+                openParen();
+                break;
+            case ')':
+                closeParen();
+                break;
+            case ',':
+                onComma();
+                break;
+            default:
+                paren_opened_ = false;
+                prev_ = Prev::OTHER;
+                break;
+            }
+        }
+        return features_;
+    }
+
+private:
+    SqlLexer lexer_;
+    const TableVisitor* visitor_;
+    QueryFeatures features_;
+
+    int depth_ = 0;
+    uint64_t in_from_ = 0;      // 各层是否处于FROM子句
+    uint64_t in_list_ = 0;      // 各层是否为IN字面量列表
+    uint64_t subquery_ = 0;     // 各层是否为子查询括号
+    int in_list_size_[kMaxTrackedDepth] = {};
+    bool statement_seen_ = false;
+    bool with_clause_ = false;
+    bool paren_opened_ = false;  // 刚遇到'('，等待判断括号类型
+    bool paren_after_in_ = false;
+    Prev prev_ = Prev::NONE;
+
+    static uint64_t bit(int depth) {
+        return (depth >= 0 && depth < kMaxTrackedDepth)
+                   ? (uint64_t{1} << depth) : 0;
+    }
+
+    // 读取可能带库名限定的表名，回调最后一段
+    void readTableName(const SqlToken& first) {
+        std::string_view name = first.text;
+        for (;;) {
+            SqlLexer ahead(lexer_);
+            SqlToken dot;
+            SqlToken part;
+            if (!ahead.next(dot) || !dot.isPunct('.') || dot.space_before ||
+                !ahead.next(part) || !part.isIdentifier() || part.space_before) {
+                break;
+            }
+            name = part.text;
+            lexer_ = ahead;
+        }
+        ++features_.table_refs;
+        if (visitor_ && *visitor_ && !name.empty()) {
+            (*visitor_)(name);
+        }
+        prev_ = Prev::OTHER;
+    }
+
+    void onLiteral() {
+        if (paren_opened_ && paren_after_in_) {
+            in_list_ |= bit(depth_);
+            if (depth_ < kMaxTrackedDepth) {
+                in_list_size_[depth_] = 1;
+            }
+        }
+        paren_opened_ = false;
+        prev_ = Prev::OTHER;
+    }
+
+    void onIdentifier() {
+        paren_opened_ = false;
+        prev_ = Prev::OTHER;
+    }
+
+    void openParen() {
+        ++depth_;
+        in_from_ &= ~bit(depth_);
+        in_list_ &= ~bit(depth_);
+        subquery_ &= ~bit(depth_);
+        paren_after_in_ = (prev_ == Prev::IN);
+        paren_opened_ = true;
+        prev_ = Prev::OTHER;
+    }
+
+    void closeParen() {
+        if ((in_list_ & bit(depth_)) && depth_ < kMaxTrackedDepth &&
+            in_list_size_[depth_] > features_.max_in_list_size) {
+            features_.max_in_list_size = in_list_size_[depth_];
+        }
+        in_from_ &= ~bit(depth_);
+        in_list_ &= ~bit(depth_);
+        subquery_ &= ~bit(depth_);
+        if (depth_ > 0) --depth_;
+        paren_opened_ = false;
+        prev_ = Prev::OTHER;
+    }
+
+    void onComma() {
+        if (in_from_ & bit(depth_)) {
+            ++features_.join_count;
+            prev_ = Prev::TABLE_START;
+        } else {
+            if ((in_list_ & bit(depth_)) && depth_ < kMaxTrackedDepth) {
+                ++in_list_size_[depth_];
+            }
+            prev_ = Prev::OTHER;
+        }
+        paren_opened_ = false;
+    }
+
+    int subqueryDepth() const {
+        int count = 0;
+        for (uint64_t bits = subquery_; bits; bits &= bits - 1) ++count;
+        return count;
+    }
+
+    void setStatementType(StatementType type) {
+        features_.statement_type = type;
+        statement_seen_ = true;
+    }
+
+    void onWord(SqlKeyword kw) {
+        const bool opened = paren_opened_;
+        paren_opened_ = false;
+
+        if (kw == SqlKeyword::SELECT) {
+            // 语句开头的括号（如"(SELECT ...) UNION ..."）不算子查询
+            if (opened && statement_seen_) {
+                subquery_ |= bit(depth_);
+                ++features_.subquery_count;
+                if (paren_after_in_) ++features_.in_subquery_count;
+                const int d = subqueryDepth();
+                if (d > features_.max_nesting_depth) features_.max_nesting_depth = d;
+            }
+            if (!statement_seen_ && (!with_clause_ || depth_ == 0)) {
+                setStatementType(StatementType::SELECT);
+            }
+            prev_ = Prev::OTHER;
+            return;
+        }
+
+        if (opened && paren_after_in_) {
+            // IN (col, ...) 或 IN (expr, ...) 同样按列表计数
+            in_list_ |= bit(depth_);
+            if (depth_ < kMaxTrackedDepth) in_list_size_[depth_] = 1;
+        }
+
+        if (kw == SqlKeyword::WITH && !statement_seen_) {
+            with_clause_ = true;
+            prev_ = Prev::OTHER;
+            return;
+        }
+
+        switch (kw) {
+        case SqlKeyword::FROM:
+            in_from_ |= bit(depth_);
+            prev_ = Prev::TABLE_START;
+            break;
+        case SqlKeyword::JOIN:
+        case SqlKeyword::STRAIGHT_JOIN:
+            ++features_.join_count;
+            prev_ = Prev::TABLE_START;
+            break;
+        case SqlKeyword::IN:
+            prev_ = Prev::IN;
+            break;
+        case SqlKeyword::EXISTS:
+            ++features_.exists_count;
+            prev_ = Prev::OTHER;
+            break;
+        case SqlKeyword::WHERE:
+        case SqlKeyword::HAVING:
+        case SqlKeyword::ON:
+        case SqlKeyword::USING:
+        case SqlKeyword::WINDOW:
+            in_from_ &= ~bit(depth_);
+            prev_ = Prev::OTHER;
+            break;
+        case SqlKeyword::GROUP:
+            in_from_ &= ~bit(depth_);
+            prev_ = Prev::GROUP;
+            break;
+        case SqlKeyword::ORDER:
+            in_from_ &= ~bit(depth_);
+            prev_ = Prev::ORDER;
+            break;
+        case SqlKeyword::BY:
+            if (prev_ == Prev::GROUP) features_.has_group_by = true;
+            if (prev_ == Prev::ORDER) features_.has_order_by = true;
+            prev_ = Prev::OTHER;
+            break;
+        case SqlKeyword::LIMIT:
+            in_from_ &= ~bit(depth_);
+            features_.has_limit = true;
+            prev_ = Prev::OTHER;
+            break;
+        case SqlKeyword::UNION:
+        case SqlKeyword::INTERSECT:
+        case SqlKeyword::EXCEPT:
+            in_from_ &= ~bit(depth_);
+            ++features_.union_count;
+            prev_ = Prev::OTHER;
+            break;
+        case SqlKeyword::DISTINCT:
+            ++features_.distinct_count;
+            prev_ = Prev::OTHER;
+            break;
+        case SqlKeyword::OR:
+            ++features_.or_count;
+            prev_ = Prev::OTHER;
+            break;
+        case SqlKeyword::UPDATE:
+            if (!statement_seen_ && (!with_clause_ || depth_ == 0)) {
+                setStatementType(StatementType::UPDATE);
+                prev_ = Prev::TABLE_START;
+            } else {
+                prev_ = Prev::OTHER;
+            }
+            break;
+        case SqlKeyword::INSERT:
+        case SqlKeyword::REPLACE:
+        case SqlKeyword::DELETE:
+            if (!statement_seen_ && (!with_clause_ || depth_ == 0)) {
+                setStatementType(kw == SqlKeyword::INSERT    ? StatementType::INSERT
+                                 : kw == SqlKeyword::REPLACE ? StatementType::REPLACE
+                                                             : StatementType::DELETE);
+            }
+            prev_ = Prev::OTHER;
+            break;
+        case SqlKeyword::INTO:
+            if (features_.statement_type == StatementType::INSERT ||
+                features_.statement_type == StatementType::REPLACE) {
+                prev_ = Prev::TABLE_START;
+            } else {
+                prev_ = Prev::OTHER;
+            }
+            break;
+        case SqlKeyword::STRAIGHT:
+        case SqlKeyword::INNER:
+        case SqlKeyword::LEFT:
+        case SqlKeyword::RIGHT:
+        case SqlKeyword::OUTER:
+        case SqlKeyword::CROSS:
+        case SqlKeyword::NATURAL:
+        case SqlKeyword::FULL:
+            // JOIN修饰词，不改变期望表名的状态
+            if (prev_ != Prev::TABLE_START) prev_ = Prev::OTHER;
+            break;
+        default:
+            if (!statement_seen_ && depth_ == 0 && !with_clause_) {
+                setStatementType(StatementType::OTHER);
+            }
+            prev_ = Prev::OTHER;
+            break;
+        }
+    }
+};
+
+} // namespace
+
+QueryFeatures extractQueryFeatures(std::string_view sql,
+                                   const TableVisitor* visitor) {
+    FeatureScanner scanner(sql, visitor);
+    return scanner.run();
+}
+
+} // namespace optimizer
+} // namespace heimdall
@@ -0,0 +1,67 @@
+/**
+ * @file query_features.h
+ * @brief 基于字节扫描的轻量级SQL形状特征提取
+ */
+
+#ifndef HEIMDALL_QUERY_FEATURES_H
+#define HEIMDALL_QUERY_FEATURES_H
+
+#include <string_view>
+#include <functional>
+
+namespace heimdall {
+namespace optimizer {
+
+/**
+ * @brief 语句类型
+ */
+enum class StatementType {
+    SELECT, INSERT, UPDATE, DELETE, REPLACE, OTHER
+};
+
+/**
+ * @brief SQL形状特征
+ *
+ * 仅通过词法扫描得到，不解析SQL，也不访问数据字典
+ */
+struct QueryFeatures {
+    StatementType statement_type;
+    int table_refs;            // FROM/JOIN引用的表数量
+    int join_count;            // 显式JOIN与FROM中逗号连接的数量
+    int subquery_count;        // "(SELECT"出现次数（含派生表）
+    int max_nesting_depth;     // 子查询最大嵌套深度
+    int in_subquery_count;     // IN (SELECT ...)
+    int exists_count;          // EXISTS / NOT EXISTS
+    int max_in_list_size;      // 最长IN字面量列表长度
+    int distinct_count;        // DISTINCT出现次数
+    int union_count;           // UNION/INTERSECT/EXCEPT
+    int or_count;              // OR出现次数
+    bool has_group_by;
+    bool has_order_by;
+    bool has_limit;
+
+    QueryFeatures()
+        : statement_type(StatementType::OTHER),
+          table_refs(0), join_count(0), subquery_count(0),
+          max_nesting_depth(0), in_subquery_count(0), exists_count(0),
+          max_in_list_size(0), distinct_count(0), union_count(0),
+          or_count(0), has_group_by(false), has_order_by(false),
+          has_limit(false) {}
+};
+
+/**
+ * @brief 表引用回调，参数为SQL中的表名视图（已去掉反引号）
+ */
+using TableVisitor = std::function<void(std::string_view table_name)>;
+
+/**
+ * @brief 单遍扫描SQL并提取形状特征
+ * @param visitor 可选，每遇到一个FROM/JOIN表引用调用一次
+ */
+QueryFeatures extractQueryFeatures(std::string_view sql,
+                                   const TableVisitor* visitor = nullptr);
+
+} // namespace optimizer
+} // namespace heimdall
+
+#endif
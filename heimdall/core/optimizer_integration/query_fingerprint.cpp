@@ -0,0 +1,230 @@
+/**
+ * @file query_fingerprint.cpp
+ * @brief SQL模板指纹计算实现
+ */
+
+#include "query_fingerprint.h"
+#include "../llm_generator/sql_lexer.h"
+
+namespace heimdall {
+namespace optimizer {
+
+namespace {
+
+constexpr uint64_t kFnvOffsetBasis = 1469598103934665603ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+using llm::SqlKeyword;
+using llm::SqlLexer;
+using llm::SqlToken;
+using llm::SqlTokenType;
+using llm::isSqlWordChar;
+using llm::toLowerAscii;
+
+/**
+ * @brief 单遍规范化器，输出逐字节写入Sink
+ *
+ * Sink为可调用对象 void(char)，可以是哈希或字符串追加
+ */
+template <typename Sink>
+class Normalizer {
+public:
+    explicit Normalizer(Sink& sink) : sink_(sink) {}
+
+    void run(std::string_view sql) {
+        SqlLexer lexer(sql);
+        SqlToken token;
+        while (lexer.next(token)) {
+            // 空白与注释只记录为单词间可能需要的一个空格
+            pending_space_ = token.space_before;
+
+            switch (token.type) {
+            case SqlTokenType::STRING:
+            case SqlTokenType::NUMBER:
+                emitLiteral();
+                continue;
+            case SqlTokenType::QUOTED_IDENTIFIER:
+                // 反引号标识符：去掉引号，按普通标识符处理
+                beginWord();
+                for (size_t k = 0; k < token.text.size(); ++k) {
+                    put(toLowerAscii(token.text[k]));
+                    if (token.text[k] == '`') ++k;
+                }
+                continue;
+            case SqlTokenType::WORD:
+                beginWord();
+                for (char c : token.text) {
+                    put(toLowerAscii(c));
+                }
+                onWord(token.keyword());
+                continue;
+            default:
+                break;
+            }
+
+            const char c = token.text[0];
+
+            // 结尾分号
+            if (c == ';' && onlySemicolonsFollow(lexer)) {
+                break;
+            }
+
+            // IN/VALUES列表中的逗号延迟输出，以便折叠 "?,?,?"
+            if (c == ',' && last_literal_ && !deferred_comma_ &&
+                depth_ == list_depth_) {
+                deferred_comma_ = true;
+                pending_space_ = false;
+                continue;
+            }
+
+            flushComma();
+            put(c);
+            onPunct(c);
+            last_literal_ = false;
+            pending_space_ = false;
+        }
+        flushComma();
+    }
+
+private:
+    Sink& sink_;
+    char last_ = '\0';
+    bool pending_space_ = false;
+    bool last_literal_ = false;
+    bool deferred_comma_ = false;
+
+    // 只折叠IN (...)与VALUES (...)中的字面量列表；函数参数等其余括号内的
+    // 字面量个数属于模板的一部分，SUBSTR(x,1,3)与SUBSTR(x,1)摘要不同
+    int depth_ = 0;
+    int list_depth_ = -1;      // 当前可折叠列表所在的括号层，-1表示不在列表中
+    int values_depth_ = -1;    // VALUES所在层，其后每个"("开始一行
+    bool expect_list_ = false; // 上一个词法单元是IN/VALUES，或VALUES行之间的逗号
+
+    static bool onlySemicolonsFollow(SqlLexer lexer) {
+        SqlToken token;
+        while (lexer.next(token)) {
+            if (!token.isPunct(';')) return false;
+        }
+        return true;
+    }
+
+    void onWord(SqlKeyword kw) {
+        expect_list_ = false;
+        if (kw == SqlKeyword::IN) {
+            expect_list_ = true;
+        } else if (kw == SqlKeyword::VALUES || kw == SqlKeyword::VALUE) {
+            expect_list_ = true;
+            values_depth_ = depth_;
+        } else if (depth_ == values_depth_) {
+            // ON DUPLICATE KEY UPDATE等，VALUES行结束
+            values_depth_ = -1;
+        }
+    }
+
+    void onPunct(char c) {
+        const bool expected = expect_list_;
+        expect_list_ = false;
+        if (c == '(') {
+            ++depth_;
+            if (expected) {
+                list_depth_ = depth_;
+            }
+        } else if (c == ')') {
+            if (list_depth_ == depth_) {
+                list_depth_ = -1;
+            }
+            if (depth_ > 0) --depth_;
+            if (depth_ < values_depth_) {
+                values_depth_ = -1;
+            }
+        } else if (c == ',' && depth_ == values_depth_) {
+            expect_list_ = true;
+        }
+    }
+
+    void put(char c) {
+        sink_(c);
+        last_ = c;
+    }
+
+    // 仅在两个单词之间保留一个空格，其余空白全部丢弃
+    void beginWord() {
+        flushComma();
+        if (pending_space_ && (isSqlWordChar(last_) || last_ == '?')) {
+            put(' ');
+        }
+        pending_space_ = false;
+        last_literal_ = false;
+    }
+
+    void flushComma() {
+        if (deferred_comma_) {
+            put(',');
+            deferred_comma_ = false;
+        }
+    }
+
+    void emitLiteral() {
+        expect_list_ = false;
+        if (last_literal_ && deferred_comma_) {
+            deferred_comma_ = false;
+            pending_space_ = false;
+            return;
+        }
+        beginWord();
+        put('?');
+        last_literal_ = true;
+    }
+};
+
+} // namespace
+
+std::string normalizeQuery(std::string_view sql) {
+    std::string out;
+    out.reserve(sql.size());
+    auto sink = [&out](char c) { out.push_back(c); };
+    Normalizer<decltype(sink)> normalizer(sink);
+    normalizer.run(sql);
+    return out;
+}
+
+uint64_t computeQueryDigest(std::string_view sql) {
+    uint64_t hash = kFnvOffsetBasis;
+    auto sink = [&hash](char c) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= kFnvPrime;
+    };
+    Normalizer<decltype(sink)> normalizer(sink);
+    normalizer.run(sql);
+    return hash;
+}
+
+void extractLiterals(std::string_view sql, std::vector<std::string_view>* literals) {
+    literals->clear();
+    SqlLexer lexer(sql);
+    SqlToken token;
+    while (lexer.next(token)) {
+        if (token.isLiteral()) {
+            literals->push_back(token.text);
+        }
+    }
+}
+
+uint64_t computeStatementFingerprint(std::string_view sql) {
+    thread_local std::vector<std::string_view> literals;
+    extractLiterals(sql, &literals);
+    uint64_t hash = computeQueryDigest(sql);
+    for (auto literal : literals) {
+        for (char c : literal) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= kFnvPrime;
+        }
+        // 分隔符，避免相邻字面量拼接后混淆
+        hash ^= 0xFF;
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+} // namespace optimizer
+} // namespace heimdall
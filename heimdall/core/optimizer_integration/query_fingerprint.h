@@ -0,0 +1,53 @@
+/**
+ * @file query_fingerprint.h
+ * @brief SQL模板指纹（查询摘要）计算
+ */
+
+#ifndef HEIMDALL_QUERY_FINGERPRINT_H
+#define HEIMDALL_QUERY_FINGERPRINT_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <vector>
+
+namespace heimdall {
+namespace optimizer {
+
+/**
+ * @brief 规范化SQL文本为查询模板
+ *
+ * 规则：关键字/标识符转小写、空白与注释折叠为单个空格、
+ * 数值和字符串字面量替换为'?'、IN (...)与VALUES (...)中的连续字面量
+ * 折叠为单个'?'、去除结尾分号。仅字面量不同的查询得到相同模板；
+ * 函数参数不折叠，参数个数不同的调用得到不同模板。
+ */
+std::string normalizeQuery(std::string_view sql);
+
+/**
+ * @brief 计算查询模板的64位摘要
+ *
+ * 等价于对normalizeQuery()结果做FNV-1a哈希，但不分配内存
+ */
+uint64_t computeQueryDigest(std::string_view sql);
+
+/**
+ * @brief 按出现顺序提取SQL中的字面量
+ *
+ * 与normalizeQuery()替换为'?'的位置一一对应（IN列表不折叠），
+ * 字符串字面量包含引号。结果为指向sql的视图。
+ */
+void extractLiterals(std::string_view sql, std::vector<std::string_view>* literals);
+
+/**
+ * @brief 计算具体语句的64位指纹
+ *
+ * 在模板摘要的基础上再混入各字面量的取值：空白、注释和大小写不同但
+ * 字面量相同的语句指纹相同，字面量不同则不同（代价随谓词取值变化）
+ */
+uint64_t computeStatementFingerprint(std::string_view sql);
+
+} // namespace optimizer
+} // namespace heimdall
+
+#endif
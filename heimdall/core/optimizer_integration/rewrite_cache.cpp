@@ -0,0 +1,290 @@
+/**
+ * @file rewrite_cache.cpp
+ * @brief 重写缓存实现
+ */
+
+#include "rewrite_cache.h"
+#include "query_fingerprint.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace heimdall {
+namespace optimizer {
+
+namespace {
+
+int64_t nowTicks() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+std::string tableKey(const std::string& table) {
+    std::string key(table);
+    for (auto& c : key) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return key;
+}
+
+} // namespace
+
+bool bindRewrite(const CachedRewrite& rewrite, std::string_view sql,
+                 std::string* bound_sql) {
+    if (sql == rewrite.original_sql) {
+        *bound_sql = rewrite.rewritten_sql;
+        return true;
+    }
+
+    std::vector<std::string_view> from;
+    std::vector<std::string_view> to;
+    extractLiterals(rewrite.original_sql, &from);
+    extractLiterals(sql, &to);
+    if (from.size() != to.size()) {
+        return false;
+    }
+
+    // 原始字面量 -> (新取值, 在原文中的出现次数)
+    struct Binding {
+        std::string_view value;
+        size_t occurrences;
+    };
+    std::unordered_map<std::string_view, Binding> bindings;
+    for (size_t i = 0; i < from.size(); ++i) {
+        auto inserted = bindings.emplace(from[i], Binding{to[i], 1});
+        if (!inserted.second) {
+            // 同一取值在新SQL中对应了不同取值，无法判断重写中的该常量应换成哪个
+            if (inserted.first->second.value != to[i]) return false;
+            ++inserted.first->second.occurrences;
+        }
+    }
+
+    std::vector<std::string_view> literals;
+    extractLiterals(rewrite.rewritten_sql, &literals);
+    std::unordered_map<std::string_view, size_t> seen;
+    for (auto literal : literals) {
+        if (bindings.count(literal)) ++seen[literal];
+    }
+    for (const auto& binding : bindings) {
+        if (binding.first == binding.second.value) continue;
+        auto it = seen.find(binding.first);
+        if (it == seen.end() || it->second != binding.second.occurrences) {
+            return false;
+        }
+    }
+
+    const std::string& text = rewrite.rewritten_sql;
+    bound_sql->clear();
+    bound_sql->reserve(text.size() + sql.size());
+    size_t pos = 0;
+    for (auto literal : literals) {
+        auto it = bindings.find(literal);
+        if (it == bindings.end()) continue;
+        const size_t offset = static_cast<size_t>(literal.data() - text.data());
+        bound_sql->append(text, pos, offset - pos);
+        bound_sql->append(it->second.value.data(), it->second.value.size());
+        pos = offset + literal.size();
+    }
+    bound_sql->append(text, pos, std::string::npos);
+    return true;
+}
+
+RewriteCache::RewriteCache(size_t max_entries)
+    : max_entries_(std::max<size_t>(1, max_entries)),
+      shard_count_(std::min(kShards, std::max<size_t>(1, max_entries_ / 16))),
+      shard_capacity_(max_entries_ / shard_count_),
+      epoch_(1),
+      size_(0),
+      hits_(0),
+      misses_(0),
+      inserts_(0),
+      evictions_(0),
+      invalidations_(0),
+      stale_inserts_(0) {
+    for (auto& shard : shards_) {
+        shard = std::make_shared<const Shard>();
+    }
+}
+
+CachedRewritePtr RewriteCache::lookup(uint64_t digest) const {
+    const ShardPtr shard = std::atomic_load(&shards_[shardOf(digest)]);
+    auto it = shard->find(digest);
+    if (it == shard->end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    it->second->last_used.store(nowTicks(), std::memory_order_relaxed);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return it->second->rewrite;
+}
+
+bool RewriteCache::contains(uint64_t digest) const {
+    const ShardPtr shard = std::atomic_load(&shards_[shardOf(digest)]);
+    return shard->count(digest) > 0;
+}
+
+void RewriteCache::unlinkLocked(const CachedRewrite& rewrite) {
+    for (const auto& table : rewrite.tables) {
+        auto it = by_table_.find(tableKey(table.table));
+        if (it == by_table_.end()) continue;
+        it->second.erase(rewrite.digest);
+        if (it->second.empty()) by_table_.erase(it);
+    }
+}
+
+bool RewriteCache::insert(CachedRewrite rewrite) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    for (const auto& table : rewrite.tables) {
+        auto known = known_versions_.find(tableKey(table.table));
+        if (known != known_versions_.end() &&
+            ((rewrite.epoch != 0 && rewrite.epoch < known->second.invalidated_epoch) ||
+             table.schema_version < known->second.schema_version ||
+             table.stats_version < known->second.stats_version)) {
+            ++stale_inserts_;
+            return false;
+        }
+    }
+
+    const uint64_t digest = rewrite.digest;
+    const size_t index = shardOf(digest);
+    auto next = std::make_shared<Shard>(*std::atomic_load(&shards_[index]));
+
+    auto existing = next->find(digest);
+    if (existing != next->end()) {
+        unlinkLocked(*existing->second->rewrite);
+        next->erase(existing);
+        --size_;
+    } else if (next->size() >= shard_capacity_) {
+        auto victim = next->begin();
+        int64_t oldest = victim->second->last_used.load(std::memory_order_relaxed);
+        for (auto it = next->begin(); it != next->end(); ++it) {
+            const int64_t used = it->second->last_used.load(std::memory_order_relaxed);
+            if (used < oldest) {
+                oldest = used;
+                victim = it;
+            }
+        }
+        unlinkLocked(*victim->second->rewrite);
+        next->erase(victim);
+        --size_;
+        ++evictions_;
+    }
+
+    auto shared = std::make_shared<const CachedRewrite>(std::move(rewrite));
+    for (const auto& table : shared->tables) {
+        by_table_[tableKey(table.table)].insert(digest);
+    }
+    next->emplace(digest, std::make_shared<const Entry>(std::move(shared), nowTicks()));
+    ++size_;
+    ++inserts_;
+    std::atomic_store(&shards_[index], ShardPtr(std::move(next)));
+    return true;
+}
+
+size_t RewriteCache::removeLocked(const std::unordered_set<uint64_t>& digests) {
+    // 按分片分组，每个受影响的分片只复制一次
+    std::vector<std::vector<uint64_t>> grouped(shard_count_);
+    for (uint64_t digest : digests) {
+        grouped[shardOf(digest)].push_back(digest);
+    }
+    size_t removed = 0;
+    for (size_t index = 0; index < shard_count_; ++index) {
+        if (grouped[index].empty()) continue;
+        auto next = std::make_shared<Shard>(*std::atomic_load(&shards_[index]));
+        for (uint64_t digest : grouped[index]) {
+            auto it = next->find(digest);
+            if (it == next->end()) continue;
+            unlinkLocked(*it->second->rewrite);
+            next->erase(it);
+            ++removed;
+        }
+        std::atomic_store(&shards_[index], ShardPtr(std::move(next)));
+    }
+    size_ -= removed;
+    return removed;
+}
+
+void RewriteCache::erase(uint64_t digest) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    removeLocked({digest});
+}
+
+RewriteCache::KnownVersion& RewriteCache::advanceEpochLocked(const std::string& table) {
+    auto& known = known_versions_[table];
+    known.invalidated_epoch = epoch_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    return known;
+}
+
+template <typename Predicate>
+size_t RewriteCache::invalidateLocked(const std::string& table, Predicate stale) {
+    auto it = by_table_.find(table);
+    if (it == by_table_.end()) {
+        return 0;
+    }
+    std::unordered_set<uint64_t> victims;
+    for (uint64_t digest : it->second) {
+        const ShardPtr shard = std::atomic_load(&shards_[shardOf(digest)]);
+        auto entry = shard->find(digest);
+        if (entry == shard->end()) continue;
+        for (const auto& version : entry->second->rewrite->tables) {
+            if (tableKey(version.table) == table && stale(version)) {
+                victims.insert(digest);
+                break;
+            }
+        }
+    }
+    const size_t removed = removeLocked(victims);
+    invalidations_ += removed;
+    return removed;
+}
+
+size_t RewriteCache::invalidateSchema(const std::string& table, uint64_t schema_version) {
+    const std::string key = tableKey(table);
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    auto& known = advanceEpochLocked(key);
+    if (schema_version == 0) {
+        return invalidateLocked(key, [](const TableVersion&) { return true; });
+    }
+    known.schema_version = std::max(known.schema_version, schema_version);
+    return invalidateLocked(key, [schema_version](const TableVersion& version) {
+        return version.schema_version < schema_version;
+    });
+}
+
+size_t RewriteCache::invalidateStatistics(const std::string& table, uint64_t stats_version) {
+    const std::string key = tableKey(table);
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    auto& known = advanceEpochLocked(key);
+    known.stats_version = std::max(known.stats_version, stats_version);
+    return invalidateLocked(key, [stats_version](const TableVersion& version) {
+        return version.stats_version < stats_version;
+    });
+}
+
+size_t RewriteCache::size() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return size_;
+}
+
+void RewriteCache::clear() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    for (auto& shard : shards_) {
+        std::atomic_store(&shard, std::make_shared<const Shard>());
+    }
+    by_table_.clear();
+    size_ = 0;
+}
+
+RewriteCache::Stats RewriteCache::getStats() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.inserts = inserts_;
+    stats.evictions = evictions_;
+    stats.invalidations = invalidations_;
+    stats.stale_inserts = stale_inserts_;
+    return stats;
+}
+
+} // namespace optimizer
+} // namespace heimdall
@@ -0,0 +1,177 @@
+/**
+ * @file rewrite_cache.h
+ * @brief 按查询模板摘要缓存验证通过的重写
+ */
+
+#ifndef HEIMDALL_REWRITE_CACHE_H
+#define HEIMDALL_REWRITE_CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace heimdall {
+namespace optimizer {
+
+/**
+ * @brief 生成重写时所引用表的版本
+ */
+struct TableVersion {
+    std::string table;          // 表名（比较时不区分大小写）
+    uint64_t schema_version;
+    uint64_t stats_version;
+};
+
+/**
+ * @brief 一条已验证的重写
+ */
+struct CachedRewrite {
+    uint64_t digest;
+    std::string original_sql;       // 生成重写时的原始SQL
+    std::string rewritten_sql;      // 验证通过的重写
+    double cost_original;
+    double cost_optimized;
+    std::vector<TableVersion> tables;  // 重写依赖的表及其版本
+    std::chrono::steady_clock::time_point created;
+    uint64_t epoch = 0;             // 开始生成前取得的RewriteCache::epoch()，0表示未记录
+};
+
+using CachedRewritePtr = std::shared_ptr<const CachedRewrite>;
+
+/**
+ * @brief 把缓存的重写套用到同一模板的另一条SQL上
+ *
+ * 重写针对original_sql中的具体字面量生成。sql与original_sql字面量个数相同、
+ * 且original_sql中每个取值不同的字面量在重写里出现的次数与原文一致时，
+ * 将重写中的这些字面量依次替换为sql中对应位置的取值；否则无法确定对应关系，
+ * 返回false。重写自行引入的常量（如EXISTS (SELECT 1 ...)）保持不变。
+ */
+bool bindRewrite(const CachedRewrite& rewrite, std::string_view sql,
+                 std::string* bound_sql);
+
+/**
+ * @brief 重写缓存
+ *
+ * 以模板摘要为键。每条查询都要查一次缓存，因此读路径不取写锁：
+ * 摘要按低位分到若干分片，每个分片是一张不可变哈希表，lookup()只需
+ * 用std::atomic_load取得分片指针再查表。写入与失效在写锁下复制受影响的
+ * 分片、修改后原子替换，正在读取旧分片的线程不受影响。注意atomic_load/
+ * atomic_store(shared_ptr)并非无锁：libstdc++用按地址散列的自旋锁池实现，
+ * 读者只在复制指针、调整引用计数的瞬间持锁，不会等待写者复制分片。
+ *
+ * 每条重写记录所依赖表的schema/统计信息版本，并按表建立反向索引：
+ * 某表发生DDL或统计信息更新时只删除引用该表且版本落后的条目。
+ * 每次失效还会推进全局失效代数(epoch)并记在该表上；重写携带开始生成前
+ * 取得的epoch()，写入时若任一依赖表在此之后被失效过（后台优化期间发生了
+ * DDL/ANALYZE，即使版本未知），或记录的版本落后于已知版本，直接拒绝。
+ * 条目为共享只读对象，命中时只增加引用计数。容量超限时按近似LRU
+ * （命中时记录的时间戳）淘汰所在分片中最旧的条目。
+ */
+class RewriteCache {
+public:
+    explicit RewriteCache(size_t max_entries = 10000);
+
+    /**
+     * @brief 查找重写，未命中返回nullptr，不取写锁
+     */
+    CachedRewritePtr lookup(uint64_t digest) const;
+
+    /**
+     * @brief 当前失效代数，开始生成重写前取得并记入CachedRewrite::epoch
+     */
+    uint64_t epoch() const { return epoch_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 写入重写
+     * @return 依赖的表在rewrite.epoch之后被失效过或版本已过期时返回false
+     */
+    bool insert(CachedRewrite rewrite);
+
+    void erase(uint64_t digest);
+    bool contains(uint64_t digest) const;
+
+    /**
+     * @brief 表结构变更后调用
+     * @param schema_version 新版本；0表示未知，删除当前所有引用该表的条目
+     *        （两种情况都推进epoch，此前开始生成的重写无法再写入）
+     * @return 删除的条目数
+     */
+    size_t invalidateSchema(const std::string& table, uint64_t schema_version = 0);
+
+    /**
+     * @brief 统计信息更新后调用，删除基于更旧统计信息生成的条目
+     * @return 删除的条目数
+     */
+    size_t invalidateStatistics(const std::string& table, uint64_t stats_version);
+
+    size_t size() const;
+    void clear();
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t inserts;
+        uint64_t evictions;
+        uint64_t invalidations;     // 因DDL/统计信息变化删除的条目数
+        uint64_t stale_inserts;     // 因版本过期被拒绝的写入数
+    };
+    Stats getStats() const;
+
+private:
+    static constexpr size_t kShards = 64;
+
+    // 不可变条目；last_used仅作淘汰参考，读路径以relaxed方式更新
+    struct Entry {
+        CachedRewritePtr rewrite;
+        mutable std::atomic<int64_t> last_used;
+
+        Entry(CachedRewritePtr r, int64_t now) : rewrite(std::move(r)), last_used(now) {}
+    };
+    using Shard = std::unordered_map<uint64_t, std::shared_ptr<const Entry>>;
+    using ShardPtr = std::shared_ptr<const Shard>;
+
+    struct KnownVersion {
+        uint64_t schema_version = 0;
+        uint64_t stats_version = 0;
+        uint64_t invalidated_epoch = 0;   // 最近一次失效时推进后的epoch
+    };
+
+    size_t max_entries_;
+    size_t shard_count_;          // 容量较小时减少分片，保证总条目数不超过上限
+    size_t shard_capacity_;
+    ShardPtr shards_[kShards];    // 只通过std::atomic_load/atomic_store访问
+    std::atomic<uint64_t> epoch_;  // 只在写锁下推进
+
+    // 写路径状态
+    mutable std::mutex write_mutex_;
+    std::unordered_map<std::string, std::unordered_set<uint64_t>> by_table_;
+    std::unordered_map<std::string, KnownVersion> known_versions_;
+    size_t size_;
+
+    mutable std::atomic<uint64_t> hits_;
+    mutable std::atomic<uint64_t> misses_;
+    uint64_t inserts_;
+    uint64_t evictions_;
+    uint64_t invalidations_;
+    uint64_t stale_inserts_;
+
+    size_t shardOf(uint64_t digest) const { return digest % shard_count_; }
+    void unlinkLocked(const CachedRewrite& rewrite);
+    size_t removeLocked(const std::unordered_set<uint64_t>& digests);
+    KnownVersion& advanceEpochLocked(const std::string& table);
+    template <typename Predicate>
+    size_t invalidateLocked(const std::string& table, Predicate stale);
+};
+
+} // namespace optimizer
+} // namespace heimdall
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ * @file rewrite_prefetcher.cpp
+ * @brief 空闲时重写预取实现
+ */
+
+#include "rewrite_prefetcher.h"
+#include <utility>
+
+namespace heimdall {
+namespace optimizer {
+
+RewritePrefetcher::RewritePrefetcher(std::shared_ptr<DigestStatistics> statistics,
+                                     IdleProbe is_idle,
+                                     CachedProbe is_cached,
+                                     SubmitFunction submit,
+                                     const PrefetchConfig& config)
+    : statistics_(std::move(statistics)),
+      is_idle_(std::move(is_idle)),
+      is_cached_(std::move(is_cached)),
+      submit_(std::move(submit)),
+      config_(config),
+      next_run_(0),
+      stats_{} {}
+
+size_t RewritePrefetcher::maybeRun() {
+    const int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+    int64_t next = next_run_.load(std::memory_order_relaxed);
+    if (now < next) {
+        return 0;
+    }
+    const int64_t interval =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(config_.poll_interval)
+            .count();
+    if (!next_run_.compare_exchange_strong(next, now + interval,
+                                           std::memory_order_relaxed)) {
+        return 0;   // 其他线程已抢到本轮
+    }
+    return runOnce();
+}
+
+size_t RewritePrefetcher::runOnce() {
+    if (!statistics_ || !submit_) {
+        return 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.cycles;
+    }
+    if (is_idle_ && !is_idle_()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.skipped_busy;
+        return 0;
+    }
+
+    const auto targets = statistics_->hottest(config_.max_per_cycle,
+                                              config_.min_avg_latency_ms,
+                                              config_.min_executions,
+                                              is_cached_);
+    size_t submitted = 0;
+    for (const auto& target : targets) {
+        if (submit_(target.digest, target.sample_sql)) {
+            ++submitted;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.submitted += submitted;
+    return submitted;
+}
+
+RewritePrefetcher::Stats RewritePrefetcher::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace optimizer
+} // namespace heimdall
@@ -0,0 +1,91 @@
+/**
+ * @file rewrite_prefetcher.h
+ * @brief 空闲时为热点慢查询预取重写结果
+ */
+
+#ifndef HEIMDALL_REWRITE_PREFETCHER_H
+#define HEIMDALL_REWRITE_PREFETCHER_H
+
+#include "digest_statistics.h"
+#include <atomic>
+#include <memory>
+
+namespace heimdall {
+namespace optimizer {
+
+/**
+ * @brief 预取配置
+ */
+struct PrefetchConfig {
+    std::chrono::milliseconds poll_interval;  // 两轮预取的最小间隔
+    size_t max_per_cycle;                     // 每轮最多提交的模板数
+    double min_avg_latency_ms;                // 慢查询阈值
+    uint64_t min_executions;                  // 至少执行过几次才预取
+
+    PrefetchConfig()
+        : poll_interval(1000),
+          max_per_cycle(2),
+          min_avg_latency_ms(500.0),
+          min_executions(2) {}
+};
+
+/**
+ * @brief 空闲时重写预取
+ *
+ * 不持有线程：执行路径每次调用DigestStatistics::record()之后调用maybeRun()，
+ * 距上一轮不足poll_interval时立即返回（一次原子读），否则由抢到本轮的
+ * 调用方检查LLM提供商是否空闲，空闲时从DigestStatistics中取出最热且尚未
+ * 缓存的慢查询模板交给submit回调（通常是BackgroundOptimizer::enqueue），
+ * 生成、验证、写入RewriteCache以及失败后的重试间隔都由后台优化队列负责。
+ */
+class RewritePrefetcher {
+public:
+    using IdleProbe = std::function<bool()>;
+    using CachedProbe = std::function<bool(uint64_t digest)>;
+    // 返回是否新接受了该模板
+    using SubmitFunction = std::function<bool(uint64_t digest, const std::string& sql)>;
+
+    RewritePrefetcher(std::shared_ptr<DigestStatistics> statistics,
+                      IdleProbe is_idle,
+                      CachedProbe is_cached,
+                      SubmitFunction submit,
+                      const PrefetchConfig& config = PrefetchConfig());
+
+    RewritePrefetcher(const RewritePrefetcher&) = delete;
+    RewritePrefetcher& operator=(const RewritePrefetcher&) = delete;
+
+    /**
+     * @brief 距上一轮已满poll_interval时执行一轮预取，返回提交的模板数
+     *
+     * 可由多个连接线程并发调用，同一周期内只有一个调用方执行
+     */
+    size_t maybeRun();
+
+    /**
+     * @brief 立即执行一轮预取，返回提交的模板数
+     */
+    size_t runOnce();
+
+    struct Stats {
+        uint64_t cycles;
+        uint64_t submitted;
+        uint64_t skipped_busy;
+    };
+    Stats getStats() const;
+
+private:
+    std::shared_ptr<DigestStatistics> statistics_;
+    IdleProbe is_idle_;
+    CachedProbe is_cached_;
+    SubmitFunction submit_;
+    PrefetchConfig config_;
+
+    std::atomic<int64_t> next_run_;   // steady_clock计数，早于该时刻的maybeRun()直接返回
+    mutable std::mutex mutex_;
+    Stats stats_;
+};
+
+} // namespace optimizer
+} // namespace heimdall
+
+#endif
@@ -0,0 +1,237 @@
+/**
+ * @file trigger_model.cpp
+ * @brief 在线学习触发模型实现
+ */
+
+#include "trigger_model.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace heimdall {
+namespace optimizer {
+
+namespace {
+
+constexpr const char* kFileHeader = "heimdall-trigger-model 1";
+
+// 预测的log(改进比率)上限，防止早期权重发散时给出荒谬的预期
+constexpr double kMaxLogRatio = 6.0;
+
+inline double sigmoid(double x) {
+    if (x >= 0) {
+        return 1.0 / (1.0 + std::exp(-x));
+    }
+    const double e = std::exp(x);
+    return e / (1.0 + e);
+}
+
+inline double count(int value) {
+    return std::log1p(static_cast<double>(std::max(0, value)));
+}
+
+} // namespace
+
+TriggerFeatures makeTriggerFeatures(const QueryFeatures& features, double estimated_cost) {
+    TriggerFeatures out;
+    auto& v = out.values;
+    v[0] = std::log10(1.0 + std::max(0.0, estimated_cost)) / 3.0;
+    v[1] = count(features.table_refs);
+    v[2] = count(features.join_count);
+    v[3] = count(features.subquery_count);
+    v[4] = count(features.max_nesting_depth);
+    v[5] = count(features.in_subquery_count);
+    v[6] = count(features.exists_count);
+    v[7] = count(features.max_in_list_size) / 3.0;
+    v[8] = count(features.distinct_count);
+    v[9] = count(features.union_count);
+    v[10] = count(features.or_count);
+    v[11] = features.has_group_by ? 1.0 : 0.0;
+    v[12] = features.has_order_by ? 1.0 : 0.0;
+    v[13] = features.has_limit ? 1.0 : 0.0;
+    v[14] = features.statement_type == StatementType::SELECT ? 1.0 : 0.0;
+    v[15] = (features.statement_type == StatementType::UPDATE ||
+             features.statement_type == StatementType::DELETE) ? 1.0 : 0.0;
+    return out;
+}
+
+TriggerModel::TriggerModel(const TriggerModelConfig& config)
+    : config_(config),
+      weights_(std::make_shared<const Weights>()),
+      decisions_(0),
+      skipped_(0),
+      explored_(0) {}
+
+TriggerPrediction TriggerModel::predictWith(const Weights& weights,
+                                            const TriggerFeatures& features) {
+    double logit = weights.classifier_bias;
+    double log_ratio = weights.regressor_bias;
+    for (size_t k = 0; k < kTriggerFeatureCount; ++k) {
+        logit += weights.classifier[k] * features.values[k];
+        log_ratio += weights.regressor[k] * features.values[k];
+    }
+    TriggerPrediction prediction;
+    prediction.probability = sigmoid(logit);
+    prediction.expected_ratio = std::exp(std::min(std::max(log_ratio, 0.0), kMaxLogRatio));
+    return prediction;
+}
+
+TriggerPrediction TriggerModel::predict(const TriggerFeatures& features) const {
+    const WeightsPtr weights = std::atomic_load(&weights_);
+    return predictWith(*weights, features);
+}
+
+TriggerDecision TriggerModel::decide(const TriggerFeatures& features) const {
+    const WeightsPtr weights = std::atomic_load(&weights_);
+    TriggerDecision decision;
+    decision.prediction = predictWith(*weights, features);
+    decision.model_active = weights->samples >= config_.min_samples;
+    decision.explored = false;
+    decision.optimize = !decision.model_active ||
+                        (decision.prediction.probability >= config_.min_probability &&
+                         decision.prediction.expectedBenefit() >= config_.min_expected_benefit);
+    decisions_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!decision.optimize) {
+        const uint64_t skipped = skipped_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (config_.exploration_interval > 0 &&
+            skipped % config_.exploration_interval == 0) {
+            decision.optimize = true;
+            decision.explored = true;
+            explored_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return decision;
+}
+
+void TriggerModel::update(const TriggerFeatures& features, bool improved,
+                          double improvement_ratio) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    auto next = std::make_shared<Weights>(*std::atomic_load(&weights_));
+
+    const double rate = config_.learning_rate;
+    const double decay = 1.0 - rate * config_.l2;
+
+    // 逻辑回归：对数损失的梯度为(p - y)·x
+    const TriggerPrediction before = predictWith(*next, features);
+    const double error = before.probability - (improved ? 1.0 : 0.0);
+    next->classifier_bias -= rate * error;
+    for (size_t k = 0; k < kTriggerFeatureCount; ++k) {
+        next->classifier[k] = next->classifier[k] * decay - rate * error * features.values[k];
+    }
+
+    // 线性回归只学习成功样本的改进幅度
+    if (improved && improvement_ratio > 1.0) {
+        double predicted = next->regressor_bias;
+        for (size_t k = 0; k < kTriggerFeatureCount; ++k) {
+            predicted += next->regressor[k] * features.values[k];
+        }
+        const double residual = predicted - std::min(std::log(improvement_ratio), kMaxLogRatio);
+        next->regressor_bias -= rate * residual;
+        for (size_t k = 0; k < kTriggerFeatureCount; ++k) {
+            next->regressor[k] = next->regressor[k] * decay - rate * residual * features.values[k];
+        }
+        ++next->improved_samples;
+    }
+    ++next->samples;
+    std::atomic_store(&weights_, WeightsPtr(std::move(next)));
+}
+
+uint64_t TriggerModel::samples() const {
+    return std::atomic_load(&weights_)->samples;
+}
+
+bool TriggerModel::load(const std::string& path, std::string* error) {
+    std::ifstream file(path);
+    if (!file) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    std::string header;
+    std::getline(file, header);
+    if (header != kFileHeader) {
+        if (error) *error = path + ": unsupported model format";
+        return false;
+    }
+
+    auto loaded = std::make_shared<Weights>();
+    std::string line;
+    bool have_samples = false;
+    bool have_classifier = false;
+    bool have_regressor = false;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream in(line);
+        std::string key;
+        in >> key;
+        if (key == "samples") {
+            have_samples = static_cast<bool>(in >> loaded->samples >> loaded->improved_samples);
+        } else if (key == "classifier" || key == "regressor") {
+            const bool classifier = key == "classifier";
+            double& bias = classifier ? loaded->classifier_bias : loaded->regressor_bias;
+            auto& weights = classifier ? loaded->classifier : loaded->regressor;
+            bool ok = static_cast<bool>(in >> bias);
+            for (size_t k = 0; ok && k < kTriggerFeatureCount; ++k) {
+                ok = static_cast<bool>(in >> weights[k]) && std::isfinite(weights[k]);
+            }
+            ok = ok && std::isfinite(bias);
+            (classifier ? have_classifier : have_regressor) = ok;
+        }
+    }
+    if (!have_samples || !have_classifier || !have_regressor) {
+        if (error) *error = path + ": incomplete or malformed model";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    std::atomic_store(&weights_, WeightsPtr(std::move(loaded)));
+    return true;
+}
+
+bool TriggerModel::save(const std::string& path) const {
+    const WeightsPtr weights = std::atomic_load(&weights_);
+    std::string content = kFileHeader;
+    content += '\n';
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "samples %llu %llu\n",
+                  static_cast<unsigned long long>(weights->samples),
+                  static_cast<unsigned long long>(weights->improved_samples));
+    content += buf;
+    auto appendRow = [&content, &buf](const char* name, double bias,
+                                      const std::array<double, kTriggerFeatureCount>& row) {
+        content += name;
+        std::snprintf(buf, sizeof(buf), " %.17g", bias);
+        content += buf;
+        for (double w : row) {
+            std::snprintf(buf, sizeof(buf), " %.17g", w);
+            content += buf;
+        }
+        content += '\n';
+    };
+    appendRow("classifier", weights->classifier_bias, weights->classifier);
+    appendRow("regressor", weights->regressor_bias, weights->regressor);
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::trunc);
+        if (!file || !(file << content) || !file.flush()) {
+            return false;
+        }
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+TriggerModel::Stats TriggerModel::getStats() const {
+    Stats stats;
+    stats.decisions = decisions_.load(std::memory_order_relaxed);
+    stats.skipped = skipped_.load(std::memory_order_relaxed);
+    stats.explored = explored_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace optimizer
+} // namespace heimdall
@@ -0,0 +1,151 @@
+/**
+ * @file trigger_model.h
+ * @brief 预测重写收益的在线学习触发模型
+ */
+
+#ifndef HEIMDALL_TRIGGER_MODEL_H
+#define HEIMDALL_TRIGGER_MODEL_H
+
+#include "query_features.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace heimdall {
+namespace optimizer {
+
+constexpr size_t kTriggerFeatureCount = 16;
+
+/**
+ * @brief 模型输入：由形状特征与原始代价构成的定长向量
+ *
+ * 计数类特征取log1p，使一两个极端查询不会主导梯度
+ */
+struct TriggerFeatures {
+    std::array<double, kTriggerFeatureCount> values;
+};
+
+TriggerFeatures makeTriggerFeatures(const QueryFeatures& features, double estimated_cost);
+
+/**
+ * @brief 模型预测
+ */
+struct TriggerPrediction {
+    double probability;      // 能找到满足min_improvement_ratio的重写的概率
+    double expected_ratio;   // 找到时的预期改进比率
+
+    /**
+     * @brief 预期收益：成功概率×找到时的代价降低比例(1 - 1/expected_ratio)
+     */
+    double expectedBenefit() const {
+        return expected_ratio > 1.0 ? probability * (1.0 - 1.0 / expected_ratio) : 0.0;
+    }
+};
+
+/**
+ * @brief 触发模型配置
+ */
+struct TriggerModelConfig {
+    double learning_rate;
+    double l2;                       // L2正则系数
+    uint64_t min_samples;            // 样本数不足时不参与决策，沿用规则触发
+    double min_probability;          // 预测概率低于该值时跳过优化
+    double min_expected_benefit;     // 预期收益低于该值时跳过优化（见TriggerPrediction::expectedBenefit）
+    uint64_t exploration_interval;   // 每跳过N个查询放行一个，让被模型排除的查询仍有机会纠正模型(0表示不探索)
+
+    TriggerModelConfig()
+        : learning_rate(0.05),
+          l2(1e-4),
+          min_samples(50),
+          min_probability(0.15),
+          min_expected_benefit(0.025),
+          exploration_interval(50) {}
+};
+
+/**
+ * @brief 触发决策
+ */
+struct TriggerDecision {
+    bool optimize;
+    bool explored;           // 模型判定跳过，但作为探索样本放行
+    bool model_active;       // 样本数是否已足够由模型决策
+    TriggerPrediction prediction;
+};
+
+/**
+ * @brief 在线学习的触发模型
+ *
+ * 两个线性模型共享同一组特征：逻辑回归预测本次优化成功（找到满足
+ * min_improvement_ratio的重写）的概率，线性回归只用成功样本拟合
+ * log(改进比率)。每次优化结束后以结果调用update()做一步SGD。
+ *
+ * decide()要求成功概率与预期收益（概率×代价降低比例）都达到阈值：
+ * 成功率尚可但历史改进幅度很小的查询同样跳过。
+ *
+ * 推理只是两次16维点积。权重以不可变快照发布：predict()/decide()用
+ * std::atomic_load取得当前快照，不取写锁；update()在写锁下复制、更新后
+ * 原子替换。atomic_load(shared_ptr)并非无锁，libstdc++用按地址散列的
+ * 自旋锁池实现，读者只在复制指针的瞬间持锁。
+ *
+ * 持久化为文本（版本行、样本数、两行权重），保存时先写临时文件再改名。
+ */
+class TriggerModel {
+public:
+    explicit TriggerModel(const TriggerModelConfig& config = TriggerModelConfig());
+
+    TriggerPrediction predict(const TriggerFeatures& features) const;
+
+    /**
+     * @brief 预测并按配置给出是否优化的决定
+     */
+    TriggerDecision decide(const TriggerFeatures& features) const;
+
+    /**
+     * @brief 用一次优化结果训练
+     * @param improved 是否找到满足阈值的重写
+     * @param improvement_ratio 找到时的改进比率
+     */
+    void update(const TriggerFeatures& features, bool improved, double improvement_ratio);
+
+    uint64_t samples() const;
+
+    bool load(const std::string& path, std::string* error = nullptr);
+    bool save(const std::string& path) const;
+
+    struct Stats {
+        uint64_t decisions;
+        uint64_t skipped;
+        uint64_t explored;
+    };
+    Stats getStats() const;
+
+private:
+    struct Weights {
+        double classifier_bias = 0.0;
+        double regressor_bias = 0.0;
+        std::array<double, kTriggerFeatureCount> classifier{};
+        std::array<double, kTriggerFeatureCount> regressor{};
+        uint64_t samples = 0;
+        uint64_t improved_samples = 0;
+    };
+    using WeightsPtr = std::shared_ptr<const Weights>;
+
+    TriggerModelConfig config_;
+    WeightsPtr weights_;            // 只通过std::atomic_load/atomic_store访问
+    mutable std::mutex write_mutex_;
+
+    mutable std::atomic<uint64_t> decisions_;
+    mutable std::atomic<uint64_t> skipped_;
+    mutable std::atomic<uint64_t> explored_;
+
+    static TriggerPrediction predictWith(const Weights& weights,
+                                         const TriggerFeatures& features);
+};
+
+} // namespace optimizer
+} // namespace heimdall
+
+#endif
@@ -0,0 +1,39 @@
+/**
+ * @file txsql_integration.cpp
+ * @brief TXSQL集成钩子中与服务端类型无关的部分
+ *
+ * registerWithTXSQL()与optimizerCallback()需要THD、Query_block等服务端定义，
+ * 随TXSQL侧补丁一起编译；这里只实现全局实例与DDL/统计信息回调的转发。
+ */
+
+#include "heimdall_optimizer.h"
+#include <mutex>
+
+namespace heimdall {
+namespace optimizer {
+
+std::unique_ptr<HeimdallOptimizer> TXSQLIntegration::instance_;
+
+HeimdallOptimizer& TXSQLIntegration::getInstance() {
+    static std::once_flag once;
+    std::call_once(once, [] { instance_.reset(new HeimdallOptimizer()); });
+    return *instance_;
+}
+
+void TXSQLIntegration::schemaChangeCallback(const char* table_name) {
+    if (table_name == nullptr) {
+        return;
+    }
+    getInstance().onSchemaChanged(table_name);
+}
+
+void TXSQLIntegration::statisticsChangeCallback(const char* table_name,
+                                                uint64_t stats_version) {
+    if (table_name == nullptr) {
+        return;
+    }
+    getInstance().onStatisticsChanged(table_name, stats_version);
+}
+
+} // namespace optimizer
+} // namespace heimdall
@@ -0,0 +1,52 @@
+/**
+ * @file test_background_optimizer.cpp
+ * @brief 后台优化队列测试
+ */
+
+#include "test_framework.h"
+#include "optimizer_integration/background_optimizer.h"
+#include <stdexcept>
+
+using heimdall::optimizer::AsyncOptimizationConfig;
+using heimdall::optimizer::BackgroundOptimizer;
+
+TEST(BackgroundOptimizer, DeduplicatesPendingDigests) {
+    int calls = 0;
+    BackgroundOptimizer background([&calls](const std::string&) {
+        ++calls;
+        return true;
+    });
+    EXPECT_TRUE(background.enqueue(1, "SELECT 1"));
+    EXPECT_FALSE(background.enqueue(1, "SELECT 2"));
+    EXPECT_EQ(background.pending(), 1u);
+    EXPECT_EQ(background.drain(), 1u);
+    EXPECT_EQ(calls, 1);
+    // 成功后同一模板可再次提交（RewriteCache失效后需要重新生成）
+    EXPECT_TRUE(background.enqueue(1, "SELECT 1"));
+}
+
+TEST(BackgroundOptimizer, ExceptionCountsAsFailure) {
+    BackgroundOptimizer background([](const std::string&) -> bool {
+        throw std::runtime_error("provider unavailable");
+    });
+    EXPECT_TRUE(background.enqueue(7, "SELECT 7"));
+    EXPECT_EQ(background.drain(), 0u);
+    const auto stats = background.getStats();
+    EXPECT_EQ(stats.failed, 1u);
+    // retry_after内不再入队
+    EXPECT_FALSE(background.enqueue(7, "SELECT 7"));
+}
+
+TEST(BackgroundOptimizer, FailureRecordsAreBounded) {
+    AsyncOptimizationConfig config;
+    config.max_failed_entries = 2;
+    BackgroundOptimizer background([](const std::string&) { return false; }, config);
+    for (uint64_t digest = 1; digest <= 3; ++digest) {
+        background.enqueue(digest, "SELECT 1");
+        background.drain();
+    }
+    // 最早的失败记录已被淘汰，其余两个仍在retry_after内
+    EXPECT_TRUE(background.enqueue(1, "SELECT 1"));
+    EXPECT_FALSE(background.enqueue(2, "SELECT 1"));
+    EXPECT_FALSE(background.enqueue(3, "SELECT 1"));
+}
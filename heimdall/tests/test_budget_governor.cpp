@@ -0,0 +1,143 @@
+/**
+ * @file test_budget_governor.cpp
+ * @brief 令牌桶与预算控制测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/budget_governor.h"
+#include "llm_generator/llm_client.h"
+
+using heimdall::llm::BudgetDecision;
+using heimdall::llm::BudgetGovernor;
+using heimdall::llm::BudgetGovernorConfig;
+using heimdall::llm::BudgetRequest;
+using heimdall::llm::TokenBucket;
+
+namespace {
+
+BudgetRequest request(const std::string& scope, double savings = 0.0) {
+    BudgetRequest req;
+    req.scope = scope;
+    req.prompt_tokens = 10;
+    req.max_completion_tokens = 10;
+    req.expected_savings = savings;
+    return req;
+}
+
+} // namespace
+
+TEST(TokenBucket, RefillsAtWindowRate) {
+    TokenBucket bucket(60.0, std::chrono::minutes(1));
+    const auto start = TokenBucket::Clock::now();
+    EXPECT_TRUE(bucket.canConsume(60.0, start));
+    bucket.consume(60.0);
+    EXPECT_FALSE(bucket.canConsume(1.0, start));
+    // 每秒补充1个
+    EXPECT_TRUE(bucket.canConsume(10.0, start + std::chrono::seconds(11)));
+    EXPECT_FALSE(bucket.canConsume(20.0, start + std::chrono::seconds(11)));
+    // 补充不超过容量
+    EXPECT_NEAR(bucket.fillRatio(start + std::chrono::hours(1)), 1.0, 1e-9);
+}
+
+TEST(TokenBucket, OversizedRequestAdmittedWhenFull) {
+    TokenBucket bucket(60.0, std::chrono::minutes(1));
+    const auto start = TokenBucket::Clock::now();
+    // 超过容量的请求不会永远被拒绝
+    EXPECT_TRUE(bucket.canConsume(90.0, start));
+    bucket.consume(90.0);
+    // 欠下的30个补回、再补满容量之前不再放行
+    EXPECT_FALSE(bucket.canConsume(1.0, start + std::chrono::seconds(30)));
+    EXPECT_FALSE(bucket.canConsume(90.0, start + std::chrono::seconds(60)));
+    EXPECT_TRUE(bucket.canConsume(90.0, start + std::chrono::seconds(91)));
+}
+
+TEST(TokenBucket, ZeroCapacityIsUnlimited) {
+    TokenBucket bucket;
+    EXPECT_TRUE(bucket.unlimited());
+    EXPECT_TRUE(bucket.canConsume(1e12, TokenBucket::Clock::now()));
+}
+
+TEST(BudgetGovernor, RejectsWhenGlobalExhausted) {
+    BudgetGovernorConfig config;
+    config.global.requests_per_hour = 2;
+    config.reserve_fraction = 0.0;
+    BudgetGovernor governor(config);
+    EXPECT_TRUE(governor.tryAdmit(request("")) == BudgetDecision::ADMITTED);
+    EXPECT_TRUE(governor.tryAdmit(request("")) == BudgetDecision::ADMITTED);
+    EXPECT_TRUE(governor.tryAdmit(request("")) == BudgetDecision::REJECTED_GLOBAL);
+    EXPECT_EQ(governor.getStats().rejected_global, 1u);
+}
+
+TEST(BudgetGovernor, FullScopeTableNeverResetsDrainedScope) {
+    BudgetGovernorConfig config;
+    config.per_scope.requests_per_hour = 1;
+    config.reserve_fraction = 0.0;
+    config.max_scopes = 2;
+    BudgetGovernor governor(config);
+
+    EXPECT_TRUE(governor.tryAdmit(request("a")) == BudgetDecision::ADMITTED);
+    EXPECT_TRUE(governor.tryAdmit(request("b")) == BudgetDecision::ADMITTED);
+    // 两个scope都未回满：新scope被拒绝，而不是挤掉a或b重置其预算
+    EXPECT_TRUE(governor.tryAdmit(request("c")) == BudgetDecision::REJECTED_SCOPE);
+    EXPECT_TRUE(governor.tryAdmit(request("a")) == BudgetDecision::REJECTED_SCOPE);
+    EXPECT_TRUE(governor.tryAdmit(request("b")) == BudgetDecision::REJECTED_SCOPE);
+}
+
+TEST(BudgetGovernor, EvictsRefilledScope) {
+    BudgetGovernorConfig config;
+    config.per_scope.prompt_tokens_per_hour = 15;
+    config.reserve_fraction = 0.0;
+    config.max_scopes = 2;
+    BudgetGovernor governor(config);
+
+    EXPECT_TRUE(governor.tryAdmit(request("a")) == BudgetDecision::ADMITTED);
+    // b的预扣在结算时全额退回，其令牌桶回满，可被安全淘汰
+    BudgetRequest b = request("b");
+    EXPECT_TRUE(governor.tryAdmit(b) == BudgetDecision::ADMITTED);
+    governor.settle(b, 0, 0);
+    EXPECT_TRUE(governor.tryAdmit(request("c")) == BudgetDecision::ADMITTED);
+    // a保留了部分耗尽的状态
+    EXPECT_TRUE(governor.tryAdmit(request("a")) == BudgetDecision::REJECTED_SCOPE);
+}
+
+TEST(BudgetGovernor, TightBudgetAdmitsByRank) {
+    BudgetGovernorConfig config;
+    config.global.requests_per_hour = 10;
+    config.reserve_fraction = 0.5;
+    BudgetGovernor governor(config);
+
+    // 前5个请求把余量降到一半
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(governor.tryAdmit(request("", i + 1.0)) == BudgetDecision::ADMITTED);
+    }
+    // 余量0.5(不紧张) -> 0.4：只放行排名前80%的请求
+    EXPECT_TRUE(governor.tryAdmit(request("", 3.0)) == BudgetDecision::ADMITTED);
+    EXPECT_TRUE(governor.tryAdmit(request("", 0.5)) == BudgetDecision::REJECTED_PRIORITY);
+    EXPECT_TRUE(governor.tryAdmit(request("", 100.0)) == BudgetDecision::ADMITTED);
+    EXPECT_EQ(governor.getStats().rejected_priority, 1u);
+}
+
+TEST(BudgetGovernor, ClientReturnsBudgetRejectedResponse) {
+    BudgetGovernorConfig config;
+    config.global.requests_per_hour = 1;
+    config.reserve_fraction = 0.0;
+    auto governor = std::make_shared<BudgetGovernor>(config);
+
+    auto provider = std::make_shared<heimdall::llm::LocalModelProvider>("http://localhost");
+    int calls = 0;
+    provider->setTransport([&calls](const std::string&, const std::vector<std::string>&,
+                                    const std::string&, std::string* response, std::string*) {
+        ++calls;
+        *response = "{\"candidates\":[\"SELECT 1\"]}";
+        return true;
+    });
+    heimdall::llm::LLMClient client;
+    client.registerProvider(provider);
+    client.setBudgetGovernor(governor);
+
+    EXPECT_TRUE(client.generateFromPrompt("first")->success);
+    auto rejected = client.generateFromPrompt("second");
+    EXPECT_FALSE(rejected->success);
+    EXPECT_TRUE(rejected->budget_rejected);
+    EXPECT_EQ(calls, 1);
+}
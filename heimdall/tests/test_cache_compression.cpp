@@ -0,0 +1,61 @@
+/**
+ * @file test_cache_compression.cpp
+ * @brief 缓存值压缩测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/cache_compression.h"
+
+using heimdall::llm::CompressionDictionary;
+using heimdall::llm::LLMResponseBuilder;
+using heimdall::llm::LLMResponsePtr;
+using heimdall::llm::deserializeResponse;
+using heimdall::llm::serializeResponse;
+
+namespace {
+
+const char* kSamples[] = {
+    "SELECT ss_item_sk, SUM(ss_sales_price) FROM store_sales GROUP BY ss_item_sk",
+    "SELECT ss_item_sk FROM store_sales JOIN item ON ss_item_sk = i_item_sk",
+    "{\"candidates\": [\"SELECT i_item_sk FROM item WHERE i_category = 'Books'\"]}",
+};
+
+} // namespace
+
+TEST(CacheCompression, RoundTripsTextAndEscapeBytes) {
+    std::vector<std::string_view> samples(std::begin(kSamples), std::end(kSamples));
+    const auto dictionary = CompressionDictionary::train(samples);
+    ASSERT_TRUE(dictionary->entries() > 0u);
+
+    const std::string text = std::string(kSamples[1]) + " \xFD\xFE\xFF 中文";
+    const std::string packed = dictionary->compress(text);
+    EXPECT_TRUE(dictionary->compress(kSamples[0]).size() < std::string(kSamples[0]).size());
+    std::string restored;
+    ASSERT_TRUE(dictionary->decompress(packed, &restored));
+    EXPECT_EQ(restored, text);
+}
+
+TEST(CacheCompression, RejectsTruncatedInput) {
+    std::vector<std::string_view> samples(std::begin(kSamples), std::end(kSamples));
+    const auto dictionary = CompressionDictionary::train(samples);
+    std::string restored;
+    EXPECT_FALSE(dictionary->decompress(std::string("abc\xFE\x01", 5), &restored));
+    EXPECT_FALSE(dictionary->decompress(std::string("\xFD", 1), &restored));
+}
+
+TEST(CacheCompression, SerializedResponseRoundTrip) {
+    LLMResponseBuilder builder;
+    builder.setRawResponse("{\"candidates\": 2}");
+    builder.addCandidate("SELECT 1");
+    builder.addCandidate("SELECT 2 FROM t");
+    builder.setLatency(12.5);
+    const LLMResponsePtr original = builder.buildShared();
+
+    const LLMResponsePtr restored = deserializeResponse(serializeResponse(*original));
+    ASSERT_TRUE(restored != nullptr);
+    ASSERT_TRUE(restored->candidates.size() == 2u);
+    EXPECT_EQ(std::string(restored->candidates[1]), std::string("SELECT 2 FROM t"));
+    EXPECT_EQ(std::string(restored->raw_response), std::string("{\"candidates\": 2}"));
+    EXPECT_TRUE(restored->success == original->success);
+    EXPECT_TRUE(deserializeResponse("\x01\x02") == nullptr);
+}
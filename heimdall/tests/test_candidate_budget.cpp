@@ -0,0 +1,101 @@
+/**
+ * @file test_candidate_budget.cpp
+ * @brief 自适应候选预算测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/candidate_budget.h"
+
+using heimdall::llm::CandidateBudgetConfig;
+using heimdall::llm::CandidateBudgetController;
+using heimdall::llm::GenerationConfig;
+
+namespace {
+
+CandidateBudgetConfig testConfig() {
+    CandidateBudgetConfig config;
+    config.warmup_samples = 2;
+    config.explore_interval = 0;
+    return config;
+}
+
+} // namespace
+
+TEST(CandidateBudget, WarmupKeepsBaseConfig) {
+    CandidateBudgetController budget(testConfig());
+    GenerationConfig base;
+    base.num_candidates = 3;
+    EXPECT_EQ(budget.adapt(1, base).num_candidates, 3);
+}
+
+TEST(CandidateBudget, FirstCandidateAlwaysWinsConvergesToOne) {
+    CandidateBudgetController budget(testConfig());
+    for (int i = 0; i < 10; ++i) {
+        budget.recordOutcome(1, 3, 3, 0, 2000, 600);
+    }
+    const GenerationConfig config = budget.adapt(1, GenerationConfig());
+    EXPECT_EQ(config.num_candidates, 1);
+    EXPECT_NEAR(config.temperature, 0.2f, 1e-6);
+}
+
+TEST(CandidateBudget, LowYieldRequestsMoreCandidates) {
+    CandidateBudgetController budget(testConfig());
+    for (int i = 0; i < 10; ++i) {
+        budget.recordOutcome(7, 5, 1, 3);
+    }
+    EXPECT_EQ(budget.adapt(7, GenerationConfig()).num_candidates, 5);
+}
+
+TEST(CandidateBudget, ExpensiveCompletionsLimitCandidatesPerToken) {
+    CandidateBudgetController cheap(testConfig());
+    CandidateBudgetController expensive(testConfig());
+    for (int i = 0; i < 10; ++i) {
+        // 单候选有效率0.4：prompt占大头时多要候选几乎不增加开销
+        cheap.recordOutcome(1, 5, 2, 1, 8000, 5 * 50);
+        // completion远长于prompt时，每多一个候选token近乎翻倍
+        expensive.recordOutcome(1, 5, 2, 1, 100, 5 * 2000);
+    }
+    const int cheap_n = cheap.adapt(1, GenerationConfig()).num_candidates;
+    const int expensive_n = expensive.adapt(1, GenerationConfig()).num_candidates;
+    EXPECT_EQ(cheap_n, 5);
+    EXPECT_TRUE(expensive_n < cheap_n);
+}
+
+TEST(CandidateBudget, EvictsLeastRecentlyUsedClass) {
+    CandidateBudgetConfig config = testConfig();
+    config.max_classes = 2;
+    CandidateBudgetController budget(config);
+    budget.recordOutcome(1, 1, 1, 0);
+    budget.recordOutcome(2, 1, 1, 0);
+    budget.adapt(1, GenerationConfig());      // 1成为最近使用
+    budget.recordOutcome(3, 1, 1, 0);         // 淘汰2
+
+    EXPECT_EQ(budget.trackedClasses(), static_cast<size_t>(2));
+    EXPECT_TRUE(budget.getClassStats(1, nullptr));
+    EXPECT_FALSE(budget.getClassStats(2, nullptr));
+    EXPECT_TRUE(budget.getClassStats(3, nullptr));
+}
+
+TEST(CandidateBudget, AccumulatesTokens) {
+    CandidateBudgetController budget(testConfig());
+    budget.recordOutcome(9, 3, 1, 0, 1000, 300);
+    budget.recordOutcome(9, 3, 1, -1, 1200, 200);
+    CandidateBudgetController::ClassStats stats;
+    ASSERT_TRUE(budget.getClassStats(9, &stats));
+    EXPECT_EQ(stats.prompt_tokens, static_cast<uint64_t>(2200));
+    EXPECT_EQ(stats.completion_tokens, static_cast<uint64_t>(500));
+    EXPECT_EQ(stats.chosen, static_cast<uint64_t>(1));
+}
+
+TEST(CandidateBudget, UnexaminedCandidatesDoNotLowerYield) {
+    CandidateBudgetController budget(testConfig());
+    for (int i = 0; i < 10; ++i) {
+        // FIRST_VALID：5个候选只验证了第1个即通过
+        budget.recordOutcome(4, 5, 1, 0, 0, 0, 1);
+    }
+    CandidateBudgetController::ClassStats stats;
+    ASSERT_TRUE(budget.getClassStats(4, &stats));
+    EXPECT_EQ(stats.generated, static_cast<uint64_t>(50));
+    EXPECT_EQ(stats.examined, static_cast<uint64_t>(10));
+    EXPECT_EQ(budget.adapt(4, GenerationConfig()).num_candidates, 1);
+}
@@ -0,0 +1,72 @@
+/**
+ * @file test_candidate_ranker.cpp
+ * @brief 候选预排序测试
+ */
+
+#include "test_framework.h"
+#include "optimizer_integration/candidate_ranker.h"
+#include <string_view>
+#include <vector>
+
+using heimdall::optimizer::CandidateRanker;
+using heimdall::optimizer::RankedCandidate;
+
+namespace {
+
+const char* kOriginal = "SELECT a.x FROM a WHERE a.id IN (SELECT b.a_id FROM b WHERE b.y = 1)";
+
+} // namespace
+
+TEST(CandidateRanker, RanksRemovedSubqueryFirstAndTypeChangeLast) {
+    CandidateRanker ranker;
+    const std::vector<std::string_view> candidates = {
+        "UPDATE a SET x = 1",
+        kOriginal,
+        "SELECT a.x FROM a JOIN b ON a.id = b.a_id WHERE b.y = 1",
+    };
+    const std::vector<RankedCandidate> ranked = ranker.rank(kOriginal, candidates);
+    ASSERT_TRUE(ranked.size() == 3);
+    EXPECT_EQ(ranked[0].index, 2u);   // 消除了IN子查询
+    EXPECT_EQ(ranked[1].index, 1u);   // 与原查询模板相同
+    EXPECT_EQ(ranked[2].index, 0u);   // 语句类型改变
+    EXPECT_TRUE(ranked[0].score > ranked[1].score);
+}
+
+TEST(CandidateRanker, FewerScannedRowsRankHigherWithEstimator) {
+    const std::string_view original = "SELECT c FROM orders WHERE k = 1 AND z = 2";
+    const std::vector<std::string_view> candidates = {
+        "SELECT c FROM orders WHERE k = 1",
+        "SELECT c FROM orders_summary WHERE k = 1",
+    };
+
+    // 没有行数时两个候选形状相同，保持生成顺序
+    const std::vector<RankedCandidate> plain = CandidateRanker().rank(original, candidates);
+    EXPECT_EQ(plain[0].index, 0u);
+
+    CandidateRanker ranker([](std::string_view table) {
+        if (table == "orders") return 1e7;
+        if (table == "orders_summary") return 1e3;
+        return -1.0;
+    });
+    const std::vector<RankedCandidate> ranked = ranker.rank(original, candidates);
+    EXPECT_EQ(ranked[0].index, 1u);
+    EXPECT_EQ(ranked[1].index, 0u);
+}
+
+TEST(CandidateRanker, TopKKeepsHighestScores) {
+    CandidateRanker ranker;
+    const std::vector<std::string_view> candidates = {
+        kOriginal,
+        "UPDATE a SET x = 1",
+        "SELECT a.x FROM a JOIN b ON a.id = b.a_id WHERE b.y = 1",
+    };
+    const std::vector<RankedCandidate> top = ranker.rank(kOriginal, candidates, 2);
+    ASSERT_TRUE(top.size() == 2);
+    EXPECT_EQ(top[0].index, 2u);
+    EXPECT_EQ(top[1].index, 0u);
+
+    const std::vector<RankedCandidate> all = ranker.rank(kOriginal, candidates, 0);
+    EXPECT_EQ(all.size(), 3u);
+    const std::vector<RankedCandidate> wide = ranker.rank(kOriginal, candidates, 10);
+    EXPECT_EQ(wide.size(), 3u);
+}
@@ -0,0 +1,146 @@
+/**
+ * @file test_candidate_repair.cpp
+ * @brief 候选修复循环测试
+ */
+
+#include "test_framework.h"
+#include "optimizer_integration/candidate_repair.h"
+
+using heimdall::llm::LLMResponseBuilder;
+using heimdall::llm::LLMResponsePtr;
+using heimdall::optimizer::NearMiss;
+using heimdall::optimizer::RepairResult;
+using heimdall::optimizer::buildRepairPrompt;
+using heimdall::optimizer::isNearMiss;
+using heimdall::optimizer::runRepairLoop;
+using heimdall::validator::ValidationResult;
+
+namespace {
+
+ValidationResult mismatch(const std::string& difference) {
+    ValidationResult result;
+    result.differences.push_back(difference);
+    return result;
+}
+
+ValidationResult equivalent() {
+    ValidationResult result;
+    result.is_equivalent = true;
+    result.confidence = 1.0;
+    return result;
+}
+
+LLMResponsePtr respond(const std::string& sql) {
+    LLMResponseBuilder builder;
+    builder.setRawResponse("```sql\n" + sql + "\n```");
+    builder.addCandidate(sql);
+    return builder.buildShared();
+}
+
+} // namespace
+
+TEST(CandidateRepair, NearMissRequiresFewShortDifferences) {
+    EXPECT_TRUE(isNearMiss(mismatch("missing predicate a > 1"), 2));
+    EXPECT_FALSE(isNearMiss(mismatch(std::string(500, 'x')), 2));
+    EXPECT_FALSE(isNearMiss(ValidationResult(), 2));
+    EXPECT_FALSE(isNearMiss(equivalent(), 2));
+}
+
+TEST(CandidateRepair, RepairPromptKeepsRewritePromptAsPrefix) {
+    const std::string prompt = buildRepairPrompt("PROMPT", "select 1", "- diff\n");
+    EXPECT_EQ(prompt.compare(0, 6, "PROMPT"), 0);
+    EXPECT_TRUE(prompt.find("select 1") != std::string::npos);
+    EXPECT_TRUE(prompt.find("- diff") != std::string::npos);
+}
+
+TEST(CandidateRepair, AcceptsCandidateFixedInOneRound) {
+    std::vector<std::string> prompts;
+    const std::vector<NearMiss> near_misses = {
+        {"select a from t", mismatch("missing predicate b = 1")}};
+    const RepairResult result = runRepairLoop(
+        "PROMPT", near_misses, 3, 2,
+        [&prompts](const std::string& prompt) {
+            prompts.push_back(prompt);
+            return respond("select a from t where b = 1");
+        },
+        [](std::string_view) { return equivalent(); });
+
+    EXPECT_EQ(result.rounds, 1);
+    ASSERT_TRUE(result.repaired.size() == 1);
+    EXPECT_EQ(result.repaired[0], std::string_view("select a from t where b = 1"));
+    EXPECT_EQ(result.responses.size(), static_cast<size_t>(1));
+    EXPECT_TRUE(result.prompt_tokens > 0);
+}
+
+TEST(CandidateRepair, RetriesWithGrowingConversationUntilRoundLimit) {
+    std::vector<std::string> prompts;
+    const std::vector<NearMiss> near_misses = {
+        {"select a from t", mismatch("missing predicate b = 1")}};
+    const RepairResult result = runRepairLoop(
+        "PROMPT", near_misses, 3, 2,
+        [&prompts](const std::string& prompt) {
+            prompts.push_back(prompt);
+            return respond("select a from t where c = " + std::to_string(prompts.size()));
+        },
+        [](std::string_view) { return mismatch("missing predicate b = 1"); });
+
+    EXPECT_EQ(result.rounds, 3);
+    EXPECT_TRUE(result.repaired.empty());
+    ASSERT_TRUE(prompts.size() == 3);
+    // 每轮以上一轮完整Prompt为前缀
+    EXPECT_EQ(prompts[1].compare(0, prompts[0].size(), prompts[0]), 0);
+    EXPECT_EQ(prompts[2].compare(0, prompts[1].size(), prompts[1]), 0);
+}
+
+TEST(CandidateRepair, RoundLimitIsSharedAcrossCandidates) {
+    int calls = 0;
+    const std::vector<NearMiss> near_misses = {
+        {"select 1", mismatch("d1")},
+        {"select 2", mismatch("d2")},
+        {"select 3", mismatch("d3")}};
+    const RepairResult result = runRepairLoop(
+        "PROMPT", near_misses, 2, 2,
+        [&calls](const std::string&) {
+            ++calls;
+            return respond("select 0");
+        },
+        [](std::string_view) { return equivalent(); });
+
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(result.repaired.size(), static_cast<size_t>(2));
+}
+
+TEST(CandidateRepair, GivesUpWhenDifferencesGrowOrGenerationFails) {
+    int calls = 0;
+    const std::vector<NearMiss> near_misses = {
+        {"select 1", mismatch("d1")},
+        {"select 2", mismatch("d2")}};
+    const RepairResult result = runRepairLoop(
+        "PROMPT", near_misses, 5, 1,
+        [&calls](const std::string&) -> LLMResponsePtr {
+            return ++calls == 1 ? respond("select 9") : nullptr;
+        },
+        [](std::string_view) {
+            ValidationResult result = mismatch("d1");
+            result.differences.push_back("d2");
+            return result;
+        });
+
+    EXPECT_EQ(calls, 2);
+    EXPECT_EQ(result.rounds, 2);
+    EXPECT_TRUE(result.repaired.empty());
+}
+
+TEST(CandidateRepair, DisabledWithZeroRounds) {
+    bool called = false;
+    const std::vector<NearMiss> near_misses = {{"select 1", mismatch("d1")}};
+    const RepairResult result = runRepairLoop(
+        "PROMPT", near_misses, 0, 2,
+        [&called](const std::string&) {
+            called = true;
+            return respond("select 1");
+        },
+        [](std::string_view) { return equivalent(); });
+    EXPECT_FALSE(called);
+    EXPECT_EQ(result.rounds, 0);
+}
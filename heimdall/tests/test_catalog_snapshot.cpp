@@ -0,0 +1,147 @@
+/**
+ * @file test_catalog_snapshot.cpp
+ * @brief 目录统计快照测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/catalog_snapshot.h"
+#include "llm_generator/schema_cache.h"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+using heimdall::llm::CatalogSnapshot;
+using heimdall::llm::IndexDefinition;
+using heimdall::llm::SchemaRenderCache;
+using heimdall::llm::TableSchema;
+using heimdall::llm::TableStatistics;
+using heimdall::llm::renderTableSchema;
+
+namespace {
+
+std::string tempPath(const char* name) {
+    return std::string("/tmp/heimdall_test_") + name + ".catalog";
+}
+
+void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream file(path);
+    file << content;
+}
+
+TableSchema ordersTable() {
+    TableSchema orders;
+    orders.table_name = "Orders";
+    orders.columns = {"o_id INT", "o_customer_id INT", "o_status CHAR(1)"};
+    orders.primary_keys = {"o_id"};
+    return orders;
+}
+
+} // namespace
+
+TEST(CatalogSnapshot, LoadedStatisticsReachRenderedSchema) {
+    const std::string path = tempPath("load");
+    writeFile(path,
+              "# tpc-h\n"
+              "table orders 2880404\n"
+              "ndv orders o_customer_id 18000\n"
+              "ndv orders o_status 3\n"
+              "index orders idx_customer o_customer_id\n"
+              "index orders uk_order unique o_id,o_status\n");
+    CatalogSnapshot catalog;
+    std::string error;
+    ASSERT_TRUE(catalog.loadFromFile(path, &error));
+    EXPECT_EQ(catalog.tableCount(), 1u);
+
+    TableSchema orders = ordersTable();
+    ASSERT_TRUE(catalog.annotate(orders));
+    EXPECT_EQ(orders.row_count, 2880404u);
+    EXPECT_EQ(orders.indexes.size(), 2u);
+    EXPECT_TRUE(orders.stats_version > 0);
+
+    const std::string rendered = renderTableSchema(orders);
+    EXPECT_TRUE(rendered.find("### Table: Orders (~2.9M rows)") != std::string::npos);
+    EXPECT_TRUE(rendered.find("o_customer_id INT [ndv 18K]") != std::string::npos);
+    EXPECT_TRUE(rendered.find("o_status CHAR(1) [ndv 3]") != std::string::npos);
+    EXPECT_TRUE(rendered.find("Indexes: idx_customer(o_customer_id), "
+                              "UNIQUE uk_order(o_id, o_status)") != std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST(CatalogSnapshot, QualifiedNamesAndRowCount) {
+    CatalogSnapshot catalog;
+    TableStatistics stats;
+    stats.row_count = 500;
+    catalog.updateTable("Customer", stats);
+
+    uint64_t rows = 0;
+    ASSERT_TRUE(catalog.rowCount("tpch.CUSTOMER", &rows));
+    EXPECT_EQ(rows, 500u);
+    EXPECT_FALSE(catalog.rowCount("supplier", &rows));
+    EXPECT_EQ(catalog.statsVersion("supplier"), 0u);
+
+    TableSchema unknown;
+    unknown.table_name = "supplier";
+    EXPECT_FALSE(catalog.annotate(unknown));
+    EXPECT_EQ(unknown.row_count, 0u);
+}
+
+TEST(CatalogSnapshot, MalformedFileKeepsContents) {
+    CatalogSnapshot catalog;
+    TableStatistics stats;
+    stats.row_count = 10;
+    catalog.updateTable("orders", stats);
+
+    const std::string path = tempPath("malformed");
+    writeFile(path, "table orders 100\nndv orders\n");
+    std::string error;
+    EXPECT_FALSE(catalog.loadFromFile(path, &error));
+    EXPECT_TRUE(error.find(":2:") != std::string::npos);
+    uint64_t rows = 0;
+    ASSERT_TRUE(catalog.rowCount("orders", &rows));
+    EXPECT_EQ(rows, 10u);
+    std::remove(path.c_str());
+}
+
+TEST(CatalogSnapshot, SwapIsPickedUpByRenderCache) {
+    CatalogSnapshot catalog;
+    TableStatistics before;
+    before.row_count = 1000;
+    catalog.updateTable("orders", before);
+
+    auto cache = std::make_shared<SchemaRenderCache>();
+    TableSchema orders = ordersTable();
+    catalog.annotate(orders);
+    const uint64_t first_version = orders.stats_version;
+    const std::string first = *cache->get(orders);
+    EXPECT_TRUE(first.find("(~1.0K rows)") != std::string::npos);
+
+    // ANALYZE之后整表替换：新版本号选中新的渲染变体
+    TableStatistics after;
+    after.row_count = 5000000;
+    IndexDefinition index;
+    index.name = "idx_status";
+    index.columns = {"o_status"};
+    after.indexes.push_back(index);
+    catalog.updateTable("ORDERS", after);
+
+    TableSchema reloaded = ordersTable();
+    catalog.annotate(reloaded);
+    EXPECT_TRUE(reloaded.stats_version > first_version);
+    const std::string second = *cache->get(reloaded);
+    EXPECT_TRUE(second.find("(~5.0M rows)") != std::string::npos);
+    EXPECT_TRUE(second.find("Indexes: idx_status(o_status)") != std::string::npos);
+
+    // 从文件加载替换全部内容，未出现在文件中的表被移除
+    const std::string path = tempPath("swap");
+    writeFile(path, "table lineitem 6001215\n");
+    ASSERT_TRUE(catalog.loadFromFile(path));
+    uint64_t rows = 0;
+    EXPECT_FALSE(catalog.rowCount("orders", &rows));
+    ASSERT_TRUE(catalog.rowCount("lineitem", &rows));
+    EXPECT_EQ(rows, 6001215u);
+    std::remove(path.c_str());
+
+    catalog.removeTable("lineitem");
+    EXPECT_EQ(catalog.tableCount(), 0u);
+}
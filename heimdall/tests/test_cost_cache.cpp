@@ -0,0 +1,50 @@
+/**
+ * @file test_cost_cache.cpp
+ * @brief 代价估算缓存测试
+ */
+
+#include "test_framework.h"
+#include "optimizer_integration/cost_cache.h"
+#include <thread>
+
+using heimdall::optimizer::CostCache;
+using heimdall::optimizer::CostCacheConfig;
+
+TEST(CostCache, StatisticsVersionChangeInvalidates) {
+    CostCache cache;
+    cache.insert(1, 10, 250.0);
+    double cost = 0.0;
+    ASSERT_TRUE(cache.lookup(1, 10, &cost));
+    EXPECT_NEAR(cost, 250.0, 1e-9);
+    // ANALYZE之后版本组合变化
+    EXPECT_FALSE(cache.lookup(1, 11, &cost));
+    EXPECT_EQ(cache.size(), 0u);
+    const auto stats = cache.getStats();
+    EXPECT_EQ(stats.stale, 1u);
+}
+
+TEST(CostCache, ExpiresAfterTtl) {
+    CostCacheConfig config;
+    config.ttl = std::chrono::seconds(1);
+    CostCache cache(config);
+    cache.insert(1, 0, 5.0);
+    double cost = 0.0;
+    EXPECT_TRUE(cache.lookup(1, 0, &cost));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1050));
+    EXPECT_FALSE(cache.lookup(1, 0, &cost));
+}
+
+TEST(CostCache, EvictsLeastRecentlyUsedAndSkipsFailures) {
+    CostCacheConfig config;
+    config.max_entries = 2;
+    CostCache cache(config);
+    cache.insert(1, 0, 1.0);
+    cache.insert(2, 0, 2.0);
+    double cost = 0.0;
+    EXPECT_TRUE(cache.lookup(1, 0, &cost));
+    cache.insert(3, 0, 3.0);
+    EXPECT_FALSE(cache.lookup(2, 0, &cost));
+    EXPECT_TRUE(cache.lookup(1, 0, &cost));
+    cache.insert(4, 0, -1.0);
+    EXPECT_FALSE(cache.lookup(4, 0, &cost));
+}
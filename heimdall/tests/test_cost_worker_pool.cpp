@@ -0,0 +1,65 @@
+/**
+ * @file test_cost_worker_pool.cpp
+ * @brief 并行代价估算线程池测试
+ */
+
+#include "test_framework.h"
+#include "optimizer_integration/cost_worker_pool.h"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+using heimdall::optimizer::CostWorkerPool;
+
+TEST(CostWorkerPool, ResultsFollowInputOrder) {
+    // 越靠前的SQL估算越慢，完成顺序与输入顺序相反
+    CostWorkerPool pool(4, [](const std::string& sql, void*) {
+        const int n = std::stoi(sql);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5 * (8 - n)));
+        return static_cast<double>(n * 10);
+    });
+    const std::vector<std::string_view> sqls = {"1", "2", "3", "4", "5", "6", "7"};
+    const auto costs = pool.estimateAll(sqls);
+    ASSERT_TRUE(costs.size() == sqls.size());
+    for (size_t i = 0; i < costs.size(); ++i) {
+        EXPECT_NEAR(costs[i], static_cast<double>((i + 1) * 10), 1e-9);
+    }
+}
+
+TEST(CostWorkerPool, ExceptionsBecomeFailures) {
+    CostWorkerPool pool(2, [](const std::string& sql, void*) -> double {
+        if (sql == "bad") throw std::runtime_error("estimate failed");
+        return 1.0;
+    });
+    const auto costs = pool.estimateAll({"ok", "bad", "ok"});
+    ASSERT_TRUE(costs.size() == 3u);
+    EXPECT_NEAR(costs[0], 1.0, 1e-9);
+    EXPECT_TRUE(costs[1] < 0);
+    EXPECT_NEAR(costs[2], 1.0, 1e-9);
+    const auto stats = pool.getStats();
+    EXPECT_EQ(stats.failures, 1u);
+}
+
+TEST(CostWorkerPool, EachWorkerUsesItsOwnContext) {
+    std::atomic<int> created{0};
+    std::atomic<int> deleted{0};
+    {
+        CostWorkerPool pool(
+            3,
+            [](const std::string&, void* context) {
+                return static_cast<double>(*static_cast<int*>(context));
+            },
+            [&created]() -> void* { return new int(++created); },
+            [&deleted](void* context) {
+                delete static_cast<int*>(context);
+                ++deleted;
+            });
+        const auto costs = pool.estimateAll({"a", "b", "c", "d"});
+        for (double cost : costs) {
+            EXPECT_TRUE(cost >= 1.0 && cost <= 3.0);
+        }
+    }
+    EXPECT_EQ(created.load(), 3);
+    EXPECT_EQ(deleted.load(), 3);
+}
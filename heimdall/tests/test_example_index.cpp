@@ -0,0 +1,78 @@
+/**
+ * @file test_example_index.cpp
+ * @brief Few-shot示例相似度索引测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/example_index.h"
+#include <string>
+#include <vector>
+
+using heimdall::llm::ExampleIndex;
+
+namespace {
+
+void addExamples(ExampleIndex* index) {
+    index->add("SELECT name FROM users WHERE id IN (SELECT user_id FROM orders WHERE total > 100)");
+    index->add("SELECT o.id, c.name FROM orders o JOIN customers c ON o.customer_id = c.id "
+               "JOIN regions r ON c.region_id = r.id WHERE r.name = 'east'");
+    index->add("SELECT COUNT(*) FROM logs WHERE created_at > '2024-01-01' GROUP BY level");
+}
+
+} // namespace
+
+TEST(ExampleIndex, LiteralsDoNotChangeSignature) {
+    const ExampleIndex::Signature a =
+        ExampleIndex::signature("SELECT * FROM t WHERE id = 1 AND name = 'x'");
+    const ExampleIndex::Signature b =
+        ExampleIndex::signature("select * from t where id = 42 and name = 'yyy'");
+    EXPECT_NEAR(ExampleIndex::similarity(a, b), 1.0, 1e-9);
+}
+
+TEST(ExampleIndex, SameShapeQueryFindsExample) {
+    ExampleIndex index;
+    addExamples(&index);
+    EXPECT_EQ(index.size(), 3u);
+
+    // 与0号示例同为IN子查询、涉及相同的表，只有字面量不同
+    const std::vector<size_t> ids = index.nearest(
+        "SELECT name FROM users WHERE id IN (SELECT user_id FROM orders WHERE total > 5000)", 1);
+    ASSERT_TRUE(ids.size() == 1);
+    EXPECT_EQ(ids[0], 0u);
+
+    const std::vector<size_t> joins = index.nearest(
+        "SELECT o.id, c.name FROM orders o JOIN customers c ON o.customer_id = c.id "
+        "JOIN regions r ON c.region_id = r.id WHERE r.name = 'west'", 1);
+    ASSERT_TRUE(joins.size() == 1);
+    EXPECT_EQ(joins[0], 1u);
+}
+
+TEST(ExampleIndex, DifferentShapeScoresLow) {
+    ExampleIndex index;
+    addExamples(&index);
+
+    const std::string query = "UPDATE inventory SET stock = stock - 1 WHERE sku = 'abc'";
+    const ExampleIndex::Signature sig = ExampleIndex::signature(query);
+    const ExampleIndex::Signature in_subquery = ExampleIndex::signature(
+        "SELECT name FROM users WHERE id IN (SELECT user_id FROM orders WHERE total > 100)");
+    EXPECT_TRUE(ExampleIndex::similarity(sig, in_subquery) < 0.2);
+
+    // 结构与表都不同的查询不应把IN子查询示例排在首位
+    const ExampleIndex::Signature same_shape = ExampleIndex::signature(
+        "SELECT name FROM users WHERE id IN (SELECT user_id FROM orders WHERE total > 7)");
+    EXPECT_TRUE(ExampleIndex::similarity(same_shape, in_subquery) >
+                ExampleIndex::similarity(sig, in_subquery));
+}
+
+TEST(ExampleIndex, NearestReturnsAtMostK) {
+    ExampleIndex index;
+    EXPECT_TRUE(index.nearest("SELECT 1", 3).empty());
+
+    addExamples(&index);
+    const std::vector<size_t> ids = index.nearest("SELECT 1", 10);
+    EXPECT_EQ(ids.size(), 3u);
+
+    index.clear();
+    EXPECT_EQ(index.size(), 0u);
+    EXPECT_TRUE(index.nearest("SELECT 1", 3).empty());
+}
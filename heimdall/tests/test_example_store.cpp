@@ -0,0 +1,91 @@
+/**
+ * @file test_example_store.cpp
+ * @brief Few-shot示例库测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/example_store.h"
+#include <cstdio>
+#include <fstream>
+
+using heimdall::llm::ExampleStore;
+using heimdall::llm::ExampleStoreConfig;
+using heimdall::llm::FewShotExample;
+
+namespace {
+
+FewShotExample example(const std::string& original, double speedup) {
+    FewShotExample ex;
+    ex.original_sql = original;
+    ex.optimized_sql = original + " /* rewritten */";
+    ex.explanation = "line1\n\tline2 \\ end";
+    ex.speedup_ratio = speedup;
+    return ex;
+}
+
+std::string tempPath(const char* name) {
+    return std::string("/tmp/heimdall_test_") + name + ".tsv";
+}
+
+} // namespace
+
+TEST(ExampleStore, SaveLoadRoundTrip) {
+    ExampleStore store;
+    store.harvest(1, example("SELECT 1", 3.0));
+    store.harvest(2, example("SELECT 2", 1.5));
+    const std::string path = tempPath("round_trip");
+    ASSERT_TRUE(store.save(path));
+    EXPECT_FALSE(store.dirty());
+
+    ExampleStore loaded;
+    std::string error;
+    ASSERT_TRUE(loaded.load(path, &error));
+    const auto examples = loaded.examples();
+    ASSERT_TRUE(examples.size() == 2u);
+    EXPECT_EQ(examples[0].original_sql, std::string("SELECT 1"));
+    EXPECT_EQ(examples[0].explanation, std::string("line1\n\tline2 \\ end"));
+    EXPECT_NEAR(examples[1].speedup_ratio, 1.5, 1e-4);
+    std::remove(path.c_str());
+}
+
+TEST(ExampleStore, LowerSpeedupDuplicateMarksDirty) {
+    ExampleStore store;
+    store.harvest(7, example("SELECT 7", 4.0));
+    const std::string path = tempPath("dirty");
+    ASSERT_TRUE(store.save(path));
+
+    // 示例不变，但出现次数变化需要持久化
+    EXPECT_FALSE(store.harvest(7, example("SELECT 7 ", 2.0)));
+    EXPECT_TRUE(store.dirty());
+    const auto examples = store.examples();
+    ASSERT_TRUE(examples.size() == 1u);
+    EXPECT_NEAR(examples[0].speedup_ratio, 4.0, 1e-9);
+    std::remove(path.c_str());
+}
+
+TEST(ExampleStore, EvictsLowestValue) {
+    ExampleStoreConfig config;
+    config.max_examples = 2;
+    ExampleStore store(config);
+    store.harvest(1, example("SELECT 1", 2.0));
+    store.harvest(2, example("SELECT 2", 8.0));
+    store.harvest(1, example("SELECT 1", 2.0));   // 出现两次，价值1×2，低于8倍示例的3
+    store.harvest(3, example("SELECT 3", 1.3));
+    EXPECT_EQ(store.size(), 2u);
+    const auto examples = store.examples();
+    EXPECT_EQ(examples[0].original_sql, std::string("SELECT 2"));
+    EXPECT_EQ(examples[1].original_sql, std::string("SELECT 1"));
+}
+
+TEST(ExampleStore, RejectsMalformedFile) {
+    const std::string path = tempPath("malformed");
+    {
+        std::ofstream file(path);
+        file << "0000000000000001\tnot-a-number\t1\ta\tb\tc\n";
+    }
+    ExampleStore store;
+    std::string error;
+    EXPECT_FALSE(store.load(path, &error));
+    EXPECT_TRUE(error.find(":1:") != std::string::npos);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,98 @@
+/**
+ * @file test_framework.h
+ * @brief 单元测试的最小注册与断言宏
+ *
+ * TEST(Suite, Name)定义的用例在静态初始化时注册，由test_main.cpp按注册顺序执行；
+ * EXPECT_*失败时记录位置并继续，ASSERT_*失败时结束当前用例。
+ */
+
+#ifndef HEIMDALL_TEST_FRAMEWORK_H
+#define HEIMDALL_TEST_FRAMEWORK_H
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace heimdall {
+namespace test {
+
+struct TestCase {
+    const char* suite;
+    const char* name;
+    void (*body)();
+};
+
+std::vector<TestCase>& registry();
+
+/**
+ * @brief 当前用例的失败次数，由test_main在每个用例开始前清零
+ */
+int& currentFailures();
+
+struct Registrar {
+    Registrar(const char* suite, const char* name, void (*body)()) {
+        registry().push_back(TestCase{suite, name, body});
+    }
+};
+
+inline void reportFailure(const char* file, int line, const std::string& message) {
+    ++currentFailures();
+    std::cerr << file << ":" << line << ": " << message << std::endl;
+}
+
+template <typename A, typename B>
+std::string describeMismatch(const char* expr_a, const char* expr_b,
+                             const A& a, const B& b) {
+    std::ostringstream out;
+    out << "expected " << expr_a << " == " << expr_b
+        << "\n  actual: " << a << "\n  vs:     " << b;
+    return out.str();
+}
+
+} // namespace test
+} // namespace heimdall
+
+#define TEST(suite, name)                                                   \
+    static void suite##_##name##_body();                                    \
+    static ::heimdall::test::Registrar suite##_##name##_registrar(          \
+        #suite, #name, &suite##_##name##_body);                             \
+    static void suite##_##name##_body()
+
+#define EXPECT_TRUE(cond)                                                   \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            ::heimdall::test::reportFailure(__FILE__, __LINE__,             \
+                                            "expected true: " #cond);       \
+        }                                                                   \
+    } while (0)
+
+#define EXPECT_FALSE(cond) EXPECT_TRUE(!(cond))
+
+#define EXPECT_EQ(a, b)                                                     \
+    do {                                                                    \
+        const auto& heimdall_a_ = (a);                                      \
+        const auto& heimdall_b_ = (b);                                      \
+        if (!(heimdall_a_ == heimdall_b_)) {                                \
+            ::heimdall::test::reportFailure(                                \
+                __FILE__, __LINE__,                                         \
+                ::heimdall::test::describeMismatch(#a, #b, heimdall_a_,     \
+                                                   heimdall_b_));           \
+        }                                                                   \
+    } while (0)
+
+#define EXPECT_NE(a, b) EXPECT_TRUE((a) != (b))
+
+#define EXPECT_NEAR(a, b, eps) EXPECT_TRUE(std::fabs((a) - (b)) <= (eps))
+
+#define ASSERT_TRUE(cond)                                                   \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            ::heimdall::test::reportFailure(__FILE__, __LINE__,             \
+                                            "assertion failed: " #cond);    \
+            return;                                                         \
+        }                                                                   \
+    } while (0)
+
+#endif
@@ -0,0 +1,37 @@
+/**
+ * @file test_frequency_sketch.cpp
+ * @brief Count-Min频率估计测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/frequency_sketch.h"
+
+using heimdall::llm::FrequencySketch;
+
+TEST(FrequencySketch, CountsSaturateAtFifteen) {
+    FrequencySketch sketch(1000);
+    EXPECT_EQ(sketch.frequency(42), 0);
+    for (int i = 0; i < 5; ++i) sketch.increment(42);
+    EXPECT_EQ(sketch.frequency(42), 5);
+    for (int i = 0; i < 100; ++i) sketch.increment(42);
+    EXPECT_EQ(sketch.frequency(42), 15);
+}
+
+TEST(FrequencySketch, HotKeysOutrankColdKeys) {
+    FrequencySketch sketch(1000);
+    for (uint64_t key = 1; key <= 500; ++key) sketch.increment(key * 0x9e3779b97f4a7c15ULL);
+    for (int i = 0; i < 8; ++i) sketch.increment(7);
+    EXPECT_TRUE(sketch.frequency(7) >= 8);
+    // Count-Min只会高估，冷键的估计值应远小于热键
+    EXPECT_TRUE(sketch.frequency(3 * 0x9e3779b97f4a7c15ULL) < sketch.frequency(7));
+}
+
+TEST(FrequencySketch, AgingHalvesCounters) {
+    FrequencySketch sketch(1);   // 累计10次记录后衰减
+    for (int i = 0; i < 9; ++i) sketch.increment(99);
+    EXPECT_EQ(sketch.frequency(99), 9);
+    sketch.increment(99);
+    EXPECT_EQ(sketch.frequency(99), 5);
+    sketch.clear();
+    EXPECT_EQ(sketch.frequency(99), 0);
+}
@@ -0,0 +1,107 @@
+/**
+ * @file test_llm_client.cpp
+ * @brief LLM客户端与提供商测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/llm_client.h"
+#include "llm_generator/sql_grammar.h"
+
+using heimdall::llm::GenerationConfig;
+using heimdall::llm::LLMClient;
+using heimdall::llm::LocalModelProvider;
+using heimdall::llm::SqlGrammar;
+using heimdall::llm::TableSchema;
+
+namespace {
+
+std::shared_ptr<const SqlGrammar> itemGrammar() {
+    TableSchema item;
+    item.table_name = "item";
+    item.columns = {"i_item_sk INT", "i_category CHAR(50)"};
+    return SqlGrammar::forSelect({item});
+}
+
+struct FakeServer {
+    std::string last_body;
+    std::string reply;
+    int calls = 0;
+
+    heimdall::llm::HttpTransport transport() {
+        return [this](const std::string&, const std::vector<std::string>&,
+                      const std::string& body, std::string* response, std::string*) {
+            ++calls;
+            last_body = body;
+            *response = reply;
+            return true;
+        };
+    }
+};
+
+const char* kTwoCandidates =
+    "{\"candidates\":[\"```sql\\nSELECT i_item_sk FROM item\\n```\","
+    "\"DELETE FROM item\"]}";
+
+} // namespace
+
+TEST(LocalModelProvider, SendsGrammarWhenSupported) {
+    FakeServer server;
+    server.reply = kTwoCandidates;
+    LocalModelProvider provider("http://localhost:8080/generate");
+    provider.setTransport(server.transport());
+    provider.setGrammarSupported(true);
+
+    GenerationConfig config;
+    config.grammar = itemGrammar();
+    auto response = provider.generate("rewrite", config);
+
+    EXPECT_TRUE(server.last_body.find("\"grammar\":\"") != std::string::npos);
+    EXPECT_TRUE(server.last_body.find("root ::=") != std::string::npos);
+    // 服务端已约束解码，结果原样返回
+    EXPECT_EQ(response.candidates.size(), 2u);
+}
+
+TEST(LocalModelProvider, FiltersCandidatesWithoutServerGrammar) {
+    FakeServer server;
+    server.reply = kTwoCandidates;
+    LocalModelProvider provider("http://localhost:8080/generate");
+    provider.setTransport(server.transport());
+
+    GenerationConfig config;
+    config.grammar = itemGrammar();
+    auto response = provider.generate("rewrite", config);
+
+    EXPECT_TRUE(server.last_body.find("\"grammar\"") == std::string::npos);
+    ASSERT_TRUE(response.candidates.size() == 1u);
+    EXPECT_EQ(std::string(response.candidates[0]), std::string("SELECT i_item_sk FROM item"));
+}
+
+TEST(LocalModelProvider, TransportFailureIsError) {
+    LocalModelProvider provider("http://localhost:8080/generate");
+    provider.setTransport([](const std::string&, const std::vector<std::string>&,
+                             const std::string&, std::string*, std::string* error) {
+        *error = "connection refused";
+        return false;
+    });
+    auto response = provider.generate("rewrite", GenerationConfig());
+    EXPECT_FALSE(response.success);
+    EXPECT_TRUE(response.error_message.find("connection refused") != std::string::npos);
+}
+
+TEST(LLMClient, CacheHitReturnsSharedResponse) {
+    FakeServer server;
+    server.reply = kTwoCandidates;
+    auto provider = std::make_shared<LocalModelProvider>("http://localhost:8080/generate");
+    provider->setTransport(server.transport());
+
+    LLMClient client;
+    client.registerProvider(provider);
+    client.enableCache(true, 16);
+
+    auto first = client.generateFromPrompt("rewrite");
+    auto second = client.generateFromPrompt("rewrite");
+    EXPECT_TRUE(first->success);
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(server.calls, 1);
+    EXPECT_EQ(client.getCacheStats().hits, 1u);
+}
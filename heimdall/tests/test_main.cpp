@@ -0,0 +1,51 @@
+/**
+ * @file test_main.cpp
+ * @brief 单元测试入口
+ *
+ * 用法: heimdall_test [用例名子串]
+ */
+
+#include "test_framework.h"
+
+namespace heimdall {
+namespace test {
+
+std::vector<TestCase>& registry() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+int& currentFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+} // namespace test
+} // namespace heimdall
+
+int main(int argc, char** argv) {
+    using heimdall::test::currentFailures;
+    using heimdall::test::registry;
+
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int run = 0;
+    int failed = 0;
+    for (const auto& test : registry()) {
+        const std::string full_name = std::string(test.suite) + "." + test.name;
+        if (filter && full_name.find(filter) == std::string::npos) {
+            continue;
+        }
+        currentFailures() = 0;
+        test.body();
+        ++run;
+        if (currentFailures() > 0) {
+            ++failed;
+            std::cout << "[FAILED] " << full_name << std::endl;
+        } else {
+            std::cout << "[  OK  ] " << full_name << std::endl;
+        }
+    }
+
+    std::cout << run - failed << "/" << run << " tests passed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,254 @@
+/**
+ * @file test_prompt_builder.cpp
+ * @brief 重写Prompt构建测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/budget_governor.h"
+#include "llm_generator/prompt_builder.h"
+#include "llm_generator/schema_cache.h"
+#include "llm_generator/schema_pruner.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using heimdall::llm::BudgetGovernor;
+using heimdall::llm::FewShotExample;
+using heimdall::llm::PromptBuilder;
+using heimdall::llm::PromptPrefix;
+using heimdall::llm::PromptTrimReport;
+using heimdall::llm::SchemaRenderCache;
+using heimdall::llm::TableSchema;
+using heimdall::llm::reduceSchema;
+
+namespace {
+
+std::vector<TableSchema> ordersSchema() {
+    TableSchema orders;
+    orders.table_name = "orders";
+    orders.columns = {"o_id INT", "o_customer_id INT", "o_total DECIMAL(10,2)"};
+    orders.primary_keys = {"o_id"};
+    TableSchema customers;
+    customers.table_name = "customers";
+    customers.columns = {"c_id INT", "c_name VARCHAR(64)"};
+    customers.primary_keys = {"c_id"};
+    return {orders, customers};
+}
+
+FewShotExample example(const std::string& original, const std::string& optimized) {
+    FewShotExample result;
+    result.original_sql = original;
+    result.optimized_sql = optimized;
+    result.explanation = "semi join";
+    result.speedup_ratio = 3.0;
+    return result;
+}
+
+const char* const kTrimQuery =
+    "SELECT o_id FROM orders JOIN lineitem ON l_order_id = o_id WHERE o_status = 'F'";
+
+// 一张只有列清单、一张只有create_statement的表，非键列都较长
+std::vector<TableSchema> trimSchemas() {
+    TableSchema orders;
+    orders.table_name = "orders";
+    orders.columns = {"o_id INT", "o_customer_id INT", "o_status CHAR(1)",
+                      "o_shipping_address_line_one VARCHAR(255)",
+                      "o_shipping_address_line_two VARCHAR(255)",
+                      "o_billing_contact_description VARCHAR(255)"};
+    orders.primary_keys = {"o_id"};
+    TableSchema lineitem;
+    lineitem.table_name = "lineitem";
+    lineitem.create_statement =
+        "CREATE TABLE lineitem (\n"
+        "  l_id BIGINT NOT NULL,\n"
+        "  l_order_id INT NOT NULL,\n"
+        "  l_extended_description_text VARCHAR(1024) DEFAULT NULL,\n"
+        "  l_warehouse_handling_instructions VARCHAR(1024) DEFAULT NULL,\n"
+        "  PRIMARY KEY (l_id),\n"
+        "  FOREIGN KEY (l_order_id) REFERENCES orders (o_id)\n"
+        ") ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COMMENT='order line items'";
+    return {orders, lineitem};
+}
+
+void addTrimExamples(PromptBuilder* builder) {
+    builder->addFewShotExample(example(
+        "SELECT o_id FROM orders WHERE o_id IN (SELECT l_order_id FROM lineitem "
+        "WHERE l_extended_description_text LIKE '%fragile%')",
+        "SELECT DISTINCT o.o_id FROM orders o JOIN lineitem l ON l.l_order_id = o.o_id "
+        "WHERE l.l_extended_description_text LIKE '%fragile%'"));
+    builder->addFewShotExample(example(
+        "SELECT * FROM orders WHERE EXISTS (SELECT 1 FROM lineitem WHERE l_order_id = o_id)",
+        "SELECT DISTINCT o.* FROM orders o JOIN lineitem l ON l.l_order_id = o.o_id"));
+}
+
+// 各表按同一删减层级处理后、不带示例的Prompt的估计token数
+size_t tokensWith(bool key_columns_only, bool drop_create_statement) {
+    std::vector<TableSchema> schemas = trimSchemas();
+    if (key_columns_only || drop_create_statement) {
+        for (auto& schema : schemas) {
+            TableSchema reduced;
+            reduceSchema(schema, key_columns_only, drop_create_statement, reduced);
+            schema = reduced;
+        }
+    }
+    PromptBuilder builder;
+    return BudgetGovernor::estimateTokens(builder.buildRewritePrompt(kTrimQuery, schemas, false));
+}
+
+} // namespace
+
+TEST(PromptBuilder, SameSchemaSharesPrefix) {
+    PromptBuilder builder;
+    builder.addFewShotExample(example(
+        "SELECT * FROM orders WHERE o_customer_id IN (SELECT c_id FROM customers)",
+        "SELECT o.* FROM orders o JOIN customers c ON o.o_customer_id = c.c_id"));
+    const std::vector<TableSchema> schemas = ordersSchema();
+
+    std::string first;
+    std::string second;
+    PromptPrefix first_prefix{};
+    PromptPrefix second_prefix{};
+    builder.buildRewritePromptInto(
+        "SELECT o_total FROM orders WHERE o_customer_id IN (SELECT c_id FROM customers)",
+        schemas, true, first, &first_prefix);
+    builder.buildRewritePromptInto(
+        "SELECT c_name FROM customers WHERE c_id = 7", schemas, true, second, &second_prefix);
+
+    EXPECT_TRUE(first != second);
+    EXPECT_TRUE(first_prefix.context_length > first_prefix.static_length);
+    EXPECT_EQ(first_prefix.static_length, second_prefix.static_length);
+    EXPECT_EQ(first_prefix.static_hash, second_prefix.static_hash);
+    EXPECT_EQ(first_prefix.context_length, second_prefix.context_length);
+    EXPECT_EQ(first_prefix.context_hash, second_prefix.context_hash);
+    const std::string first_head = first.substr(0, first_prefix.context_length);
+    const std::string second_head = second.substr(0, second_prefix.context_length);
+    EXPECT_EQ(first_head, second_head);
+    EXPECT_TRUE(first_head.find("orders") != std::string::npos);
+}
+
+TEST(PromptBuilder, DifferentSchemaKeepsStaticPrefix) {
+    PromptBuilder builder;
+    const std::vector<TableSchema> schemas = ordersSchema();
+    const std::vector<TableSchema> orders_only(schemas.begin(), schemas.begin() + 1);
+
+    std::string both;
+    std::string one;
+    PromptPrefix both_prefix{};
+    PromptPrefix one_prefix{};
+    builder.buildRewritePromptInto("SELECT 1 FROM orders", schemas, false, both, &both_prefix);
+    builder.buildRewritePromptInto("SELECT 1 FROM orders", orders_only, false, one, &one_prefix);
+
+    EXPECT_EQ(both_prefix.static_hash, one_prefix.static_hash);
+    EXPECT_NE(both_prefix.context_hash, one_prefix.context_hash);
+}
+
+TEST(PromptBuilder, ReduceSchemaDropsOnlyWhatItNames) {
+    const std::vector<TableSchema> schemas = trimSchemas();
+    TableSchema reduced;
+
+    // 只去掉非键列：列清单只剩键列，DDL改写为只含键列与主外键约束
+    reduceSchema(schemas[0], true, false, reduced);
+    EXPECT_EQ(reduced.columns.size(), 1u);
+    reduceSchema(schemas[1], true, false, reduced);
+    EXPECT_TRUE(reduced.create_statement.find("CREATE TABLE lineitem") != std::string::npos);
+    EXPECT_TRUE(reduced.create_statement.find("l_order_id INT NOT NULL") != std::string::npos);
+    EXPECT_TRUE(reduced.create_statement.find("FOREIGN KEY") != std::string::npos);
+    EXPECT_TRUE(reduced.create_statement.find("l_extended") == std::string::npos);
+
+    // 只去掉create_statement：全部列定义改为列清单
+    reduceSchema(schemas[1], false, true, reduced);
+    EXPECT_TRUE(reduced.create_statement.empty());
+    EXPECT_EQ(reduced.columns.size(), 4u);
+
+    reduceSchema(schemas[1], true, true, reduced);
+    EXPECT_TRUE(reduced.create_statement.empty());
+    EXPECT_EQ(reduced.columns.size(), 2u);
+}
+
+TEST(PromptBuilder, TrimDropsExamplesFirst) {
+    PromptBuilder builder;
+    addTrimExamples(&builder);
+    const std::string full = builder.buildRewritePrompt(kTrimQuery, trimSchemas(), true);
+    const size_t budget = tokensWith(false, false) + 20;
+    ASSERT_TRUE(BudgetGovernor::estimateTokens(full) > budget);
+
+    builder.setPromptTokenBudget(budget);
+    std::string prompt;
+    PromptTrimReport report;
+    builder.buildRewritePromptInto(kTrimQuery, trimSchemas(), true, prompt, nullptr, &report);
+    EXPECT_TRUE(report.examples_dropped > 0);
+    EXPECT_EQ(report.tables_trimmed, 0u);
+    EXPECT_EQ(report.create_statements_dropped, 0u);
+    EXPECT_TRUE(report.within_budget);
+    EXPECT_TRUE(BudgetGovernor::estimateTokens(prompt) <= budget);
+    EXPECT_TRUE(prompt.find("o_billing_contact_description") != std::string::npos);
+    EXPECT_TRUE(prompt.find("l_warehouse_handling_instructions") != std::string::npos);
+}
+
+TEST(PromptBuilder, TrimDropsNonKeyColumnsBeforeCreateStatement) {
+    const size_t keys_only = tokensWith(true, false);
+    const size_t budget = keys_only + 20;
+    ASSERT_TRUE(tokensWith(false, false) > budget);
+    ASSERT_TRUE(tokensWith(true, true) < keys_only);
+
+    PromptBuilder builder;
+    addTrimExamples(&builder);
+    builder.setPromptTokenBudget(budget);
+    std::string prompt;
+    PromptTrimReport report;
+    builder.buildRewritePromptInto(kTrimQuery, trimSchemas(), true, prompt, nullptr, &report);
+    EXPECT_EQ(report.examples_dropped, 2u);
+    EXPECT_TRUE(report.tables_trimmed > 0);
+    EXPECT_EQ(report.create_statements_dropped, 0u);
+    EXPECT_TRUE(report.within_budget);
+    EXPECT_TRUE(BudgetGovernor::estimateTokens(prompt) <= budget);
+    // create_statement仍在，只是不含非键列
+    EXPECT_TRUE(prompt.find("CREATE TABLE lineitem") != std::string::npos);
+    EXPECT_TRUE(prompt.find("l_warehouse_handling_instructions") == std::string::npos);
+    EXPECT_TRUE(prompt.find("o_billing_contact_description") == std::string::npos);
+    EXPECT_TRUE(prompt.find("o_id") != std::string::npos);
+}
+
+TEST(PromptBuilder, TrimDropsCreateStatementLast) {
+    PromptBuilder builder;
+    addTrimExamples(&builder);
+    const size_t budget = tokensWith(true, true) + 20;
+    ASSERT_TRUE(tokensWith(true, false) > budget);
+    builder.setPromptTokenBudget(budget);
+
+    std::string prompt;
+    PromptTrimReport report;
+    builder.buildRewritePromptInto(kTrimQuery, trimSchemas(), true, prompt, nullptr, &report);
+    EXPECT_EQ(report.examples_dropped, 2u);
+    EXPECT_TRUE(report.create_statements_dropped > 0);
+    EXPECT_TRUE(report.within_budget);
+    EXPECT_TRUE(BudgetGovernor::estimateTokens(prompt) <= budget);
+    EXPECT_TRUE(prompt.find("CREATE TABLE") == std::string::npos);
+    EXPECT_TRUE(prompt.find("l_order_id") != std::string::npos);
+
+    // 系统提示词与约束从不裁剪，预算过小时报告超出
+    builder.setPromptTokenBudget(1);
+    builder.buildRewritePromptInto(kTrimQuery, trimSchemas(), true, prompt, nullptr, &report);
+    EXPECT_FALSE(report.within_budget);
+}
+
+TEST(PromptBuilder, TrimmedSchemasStayOutOfSharedCache) {
+    auto cache = std::make_shared<SchemaRenderCache>();
+    PromptBuilder builder;
+    builder.setSchemaCache(cache);
+    builder.setPromptTokenBudget(tokensWith(true, true) + 20);
+
+    std::string prompt;
+    builder.buildRewritePromptInto(kTrimQuery, trimSchemas(), false, prompt);
+    const SchemaRenderCache::Stats first = cache->getStats();
+    EXPECT_EQ(first.misses, 2u);
+    builder.buildRewritePromptInto(kTrimQuery, trimSchemas(), false, prompt);
+    const SchemaRenderCache::Stats second = cache->getStats();
+    EXPECT_EQ(second.misses, 2u);
+
+    // 不受预算限制的构建仍得到完整的Schema
+    builder.setPromptTokenBudget(0);
+    builder.buildRewritePromptInto(kTrimQuery, trimSchemas(), false, prompt);
+    EXPECT_TRUE(prompt.find("l_warehouse_handling_instructions") != std::string::npos);
+    EXPECT_EQ(cache->getStats().misses, 2u);
+}
@@ -0,0 +1,121 @@
+/**
+ * @file test_prompt_snapshot.cpp
+ * @brief Prompt快照发布测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/prompt_snapshot.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using heimdall::llm::FewShotExample;
+using heimdall::llm::PromptBuilder;
+using heimdall::llm::PromptSnapshot;
+using heimdall::llm::PromptSnapshotPublisher;
+using heimdall::llm::TableSchema;
+
+namespace {
+
+const char* const kQuery = "SELECT id FROM t WHERE id IN (SELECT t_id FROM u)";
+
+std::vector<TableSchema> schemas() {
+    TableSchema t;
+    t.table_name = "t";
+    t.columns = {"id INT"};
+    return {t};
+}
+
+FewShotExample example(const std::string& marker) {
+    FewShotExample result;
+    result.original_sql = "SELECT id FROM t WHERE id IN (SELECT " + marker + " FROM u)";
+    result.optimized_sql = "SELECT t.id FROM t JOIN u ON t.id = u." + marker;
+    result.explanation = marker;
+    result.speedup_ratio = 2.0;
+    return result;
+}
+
+} // namespace
+
+TEST(PromptSnapshotPublisher, HeldSnapshotSurvivesPublish) {
+    PromptSnapshotPublisher publisher;
+    const uint64_t initial = publisher.version();
+    const PromptSnapshot old_snapshot = publisher.current();
+    const std::string before = old_snapshot->buildRewritePrompt(kQuery, schemas());
+
+    const uint64_t version = publisher.update([](PromptBuilder& builder) {
+        builder.addFewShotExample(example("marker_one"));
+    });
+    EXPECT_TRUE(version > initial);
+    EXPECT_EQ(publisher.version(), version);
+
+    // 持有旧快照的读者不受发布影响
+    const std::string held = old_snapshot->buildRewritePrompt(kQuery, schemas());
+    EXPECT_EQ(held, before);
+    EXPECT_TRUE(held.find("marker_one") == std::string::npos);
+
+    // 新读者看到新的构建器
+    const PromptSnapshot fresh = publisher.current();
+    EXPECT_TRUE(fresh.get() != old_snapshot.get());
+    EXPECT_TRUE(fresh->buildRewritePrompt(kQuery, schemas()).find("marker_one") !=
+                std::string::npos);
+}
+
+TEST(PromptSnapshotPublisher, UpdateStartsFromLatestSnapshot) {
+    PromptSnapshotPublisher publisher;
+    publisher.update([](PromptBuilder& builder) {
+        builder.addFewShotExample(example("marker_one"));
+    });
+    publisher.update([](PromptBuilder& builder) {
+        builder.addFewShotExample(example("marker_two"));
+    });
+    const std::string prompt = publisher.current()->buildRewritePrompt(kQuery, schemas());
+    EXPECT_TRUE(prompt.find("marker_one") != std::string::npos);
+    EXPECT_TRUE(prompt.find("marker_two") != std::string::npos);
+
+    // publish()整体替换，不继承之前的示例
+    PromptBuilder replacement;
+    replacement.setSystemPrompt("replacement system prompt\n");
+    publisher.publish(replacement);
+    const std::string replaced = publisher.current()->buildRewritePrompt(kQuery, schemas());
+    EXPECT_TRUE(replaced.find("replacement system prompt") != std::string::npos);
+    EXPECT_TRUE(replaced.find("marker_one") == std::string::npos);
+}
+
+TEST(PromptSnapshotPublisher, ReadersStayConsistentDuringPublishes) {
+    PromptSnapshotPublisher publisher;
+    std::atomic<bool> stop(false);
+    std::atomic<int> inconsistent(0);
+    std::atomic<int> builds(0);
+
+    // 每个读者在同一快照上构建两次，结果必须相同
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 2; ++i) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                const PromptSnapshot snapshot = publisher.current();
+                const std::string first = snapshot->buildRewritePrompt(kQuery, schemas());
+                const std::string second = snapshot->buildRewritePrompt(kQuery, schemas());
+                if (first != second) {
+                    ++inconsistent;
+                }
+                ++builds;
+            }
+        });
+    }
+    for (int i = 0; i < 20; ++i) {
+        publisher.update([i](PromptBuilder& builder) {
+            builder.addFewShotExample(example("marker_" + std::to_string(i)));
+        });
+    }
+    while (builds.load() < 20) {
+        std::this_thread::yield();
+    }
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(inconsistent.load(), 0);
+    EXPECT_EQ(publisher.version(), 21u);
+}
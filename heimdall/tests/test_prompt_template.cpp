@@ -0,0 +1,65 @@
+/**
+ * @file test_prompt_template.cpp
+ * @brief 预编译Prompt模板测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/prompt_template.h"
+#include <string>
+
+using heimdall::llm::PromptFragments;
+using heimdall::llm::PromptTemplate;
+
+TEST(PromptTemplate, SubstitutesRepeatedSlots) {
+    const PromptTemplate compiled("a{{x}}b{{y}}c{{x}}");
+    EXPECT_EQ(compiled.slotCount(), 2u);
+    EXPECT_EQ(compiled.slotIndex("x"), 0u);
+    EXPECT_EQ(compiled.slotIndex("y"), 1u);
+    EXPECT_EQ(compiled.staticSize(), 3u);
+
+    PromptFragments slots[2];
+    slots[0].add("1");
+    slots[0].add("2");
+    slots[1].add("3");
+    EXPECT_EQ(compiled.render(slots), std::string("a12b3c12"));
+    EXPECT_EQ(compiled.renderedOffset(slots, 1), 4u);
+}
+
+TEST(PromptTemplate, EmptyAndUnknownSlots) {
+    const PromptTemplate compiled("[{{a}}]({{b}})");
+    EXPECT_EQ(compiled.slotIndex("missing"), PromptTemplate::npos);
+
+    // 没有内容的槽位渲染为空
+    PromptFragments slots[2];
+    slots[1].add("");
+    slots[1].add("B");
+    EXPECT_EQ(slots[1].pieces().size(), 1u);
+    EXPECT_EQ(compiled.render(slots), std::string("[](B)"));
+    // 模板之外的槽位下标偏移为全文长度
+    EXPECT_EQ(compiled.renderedOffset(slots, compiled.slotCount()), 5u);
+}
+
+TEST(PromptTemplate, UnclosedBracesStayLiteral) {
+    const PromptTemplate compiled("x {{y");
+    EXPECT_EQ(compiled.slotCount(), 0u);
+    EXPECT_EQ(compiled.render(nullptr), std::string("x {{y"));
+}
+
+TEST(PromptTemplate, RendersWithOneReservation) {
+    const PromptTemplate compiled("static head {{body}} static tail");
+    const std::string body(5000, 'b');
+    PromptFragments slots[1];
+    slots[0].add(body);
+
+    std::string out;
+    compiled.renderTo(slots, out);
+    EXPECT_EQ(out.size(), compiled.staticSize() + slots[0].bytes());
+
+    // 预留的容量正好装下结果，再次渲染复用同一块内存
+    const char* data = out.data();
+    const size_t capacity = out.capacity();
+    compiled.renderTo(slots, out);
+    EXPECT_EQ(static_cast<const void*>(out.data()), static_cast<const void*>(data));
+    EXPECT_EQ(out.capacity(), capacity);
+    EXPECT_EQ(out, "static head " + body + " static tail");
+}
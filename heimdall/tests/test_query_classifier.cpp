@@ -0,0 +1,42 @@
+/**
+ * @file test_query_classifier.cpp
+ * @brief shouldOptimize初筛测试
+ */
+
+#include "test_framework.h"
+#include "optimizer_integration/query_classifier.h"
+
+using heimdall::optimizer::ClassifierRules;
+using heimdall::optimizer::ClassifierVerdict;
+using heimdall::optimizer::StatementType;
+using heimdall::optimizer::classifyQuery;
+
+TEST(QueryClassifier, PointLookupIsNotCandidate) {
+    const auto result = classifyQuery("SELECT c_balance FROM customer WHERE c_id = 1234");
+    EXPECT_FALSE(result.candidate);
+    EXPECT_TRUE(result.verdict == ClassifierVerdict::NO_TRIGGER);
+    EXPECT_TRUE(result.statement_type == StatementType::SELECT);
+}
+
+TEST(QueryClassifier, StraightJoinCountsAsJoin) {
+    const auto result =
+        classifyQuery("SELECT * FROM orders STRAIGHT_JOIN customer ON o_c_id = c_id");
+    EXPECT_TRUE(result.candidate);
+    EXPECT_TRUE(result.verdict == ClassifierVerdict::COMPLEX_JOIN);
+}
+
+TEST(QueryClassifier, IntersectEndsFromClause) {
+    ClassifierRules rules;
+    rules.min_table_count = 3;
+    // INTERSECT之后select列表中的逗号不是连接
+    const auto result =
+        classifyQuery("SELECT a, b FROM t1 INTERSECT SELECT a, b FROM t2", rules);
+    EXPECT_FALSE(result.candidate);
+    EXPECT_EQ(result.table_count, 2);
+}
+
+TEST(QueryClassifier, InsertValuesIsUnsupported) {
+    const auto result = classifyQuery("INSERT INTO t (a, b) VALUES (1, 2)");
+    EXPECT_FALSE(result.candidate);
+    EXPECT_TRUE(result.verdict == ClassifierVerdict::UNSUPPORTED);
+}
@@ -0,0 +1,59 @@
+/**
+ * @file test_query_fingerprint.cpp
+ * @brief 查询模板规范化与指纹测试
+ */
+
+#include "test_framework.h"
+#include "optimizer_integration/query_fingerprint.h"
+
+using heimdall::optimizer::computeQueryDigest;
+using heimdall::optimizer::computeStatementFingerprint;
+using heimdall::optimizer::extractLiterals;
+using heimdall::optimizer::normalizeQuery;
+
+TEST(QueryFingerprint, NormalizesLiteralsCaseAndWhitespace) {
+    EXPECT_EQ(normalizeQuery("SELECT  a FROM t\n WHERE b = 'x' AND c > 1.5e+3 -- note\n;"),
+              std::string("select a from t where b=? and c>?"));
+}
+
+TEST(QueryFingerprint, FoldsInLists) {
+    EXPECT_EQ(normalizeQuery("select * from t where a in (1, 2, 3)"),
+              std::string("select*from t where a in(?)"));
+    EXPECT_EQ(computeQueryDigest("select * from t where a in (1)"),
+              computeQueryDigest("select * from t where a IN (4,5,6,7)"));
+}
+
+TEST(QueryFingerprint, FoldsValuesRows) {
+    EXPECT_EQ(normalizeQuery("INSERT INTO t VALUES (1,'a'),(2,'b')"),
+              std::string("insert into t values(?),(?)"));
+}
+
+TEST(QueryFingerprint, KeepsFunctionArgumentCount) {
+    EXPECT_EQ(normalizeQuery("select substr(x, 1, 3) from t"),
+              std::string("select substr(x,?,?)from t"));
+    EXPECT_NE(computeQueryDigest("select substr(x,1,3) from t"),
+              computeQueryDigest("select substr(x,1) from t"));
+    // IN列表之后的函数参数不受影响
+    EXPECT_EQ(normalizeQuery("select * from t where a in (1,2) and b = mod(c, 3)"),
+              std::string("select*from t where a in(?)and b=mod(c,?)"));
+}
+
+TEST(QueryFingerprint, DigestMatchesNormalizedText) {
+    const char* sql = "SELECT `Col` FROM t WHERE id IN (1,2) /* c */";
+    EXPECT_EQ(computeQueryDigest(sql), computeQueryDigest(normalizeQuery(sql)));
+}
+
+TEST(QueryFingerprint, ExtractsEveryLiteral) {
+    std::vector<std::string_view> literals;
+    extractLiterals("select * from t where a in (1,2) and s = 'it''s'", &literals);
+    ASSERT_TRUE(literals.size() == 3);
+    EXPECT_EQ(literals[0], std::string_view("1"));
+    EXPECT_EQ(literals[2], std::string_view("'it''s'"));
+}
+
+TEST(QueryFingerprint, StatementFingerprintSeesLiteralValues) {
+    EXPECT_EQ(computeStatementFingerprint("select * from t where a = 1"),
+              computeStatementFingerprint("SELECT *  FROM t WHERE a=1"));
+    EXPECT_NE(computeStatementFingerprint("select * from t where a = 1"),
+              computeStatementFingerprint("select * from t where a = 2"));
+}
@@ -0,0 +1,160 @@
+/**
+ * @file test_response_cache.cpp
+ * @brief LLM响应缓存与响应缓冲测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/llm_response.h"
+#include "llm_generator/response_cache.h"
+#include <string>
+
+using heimdall::llm::LLMResponseBuilder;
+using heimdall::llm::LLMResponsePtr;
+using heimdall::llm::ResponseCache;
+using heimdall::llm::ResponseCacheOptions;
+
+namespace {
+
+LLMResponsePtr makeResponse(const std::string& raw, const std::string& candidate) {
+    LLMResponseBuilder builder(raw.size() + candidate.size());
+    builder.setRawResponse(raw);
+    builder.addCandidate(candidate);
+    return builder.buildShared();
+}
+
+} // namespace
+
+TEST(ResponseBuffer, SmallResponseDoesNotReserveLargeArena) {
+    LLMResponseBuilder builder;
+    builder.setError("LLM budget exhausted");
+    const LLMResponsePtr response = builder.buildShared();
+    const size_t footprint = response->buffer->footprint();
+    EXPECT_TRUE(footprint >= response->error_message.size());
+    EXPECT_TRUE(footprint < 1024);
+}
+
+TEST(ResponseBuffer, FootprintCoversPayload) {
+    const std::string raw(20000, 'x');
+    const LLMResponsePtr response = makeResponse(raw, "SELECT 1");
+    EXPECT_EQ(response->raw_response, raw);
+    EXPECT_TRUE(response->buffer->footprint() >= raw.size() + 8);
+}
+
+TEST(ResponseCache, ChargesResponseFootprint) {
+    ResponseCache cache(16);
+    const std::string raw(20000, 'x');
+    const LLMResponsePtr response = makeResponse(raw, "SELECT 1");
+    cache.put("key", response);
+    const ResponseCache::Stats stats = cache.getStats();
+    EXPECT_TRUE(stats.stored_bytes >= 3 + response->buffer->footprint());
+    const LLMResponsePtr hit = cache.get("key");
+    EXPECT_EQ(hit.get(), response.get());
+}
+
+namespace {
+
+std::string reportSql(int i) {
+    return "SELECT ss_item_sk, SUM(ss_sales_price) FROM store_sales JOIN item ON "
+           "ss_item_sk = i_item_sk WHERE i_category = 'Books' AND ss_quantity > " +
+           std::to_string(i) + " GROUP BY ss_item_sk ORDER BY ss_item_sk";
+}
+
+ResponseCacheOptions compressedOptions() {
+    ResponseCacheOptions options;
+    options.max_entries = 64;
+    options.compress = true;
+    options.retrain_interval = 8;
+    return options;
+}
+
+} // namespace
+
+TEST(ResponseCache, PublishedDictionaryCompressesEarlierEntries) {
+    ResponseCache cache(compressedOptions());
+    for (int i = 0; i < 7; ++i) {
+        cache.put("q" + std::to_string(i),
+                  makeResponse("{\"candidates\": [\"" + reportSql(i) + "\"]}", reportSql(i)));
+    }
+    const size_t before = cache.getStats().stored_bytes;
+    // 第8次写入触发训练，之前未压缩保存的条目随之压缩
+    cache.put("q7", makeResponse("{\"candidates\": [\"" + reportSql(7) + "\"]}", reportSql(7)));
+    const ResponseCache::Stats after = cache.getStats();
+    EXPECT_TRUE(after.stored_bytes < before);
+    EXPECT_TRUE(after.stored_bytes < after.uncompressed_bytes);
+
+    const LLMResponsePtr hit = cache.get("q3");
+    ASSERT_TRUE(hit != nullptr);
+    ASSERT_TRUE(hit->candidates.size() == 1u);
+    EXPECT_EQ(std::string(hit->candidates[0]), reportSql(3));
+    EXPECT_EQ(std::string(hit->raw_response),
+              "{\"candidates\": [\"" + reportSql(3) + "\"]}");
+}
+
+TEST(ResponseCache, TrainingSamplesCountAgainstMemoryBudget) {
+    ResponseCacheOptions options = compressedOptions();
+    options.retrain_interval = 1000;
+    options.max_bytes = 4096;
+    ResponseCache cache(options);
+    for (int i = 0; i < 40; ++i) {
+        cache.put("q" + std::to_string(i), makeResponse("raw", reportSql(i)));
+    }
+    const ResponseCache::Stats stats = cache.getStats();
+    EXPECT_TRUE(stats.sample_bytes > 0u);
+    EXPECT_TRUE(stats.stored_bytes + stats.sample_bytes <= options.max_bytes);
+}
+
+namespace {
+
+// 8个条目，准入窗口1个
+ResponseCacheOptions admissionOptions() {
+    ResponseCacheOptions options;
+    options.max_entries = 8;
+    options.admission = true;
+    options.window_fraction = 0.125;
+    return options;
+}
+
+} // namespace
+
+TEST(ResponseCache, AdmissionRejectsOneHitWonder) {
+    ResponseCache cache(admissionOptions());
+    for (int i = 0; i < 8; ++i) {
+        cache.put("h" + std::to_string(i), makeResponse("raw", reportSql(i)));
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 8; ++i) {
+            cache.get("h" + std::to_string(i));
+        }
+    }
+    cache.get("h7");
+
+    cache.put("adhoc", makeResponse("raw", "SELECT 1"));
+    cache.put("adhoc2", makeResponse("raw", "SELECT 2"));
+    const ResponseCache::Stats stats = cache.getStats();
+    EXPECT_EQ(stats.admission_rejections, 1u);
+    const LLMResponsePtr adhoc = cache.get("adhoc");
+    EXPECT_TRUE(adhoc == nullptr);
+    for (int i = 1; i < 8; ++i) {
+        const LLMResponsePtr hot = cache.get("h" + std::to_string(i));
+        EXPECT_TRUE(hot != nullptr);
+    }
+}
+
+TEST(ResponseCache, FrequentKeyEvictsRareVictim) {
+    ResponseCache cache(admissionOptions());
+    for (int i = 0; i < 8; ++i) {
+        cache.put("r" + std::to_string(i), makeResponse("raw", reportSql(i)));
+    }
+    // 未命中的查找同样计入频率
+    for (int i = 0; i < 3; ++i) {
+        cache.get("report");
+    }
+    cache.put("report", makeResponse("raw", "SELECT report"));
+    cache.put("next", makeResponse("raw", "SELECT next"));
+
+    const LLMResponsePtr report = cache.get("report");
+    ASSERT_TRUE(report != nullptr);
+    EXPECT_EQ(std::string(report->candidates[0]), std::string("SELECT report"));
+    const LLMResponsePtr victim = cache.get("r0");
+    EXPECT_TRUE(victim == nullptr);
+}
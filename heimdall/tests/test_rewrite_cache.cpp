@@ -0,0 +1,64 @@
+/**
+ * @file test_rewrite_cache.cpp
+ * @brief 重写缓存测试
+ */
+
+#include "test_framework.h"
+#include "optimizer_integration/rewrite_cache.h"
+
+using heimdall::optimizer::CachedRewrite;
+using heimdall::optimizer::RewriteCache;
+using heimdall::optimizer::TableVersion;
+using heimdall::optimizer::bindRewrite;
+
+namespace {
+
+CachedRewrite rewrite(uint64_t digest, const std::string& table, uint64_t stats_version,
+                      uint64_t epoch = 0) {
+    CachedRewrite r;
+    r.digest = digest;
+    r.original_sql = "SELECT * FROM " + table + " WHERE a IN (SELECT b FROM t2 WHERE c = 5)";
+    r.rewritten_sql = "SELECT " + table + ".* FROM " + table + " JOIN t2 ON a = b WHERE c = 5";
+    r.cost_original = 100.0;
+    r.cost_optimized = 10.0;
+    r.tables = {TableVersion{table, 0, stats_version}};
+    r.created = std::chrono::steady_clock::now();
+    r.epoch = epoch;
+    return r;
+}
+
+} // namespace
+
+TEST(RewriteCache, StatisticsInvalidationDropsOlderVersions) {
+    RewriteCache cache;
+    ASSERT_TRUE(cache.insert(rewrite(1, "orders", 3)));
+    ASSERT_TRUE(cache.insert(rewrite(2, "Orders", 5)));
+    EXPECT_EQ(cache.invalidateStatistics("ORDERS", 4), 1u);
+    EXPECT_TRUE(cache.lookup(1) == nullptr);
+    EXPECT_TRUE(cache.lookup(2) != nullptr);
+    // 已知版本为4，基于版本3生成的重写不再接受
+    EXPECT_FALSE(cache.insert(rewrite(3, "orders", 3)));
+    EXPECT_EQ(cache.getStats().stale_inserts, 1u);
+}
+
+TEST(RewriteCache, UnknownSchemaVersionRejectsInFlightRewrite) {
+    RewriteCache cache;
+    const uint64_t epoch = cache.epoch();
+    // 生成期间发生DDL，版本未知
+    cache.invalidateSchema("orders");
+    EXPECT_FALSE(cache.insert(rewrite(1, "orders", 0, epoch)));
+    // 失效之后开始的生成不受影响
+    EXPECT_TRUE(cache.insert(rewrite(1, "orders", 0, cache.epoch())));
+    // 其他表的失效不影响
+    const uint64_t before = cache.epoch();
+    cache.invalidateSchema("customer");
+    EXPECT_TRUE(cache.insert(rewrite(2, "orders", 0, before)));
+}
+
+TEST(RewriteCache, BindsLiteralsOfSameTemplate) {
+    const CachedRewrite r = rewrite(1, "orders", 0);
+    std::string bound;
+    ASSERT_TRUE(bindRewrite(r, "SELECT * FROM orders WHERE a IN (SELECT b FROM t2 WHERE c = 42)",
+                            &bound));
+    EXPECT_EQ(bound, std::string("SELECT orders.* FROM orders JOIN t2 ON a = b WHERE c = 42"));
+}
@@ -0,0 +1,54 @@
+/**
+ * @file test_rewrite_prefetcher.cpp
+ * @brief 执行统计与空闲预取测试
+ */
+
+#include "test_framework.h"
+#include "optimizer_integration/rewrite_prefetcher.h"
+#include <vector>
+
+using heimdall::optimizer::DigestStatistics;
+using heimdall::optimizer::PrefetchConfig;
+using heimdall::optimizer::RewritePrefetcher;
+
+TEST(DigestStatistics, HottestSkipsExcludedAndFastTemplates) {
+    DigestStatistics stats;
+    for (int i = 0; i < 3; ++i) {
+        stats.record(1, "SELECT 1", 100.0);
+        stats.record(2, "SELECT 2", 900.0);
+        stats.record(3, "SELECT 3", 600.0);
+        stats.record(4, "SELECT 4", 1.0);
+    }
+    const auto hot = stats.hottest(2, 50.0, 2, [](uint64_t digest) { return digest == 2; });
+    ASSERT_TRUE(hot.size() == 2u);
+    EXPECT_EQ(hot[0].digest, 3u);
+    EXPECT_EQ(hot[1].digest, 1u);
+    EXPECT_EQ(hot[0].sample_sql, std::string("SELECT 3"));
+    EXPECT_EQ(hot[1].executions, 3u);
+}
+
+TEST(RewritePrefetcher, SubmitsOncePerIntervalWhenIdle) {
+    auto stats = std::make_shared<DigestStatistics>();
+    stats->record(9, "SELECT 9", 1000.0);
+    stats->record(9, "SELECT 9", 1000.0);
+
+    bool idle = false;
+    std::vector<uint64_t> submitted;
+    PrefetchConfig config;
+    config.poll_interval = std::chrono::hours(1);
+    RewritePrefetcher prefetcher(
+        stats, [&idle] { return idle; }, nullptr,
+        [&submitted](uint64_t digest, const std::string&) {
+            submitted.push_back(digest);
+            return true;
+        },
+        config);
+
+    EXPECT_EQ(prefetcher.maybeRun(), 0u);   // 提供商忙
+    EXPECT_EQ(prefetcher.getStats().skipped_busy, 1u);
+    idle = true;
+    EXPECT_EQ(prefetcher.maybeRun(), 0u);   // 本周期已执行过
+    EXPECT_EQ(prefetcher.runOnce(), 1u);
+    ASSERT_TRUE(submitted.size() == 1u);
+    EXPECT_EQ(submitted[0], 9u);
+}
@@ -0,0 +1,161 @@
+/**
+ * @file test_schema_cache.cpp
+ * @brief Schema片段缓存测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/prompt_builder.h"
+#include "llm_generator/schema_cache.h"
+
+using heimdall::llm::IndexDefinition;
+using heimdall::llm::PromptBuilder;
+using heimdall::llm::SchemaFormat;
+using heimdall::llm::SchemaRenderCache;
+using heimdall::llm::TableSchema;
+using heimdall::llm::renderTableSchema;
+
+namespace {
+
+TableSchema table(const std::string& name) {
+    TableSchema schema;
+    schema.table_name = name;
+    schema.create_statement = "CREATE TABLE " + name + " (id INT PRIMARY KEY, v INT)";
+    return schema;
+}
+
+// 带主外键、NDV、行数与索引的事实表
+TableSchema storeSales() {
+    TableSchema schema;
+    schema.table_name = "store_sales";
+    schema.columns = {"ss_item_sk INT", "ss_sold_date_sk INT", "ss_quantity INT"};
+    schema.primary_keys = {"ss_item_sk"};
+    schema.foreign_keys = {"ss_sold_date_sk -> date_dim(d_date_sk)"};
+    schema.row_count = 2880404;
+    schema.column_ndv = {{"ss_item_sk", 18000}};
+    IndexDefinition by_date;
+    by_date.name = "idx_date";
+    by_date.columns = {"ss_sold_date_sk"};
+    IndexDefinition unique_item;
+    unique_item.name = "uk_item";
+    unique_item.columns = {"ss_item_sk", "ss_quantity"};
+    unique_item.unique = true;
+    schema.indexes = {by_date, unique_item};
+    return schema;
+}
+
+} // namespace
+
+TEST(SchemaRenderCache, HitReturnsSameFragment) {
+    SchemaRenderCache cache;
+    const TableSchema schema = table("t");
+    auto first = cache.get(schema);
+    auto second = cache.get(schema);
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(cache.getStats().hits, 1u);
+    EXPECT_EQ(cache.getStats().misses, 1u);
+}
+
+TEST(SchemaRenderCache, VersionsSelectVariants) {
+    SchemaRenderCache cache;
+    TableSchema schema = table("t");
+    auto base = cache.get(schema);
+
+    // DDL随schema_version变化，版本不变时不比较create_statement
+    TableSchema ddl = schema;
+    ddl.create_statement = "CREATE TABLE t (id BIGINT PRIMARY KEY, v INT)";
+    EXPECT_EQ(cache.get(ddl).get(), base.get());
+    ddl.schema_version = 1;
+    EXPECT_TRUE(cache.get(ddl)->find("BIGINT") != std::string::npos);
+
+    TableSchema ndv = ddl;
+    ndv.column_ndv["v"] = 42;
+    ndv.stats_version = 1;
+    EXPECT_TRUE(cache.get(ndv)->find("v=42") != std::string::npos);
+
+    TableSchema indexed = ndv;
+    indexed.indexes.push_back({"idx_v", {"v"}, false});
+    indexed.stats_version = 2;
+    EXPECT_TRUE(cache.get(indexed)->find("idx_v(v)") != std::string::npos);
+
+    // 列子集不同的变体各自缓存
+    TableSchema pruned = ddl;
+    pruned.columns = {"id BIGINT"};
+    pruned.create_statement.clear();
+    EXPECT_TRUE(cache.get(pruned)->find("BIGINT") != std::string::npos);
+    EXPECT_TRUE(cache.get(ddl)->find("CREATE TABLE") != std::string::npos);
+}
+
+TEST(SchemaRenderCache, TableNamesAreCaseInsensitive) {
+    SchemaRenderCache cache;
+    auto before = cache.get(table("Orders"));
+    EXPECT_EQ(cache.get(table("orders")).get(), before.get());
+    cache.invalidate("ORDERS");
+    EXPECT_NE(cache.get(table("Orders")).get(), before.get());
+    EXPECT_EQ(cache.getStats().invalidations, 1u);
+}
+
+TEST(SchemaRenderCache, EvictsLeastRecentlyUsedTable) {
+    SchemaRenderCache cache(2);
+    auto a = cache.get(table("a"));
+    auto b = cache.get(table("b"));
+    cache.get(table("a"));          // a变为最近使用
+    cache.get(table("c"));          // 淘汰b
+    EXPECT_EQ(cache.get(table("a")).get(), a.get());
+    EXPECT_NE(cache.get(table("b")).get(), b.get());
+}
+
+TEST(SchemaRenderCache, InvalidateDropsFragments) {
+    SchemaRenderCache cache;
+    auto before = cache.get(table("t"));
+    cache.invalidate("t");
+    EXPECT_NE(cache.get(table("t")).get(), before.get());
+    EXPECT_EQ(cache.getStats().invalidations, 1u);
+}
+
+TEST(SchemaRender, DetailedAndCompactFormats) {
+    const TableSchema schema = storeSales();
+    EXPECT_EQ(renderTableSchema(schema, SchemaFormat::DETAILED),
+              std::string("### Table: store_sales (~2.9M rows)\n"
+                          "Columns: ss_item_sk INT [ndv 18K], ss_sold_date_sk INT, ss_quantity INT\n"
+                          "Primary Keys: ss_item_sk\n"
+                          "Foreign Keys: ss_sold_date_sk -> date_dim(d_date_sk)\n"
+                          "Indexes: idx_date(ss_sold_date_sk), UNIQUE uk_item(ss_item_sk, ss_quantity)\n"
+                          "\n"));
+    EXPECT_EQ(renderTableSchema(schema, SchemaFormat::COMPACT),
+              std::string("store_sales(ss_item_sk PK ~18K, ss_sold_date_sk FK date_dim, ss_quantity)"
+                          " ~2.9M rows; idx (ss_sold_date_sk), U(ss_item_sk, ss_quantity)\n"));
+}
+
+TEST(SchemaRender, CompactTakesColumnsFromCreateStatement) {
+    TableSchema schema;
+    schema.table_name = "item";
+    schema.create_statement =
+        "CREATE TABLE item (\n"
+        "  i_item_sk INT NOT NULL,\n"
+        "  `i_brand` CHAR(50) DEFAULT 'a,b',\n"
+        "  i_price DECIMAL(7,2),\n"
+        "  PRIMARY KEY (i_item_sk),\n"
+        "  KEY idx_brand (i_brand)\n"
+        ")";
+    schema.primary_keys = {"i_item_sk"};
+    // 没有统计信息时不输出行数与索引标注
+    EXPECT_EQ(renderTableSchema(schema, SchemaFormat::COMPACT),
+              std::string("item(i_item_sk PK, i_brand, i_price)\n"));
+}
+
+TEST(SchemaRender, CompactPromptAndCacheVariants) {
+    SchemaRenderCache cache;
+    const TableSchema schema = storeSales();
+    auto detailed = cache.get(schema, SchemaFormat::DETAILED);
+    auto compact = cache.get(schema, SchemaFormat::COMPACT);
+    EXPECT_TRUE(*detailed != *compact);
+    EXPECT_EQ(cache.get(schema, SchemaFormat::COMPACT).get(), compact.get());
+
+    PromptBuilder builder;
+    builder.setSchemaFormat(SchemaFormat::COMPACT);
+    const std::string prompt =
+        builder.buildRewritePrompt("SELECT ss_quantity FROM store_sales", {schema}, false);
+    EXPECT_TRUE(prompt.find("Format: table(column") != std::string::npos);
+    EXPECT_TRUE(prompt.find(*compact) != std::string::npos);
+    EXPECT_TRUE(prompt.find("### Table:") == std::string::npos);
+}
@@ -0,0 +1,126 @@
+/**
+ * @file test_schema_pruner.cpp
+ * @brief Schema裁剪测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/prompt_builder.h"
+#include "llm_generator/schema_pruner.h"
+
+using heimdall::llm::SchemaPruningOptions;
+using heimdall::llm::SchemaSelection;
+using heimdall::llm::TableSchema;
+using heimdall::llm::materializeSelection;
+using heimdall::llm::pruneSchemas;
+
+namespace {
+
+std::vector<TableSchema> tpcds() {
+    TableSchema store_sales;
+    store_sales.table_name = "store_sales";
+    store_sales.columns = {"ss_item_sk INT", "ss_sold_date_sk INT",
+                           "ss_sales_price DECIMAL(7,2)", "ss_quantity INT"};
+    store_sales.foreign_keys = {"ss_item_sk -> item(i_item_sk)"};
+    TableSchema item;
+    item.table_name = "item";
+    item.create_statement =
+        "CREATE TABLE item (\n"
+        "  i_item_sk INT NOT NULL,\n"
+        "  i_category CHAR(50),\n"
+        "  `i_brand` CHAR(50) DEFAULT 'a,b',\n"
+        "  i_price DECIMAL(7,2),\n"
+        "  PRIMARY KEY (i_item_sk)\n"
+        ")";
+    TableSchema date_dim;
+    date_dim.table_name = "date_dim";
+    date_dim.columns = {"d_date_sk INT", "d_year INT"};
+    return {store_sales, item, date_dim};
+}
+
+SchemaPruningOptions enabled() {
+    SchemaPruningOptions options;
+    options.enabled = true;
+    return options;
+}
+
+} // namespace
+
+TEST(SchemaPruner, KeepsReferencedTablesAndColumnsByIndex) {
+    const auto schemas = tpcds();
+    std::vector<SchemaSelection> selections;
+    pruneSchemas("SELECT SUM(ss_sales_price) FROM store_sales", schemas, enabled(), selections);
+    ASSERT_TRUE(selections.size() == 1u);
+    EXPECT_EQ(selections[0].table, 0u);
+    EXPECT_FALSE(selections[0].all_columns);
+    // 引用的列与外键列
+    ASSERT_TRUE(selections[0].columns.size() == 2u);
+    EXPECT_EQ(selections[0].columns[0], 0u);
+    EXPECT_EQ(selections[0].columns[1], 2u);
+}
+
+TEST(SchemaPruner, PrunesDdlOnlyTables) {
+    const auto schemas = tpcds();
+    std::vector<SchemaSelection> selections;
+    pruneSchemas("SELECT i_brand FROM item WHERE i_category = 'x'", schemas, enabled(),
+                 selections);
+    ASSERT_TRUE(selections.size() == 1u);
+    EXPECT_FALSE(selections[0].all_columns);
+
+    TableSchema pruned;
+    materializeSelection(schemas[1], selections[0], pruned);
+    EXPECT_TRUE(pruned.create_statement.empty());
+    ASSERT_TRUE(pruned.columns.size() == 3u);
+    EXPECT_EQ(pruned.columns[0], std::string("i_item_sk INT NOT NULL"));   // 主键
+    EXPECT_EQ(pruned.columns[1], std::string("i_category CHAR(50)"));
+    EXPECT_EQ(pruned.columns[2], std::string("`i_brand` CHAR(50) DEFAULT 'a,b'"));
+}
+
+TEST(SchemaPruner, IgnoresCommentsAndStrings) {
+    const auto schemas = tpcds();
+    std::vector<SchemaSelection> selections;
+    pruneSchemas("SELECT d_year FROM date_dim # store_sales\n"
+                 "WHERE d_year > 1 -- item\n AND 'store_sales' <> ''",
+                 schemas, enabled(), selections);
+    ASSERT_TRUE(selections.size() == 1u);
+    EXPECT_EQ(selections[0].table, 2u);
+}
+
+TEST(SchemaPruner, StarKeepsAllColumns) {
+    const auto schemas = tpcds();
+    std::vector<SchemaSelection> selections;
+    pruneSchemas("SELECT * FROM date_dim", schemas, enabled(), selections);
+    ASSERT_TRUE(selections.size() == 1u);
+    EXPECT_TRUE(selections[0].all_columns);
+}
+
+TEST(SchemaPruner, NoMatchKeepsEverything) {
+    const auto schemas = tpcds();
+    std::vector<SchemaSelection> selections;
+    pruneSchemas("SELECT * FROM some_view", schemas, enabled(), selections);
+    ASSERT_TRUE(selections.size() == 3u);
+    for (const auto& selection : selections) {
+        EXPECT_TRUE(selection.all_columns);
+    }
+}
+
+TEST(SchemaPruner, FkNeighborKeepsOnlyKeys) {
+    const auto schemas = tpcds();
+    SchemaPruningOptions options = enabled();
+    options.include_fk_neighbors = true;
+    std::vector<SchemaSelection> selections;
+    pruneSchemas("SELECT ss_quantity FROM store_sales", schemas, options, selections);
+    ASSERT_TRUE(selections.size() == 2u);
+    EXPECT_EQ(selections[1].table, 1u);
+    ASSERT_TRUE(selections[1].ddl_columns.size() == 1u);
+    EXPECT_EQ(std::string(selections[1].ddl_columns[0]), std::string("i_item_sk INT NOT NULL"));
+}
+
+TEST(SchemaPruner, PromptUsesPrunedSchemas) {
+    heimdall::llm::PromptBuilder builder;
+    builder.setSchemaPruning(enabled());
+    const std::string prompt =
+        builder.buildRewritePrompt("SELECT i_brand FROM item", tpcds(), false);
+    EXPECT_TRUE(prompt.find("i_brand") != std::string::npos);
+    EXPECT_TRUE(prompt.find("i_price") == std::string::npos);
+    EXPECT_TRUE(prompt.find("store_sales") == std::string::npos);
+}
@@ -0,0 +1,129 @@
+/**
+ * @file test_sql_grammar.cpp
+ * @brief SELECT约束语法测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/sql_grammar.h"
+#include <set>
+
+using heimdall::llm::SqlGrammar;
+using heimdall::llm::TableSchema;
+
+namespace {
+
+std::shared_ptr<const SqlGrammar> tpcdsGrammar() {
+    TableSchema store_sales;
+    store_sales.table_name = "store_sales";
+    store_sales.columns = {"ss_item_sk INT", "ss_sold_date_sk INT",
+                           "ss_sales_price DECIMAL(7,2)", "ss_quantity INT"};
+    TableSchema date_dim;
+    date_dim.table_name = "date_dim";
+    date_dim.columns = {"d_date_sk INT", "d_date DATE", "d_year INT"};
+    TableSchema item;
+    item.table_name = "Item";
+    item.columns = {"i_item_sk INT", "i_category CHAR(50)"};
+    return SqlGrammar::forSelect({store_sales, date_dim, item});
+}
+
+bool accepts(const std::string& sql) {
+    std::string error;
+    const bool ok = tpcdsGrammar()->accepts(sql, &error);
+    if (!ok) {
+        std::cerr << "  rejected: " << error << "\n  sql: " << sql << std::endl;
+    }
+    return ok;
+}
+
+} // namespace
+
+TEST(SqlGrammar, AcceptsPlainSelectInAnyCase) {
+    EXPECT_TRUE(accepts("SELECT ss_item_sk FROM store_sales WHERE ss_quantity > 10"));
+    EXPECT_TRUE(accepts("select ss_item_sk from Store_Sales where SS_QUANTITY > 10;"));
+    EXPECT_TRUE(accepts("select i.i_category, count(*) cnt from item i "
+                        "join store_sales s on s.ss_item_sk = i.i_item_sk "
+                        "group by i.i_category having count(*) > 1 order by cnt desc limit 10"));
+}
+
+TEST(SqlGrammar, AcceptsAnalyticConstructs) {
+    EXPECT_TRUE(accepts("SELECT CAST(ss_sales_price AS DECIMAL(15,4)) FROM store_sales"));
+    EXPECT_TRUE(accepts("select d_date_sk from date_dim where d_date between "
+                        "date '2000-01-01' and (cast('2000-01-01' as date) + interval 30 day)"));
+    EXPECT_TRUE(accepts("select extract(year from d_date) y from date_dim"));
+    EXPECT_TRUE(accepts("select i_category, rank() over (partition by i_category "
+                        "order by sum(ss_sales_price) desc) rk from item, store_sales "
+                        "where ss_item_sk = i_item_sk group by i_category"));
+    EXPECT_TRUE(accepts("select avg(ss_quantity) over (order by ss_sold_date_sk "
+                        "rows between unbounded preceding and current row) from store_sales"));
+    EXPECT_TRUE(accepts("with cte_sales as (select ss_item_sk from store_sales) "
+                        "select ss_item_sk from cte_sales"));
+}
+
+TEST(SqlGrammar, RejectsUnsafeOrUnknown) {
+    auto grammar = tpcdsGrammar();
+    EXPECT_FALSE(grammar->accepts("delete from store_sales"));
+    EXPECT_FALSE(grammar->accepts("select * from store_sales; drop table item"));
+    EXPECT_FALSE(grammar->accepts("select * from customer"));
+    EXPECT_FALSE(grammar->accepts("select s.no_such_col from store_sales s"));
+    EXPECT_FALSE(grammar->accepts("select sleep(10) from store_sales"));
+    EXPECT_FALSE(grammar->accepts("select * from store_sales -- comment"));
+    EXPECT_FALSE(grammar->accepts("select (ss_quantity from store_sales"));
+    EXPECT_FALSE(grammar->accepts("with sales as (select 1 from item) select 1 from sales"));
+}
+
+TEST(SqlGrammar, GbnfKeywordsAreCaseInsensitive) {
+    const auto grammar = tpcdsGrammar();
+    const std::string& gbnf = grammar->gbnf();
+    EXPECT_TRUE(gbnf.find("([sS] [eE] [lL] [eE] [cC] [tT])") != std::string::npos);
+    EXPECT_TRUE(gbnf.find("\"SELECT\"") == std::string::npos);
+    EXPECT_TRUE(gbnf.find("\"FROM\"") == std::string::npos);
+    // Schema标识符同样不区分大小写
+    EXPECT_TRUE(gbnf.find("([iI] [tT] [eE] [mM])") != std::string::npos);
+    EXPECT_TRUE(gbnf.find("([dD] \"_\" [dD] [aA] [tT] [eE])") != std::string::npos);
+}
+
+TEST(SqlGrammar, GbnfRulesAreAllDefined) {
+    const auto grammar = tpcdsGrammar();
+    const std::string& gbnf = grammar->gbnf();
+    std::set<std::string> defined;
+    std::set<std::string> referenced;
+    size_t line_start = 0;
+    while (line_start < gbnf.size()) {
+        size_t line_end = gbnf.find('\n', line_start);
+        if (line_end == std::string::npos) line_end = gbnf.size();
+        const std::string line = gbnf.substr(line_start, line_end - line_start);
+        line_start = line_end + 1;
+
+        const size_t sep = line.find(" ::= ");
+        ASSERT_TRUE(sep != std::string::npos);
+        defined.insert(line.substr(0, sep));
+
+        // 收集引号与字符类之外的规则名
+        size_t i = sep + 5;
+        while (i < line.size()) {
+            const char c = line[i];
+            if (c == '"') {
+                i = line.find('"', i + 1) + 1;
+            } else if (c == '[') {
+                i = line.find(']', i + 1) + 1;
+            } else if (c >= 'a' && c <= 'z') {
+                const size_t start = i;
+                while (i < line.size() && ((line[i] >= 'a' && line[i] <= 'z') || line[i] == '-')) ++i;
+                referenced.insert(line.substr(start, i - start));
+            } else {
+                ++i;
+            }
+        }
+    }
+    for (const auto& name : referenced) {
+        if (!defined.count(name)) {
+            std::cerr << "  undefined rule: " << name << std::endl;
+        }
+        EXPECT_TRUE(defined.count(name) > 0);
+    }
+    EXPECT_TRUE(defined.count("window-spec") > 0);
+    EXPECT_TRUE(defined.count("cast") > 0);
+    EXPECT_TRUE(defined.count("extract") > 0);
+    EXPECT_TRUE(defined.count("interval") > 0);
+    EXPECT_TRUE(defined.count("typed-literal") > 0);
+}
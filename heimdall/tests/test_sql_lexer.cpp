@@ -0,0 +1,82 @@
+/**
+ * @file test_sql_lexer.cpp
+ * @brief 共用SQL词法扫描器测试
+ */
+
+#include "test_framework.h"
+#include "llm_generator/sql_lexer.h"
+#include <vector>
+
+using heimdall::llm::SqlKeyword;
+using heimdall::llm::SqlLexer;
+using heimdall::llm::SqlToken;
+using heimdall::llm::SqlTokenType;
+using heimdall::llm::firstIdentifier;
+using heimdall::llm::lookupKeyword;
+
+namespace {
+
+std::vector<SqlToken> lex(std::string_view sql) {
+    std::vector<SqlToken> tokens;
+    SqlLexer lexer(sql);
+    SqlToken token;
+    while (lexer.next(token)) tokens.push_back(token);
+    return tokens;
+}
+
+} // namespace
+
+TEST(SqlLexer, SplitsWordsLiteralsAndPunct) {
+    const auto tokens = lex("SELECT a.b,'x''y' FROM `t``q` WHERE c>=1.5e-3");
+    ASSERT_TRUE(tokens.size() == 13u);
+    EXPECT_TRUE(tokens[0].is(SqlKeyword::SELECT));
+    EXPECT_TRUE(tokens[2].isPunct('.'));
+    EXPECT_FALSE(tokens[2].space_before);
+    EXPECT_EQ(std::string(tokens[5].text), std::string("'x''y'"));
+    EXPECT_TRUE(tokens[5].type == SqlTokenType::STRING);
+    EXPECT_TRUE(tokens[7].type == SqlTokenType::QUOTED_IDENTIFIER);
+    EXPECT_EQ(std::string(tokens[7].text), std::string("t``q"));
+    EXPECT_TRUE(tokens[10].isPunct('>'));
+    EXPECT_TRUE(tokens[11].isPunct('='));
+    EXPECT_TRUE(tokens[12].type == SqlTokenType::NUMBER);
+    EXPECT_EQ(std::string(tokens[12].text), std::string("1.5e-3"));
+}
+
+TEST(SqlLexer, SkipsCommentsAsWhitespace) {
+    SqlLexer lexer("a/* x */b -- y\n# z\nc");
+    SqlToken token;
+    ASSERT_TRUE(lexer.next(token));
+    ASSERT_TRUE(lexer.next(token));
+    EXPECT_EQ(std::string(token.text), std::string("b"));
+    EXPECT_TRUE(token.space_before);
+    ASSERT_TRUE(lexer.next(token));
+    EXPECT_EQ(std::string(token.text), std::string("c"));
+    EXPECT_FALSE(lexer.next(token));
+    EXPECT_EQ(lexer.commentCount(), 3u);
+}
+
+TEST(SqlLexer, ReportsEscapesAndUnterminatedQuotes) {
+    const auto escaped = lex("'a\\'b'");
+    ASSERT_TRUE(escaped.size() == 1u);
+    EXPECT_TRUE(escaped[0].escaped);
+    EXPECT_TRUE(escaped[0].terminated);
+    const auto open = lex("x = 'abc");
+    ASSERT_TRUE(open.size() == 3u);
+    EXPECT_FALSE(open[2].terminated);
+}
+
+TEST(SqlLexer, PeekDoesNotAdvance) {
+    SqlLexer lexer("a b");
+    EXPECT_EQ(std::string(lexer.peek().text), std::string("a"));
+    SqlToken token;
+    lexer.next(token);
+    EXPECT_EQ(std::string(token.text), std::string("a"));
+}
+
+TEST(SqlLexer, KeywordsAreCaseInsensitive) {
+    EXPECT_TRUE(lookupKeyword("InterSect") == SqlKeyword::INTERSECT);
+    EXPECT_TRUE(lookupKeyword("STRAIGHT_JOIN") == SqlKeyword::STRAIGHT_JOIN);
+    EXPECT_TRUE(lookupKeyword("selects") == SqlKeyword::NONE);
+    EXPECT_TRUE(lookupKeyword("a_very_long_identifier") == SqlKeyword::NONE);
+    EXPECT_EQ(std::string(firstIdentifier("  `i_brand` CHAR(50)")), std::string("i_brand"));
+}
@@ -0,0 +1,62 @@
+/**
+ * @file test_trigger_model.cpp
+ * @brief 触发模型测试
+ */
+
+#include "test_framework.h"
+#include "optimizer_integration/trigger_model.h"
+
+using heimdall::optimizer::QueryFeatures;
+using heimdall::optimizer::StatementType;
+using heimdall::optimizer::TriggerFeatures;
+using heimdall::optimizer::TriggerModel;
+using heimdall::optimizer::TriggerModelConfig;
+using heimdall::optimizer::makeTriggerFeatures;
+
+namespace {
+
+TriggerFeatures subqueryFeatures() {
+    QueryFeatures features;
+    features.statement_type = StatementType::SELECT;
+    features.table_refs = 2;
+    features.subquery_count = 1;
+    features.in_subquery_count = 1;
+    return makeTriggerFeatures(features, 5000.0);
+}
+
+TriggerModelConfig eagerConfig() {
+    TriggerModelConfig config;
+    config.min_samples = 1;
+    config.exploration_interval = 0;
+    config.min_expected_benefit = 0.1;
+    return config;
+}
+
+} // namespace
+
+TEST(TriggerModel, SkipsLikelyButNegligibleImprovements) {
+    TriggerModel model(eagerConfig());
+    const TriggerFeatures features = subqueryFeatures();
+    for (int i = 0; i < 500; ++i) model.update(features, true, 1.05);
+    const auto decision = model.decide(features);
+    EXPECT_TRUE(decision.model_active);
+    EXPECT_TRUE(decision.prediction.probability > 0.9);
+    EXPECT_FALSE(decision.optimize);
+}
+
+TEST(TriggerModel, OptimizesLikelyLargeImprovements) {
+    TriggerModel model(eagerConfig());
+    const TriggerFeatures features = subqueryFeatures();
+    for (int i = 0; i < 500; ++i) model.update(features, true, 4.0);
+    const auto decision = model.decide(features);
+    EXPECT_TRUE(decision.optimize);
+    EXPECT_NEAR(decision.prediction.expected_ratio, 4.0, 0.2);
+}
+
+TEST(TriggerModel, InactiveModelDefersToRules) {
+    TriggerModelConfig config = eagerConfig();
+    config.min_samples = 10;
+    TriggerModel model(config);
+    model.update(subqueryFeatures(), false, 1.0);
+    EXPECT_TRUE(model.decide(subqueryFeatures()).optimize);
+}
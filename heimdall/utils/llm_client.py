@@ -21,6 +21,7 @@ class GenerationConfig:
     max_tokens: int = 2000
     num_candidates: int = 3
     use_few_shot: bool = True
+    grammar: Optional[str] = None  # GBNF语法，本地服务端支持时用于约束解码
 
 
 @dataclass
@@ -125,6 +126,8 @@ class LLMClient:
             "max_tokens": config.max_tokens,
             "n": config.num_candidates
         }
+        if config.grammar:
+            data["grammar"] = config.grammar
 
         response = requests.post(endpoint, json=data, timeout=120)
         response.raise_for_status()
@@ -159,7 +162,7 @@ class LLMClient:
 
     def _get_cache_key(self, prompt: str, config: GenerationConfig) -> str:
         """生成缓存键"""
-        key_str = f"{prompt}|{config.model_name}|{config.temperature}|{config.num_candidates}"
+        key_str = f"{prompt}|{config.model_name}|{config.temperature}|{config.num_candidates}|{config.grammar or ''}"
         return hashlib.md5(key_str.encode()).hexdigest()
 
     def get_stats(self) -> Dict: